@@ -32,6 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "gtest/gtest.h"
 
 #include <iostream>
+#include <thread>
 
 #include "Backwards/Input/Lexer.h"
 #include "Backwards/Input/StringInput.h"
@@ -44,6 +45,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Engine/CallingContext.h"
 #include "Backwards/Engine/Logger.h"
 #include "Backwards/Engine/DebuggerHook.h"
+#include "Backwards/Engine/FatalException.h"
+#include "Backwards/Engine/ProgrammingException.h"
+#include "Backwards/Engine/StdLib.h"
+
+#include "Backwards/Types/FloatValue.h"
+#include "Backwards/Types/StringValue.h"
 
 class StringLogger final : public Backwards::Engine::Logger
  {
@@ -785,3 +792,138 @@ TEST(AllTests, testICanRecursiveFib)
    ASSERT_EQ(1U, logger.logs.size());
    EXPECT_EQ("INFO: 120", logger.logs[0]);
  }
+
+TEST(AllTests, testSharedGlobalsAcrossThreads)
+ {
+   Backwards::Input::StringInput string
+      (
+      "set fact to function f (y) is if y > 1 then return f(y - 1) * y else return 1 end end "
+      "set base to 3 "
+      );
+   Backwards::Input::Lexer lexer (string, "InputString");
+
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+
+   context.logger = &logger;
+   context.globalScope = &global;
+
+   std::shared_ptr<Backwards::Engine::Statement> parse = Backwards::Parser::Parser::Parse(lexer, table, logger);
+   ASSERT_TRUE(nullptr != parse.get());
+   parse->execute(context);
+
+   global.frozen = true;
+   EXPECT_THROW(parse->execute(context), Backwards::Engine::FatalException);
+
+   Backwards::Input::StringInput more ("set other to 1");
+   Backwards::Input::Lexer moreLexer (more, "InputString");
+   EXPECT_THROW(Backwards::Parser::Parser::Parse(moreLexer, table, logger), Backwards::Engine::ProgrammingException);
+
+      // Each context evaluates in its own rounding mode; the threads take turns with the library's one mode.
+   std::vector<Backwards::Engine::CallingContext> contexts (4U);
+   std::vector<std::string> results (contexts.size());
+   for (size_t i = 0U; i < contexts.size(); ++i)
+    {
+      contexts[i].logger = &logger;
+      contexts[i].globalScope = &global;
+      (void) Backwards::Engine::SetRoundMode(contexts[i], std::make_shared<Backwards::Types::FloatValue>(dm_double_fromdouble(static_cast<double>(DM_FE_TONEAREST + i))));
+    }
+   dm_fesetround(DM_FE_TONEAREST);
+
+   std::vector<std::thread> threads;
+   for (size_t i = 0U; i < contexts.size(); ++i)
+    {
+      threads.emplace_back([&contexts, &results, i]()
+       {
+         for (int iter = 0; iter < 50; ++iter)
+          {
+            std::shared_ptr<Backwards::Types::ValueType> res = Backwards::Engine::Eval(contexts[i],
+               std::make_shared<Backwards::Types::StringValue>("ToString(fact(base + 7) + GetRoundMode())"));
+            results[i] = static_cast<const Backwards::Types::StringValue&>(*res).value;
+          }
+       });
+    }
+   for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+
+   EXPECT_EQ("3628800", results[0]);
+   EXPECT_EQ("3628801", results[1]);
+   EXPECT_EQ("3628802", results[2]);
+   EXPECT_EQ("3628803", results[3]);
+   EXPECT_EQ(0U, logger.logs.size());
+
+      // The last thread out leaves its mode installed.
+   dm_fesetround(DM_FE_TONEAREST);
+ }
+
+TEST(AllTests, testRoundModesAcrossThreads)
+ {
+   StringLogger logger;
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global);
+   global.frozen = true;
+
+   std::vector<Backwards::Engine::CallingContext> contexts (2U);
+   std::vector<std::string> expected (contexts.size());
+   for (size_t i = 0U; i < contexts.size(); ++i)
+    {
+      contexts[i].logger = &logger;
+      contexts[i].globalScope = &global;
+    }
+   (void) Backwards::Engine::SetRoundMode(contexts[0], std::make_shared<Backwards::Types::FloatValue>(dm_double_fromdouble(static_cast<double>(DM_FE_UPWARD))));
+   (void) Backwards::Engine::SetRoundMode(contexts[1], std::make_shared<Backwards::Types::FloatValue>(dm_double_fromdouble(static_cast<double>(DM_FE_DOWNWARD))));
+
+   const std::shared_ptr<Backwards::Types::StringValue> program = std::make_shared<Backwards::Types::StringValue>("ToString(1 / 3)");
+   for (size_t i = 0U; i < contexts.size(); ++i)
+    {
+      expected[i] = static_cast<const Backwards::Types::StringValue&>(*Backwards::Engine::Eval(contexts[i], program)).value;
+    }
+   ASSERT_NE(expected[0], expected[1]);
+
+   std::vector<size_t> wrong (contexts.size());
+   std::vector<std::thread> threads;
+   for (size_t i = 0U; i < contexts.size(); ++i)
+    {
+      threads.emplace_back([&contexts, &expected, &wrong, &program, i]()
+       {
+         for (int iter = 0; iter < 500; ++iter)
+          {
+            std::shared_ptr<Backwards::Types::ValueType> res = Backwards::Engine::Eval(contexts[i], program);
+            if (expected[i] != static_cast<const Backwards::Types::StringValue&>(*res).value)
+             {
+               ++wrong[i];
+             }
+          }
+       });
+    }
+    // Meanwhile, the constant folder tries every rounding mode on 2 / 3.
+   threads.emplace_back([]()
+    {
+      for (int iter = 0; iter < 100; ++iter)
+       {
+         Backwards::Input::StringInput string ("set x to function f () is return 2 / 3 end");
+         Backwards::Input::Lexer lexer (string, "InputString");
+         Backwards::Engine::Scope scope;
+         Backwards::Parser::ContextBuilder::createGlobalScope(scope);
+         Backwards::Parser::GetterSetter gs;
+         Backwards::Parser::SymbolTable table (gs, scope);
+         StringLogger quiet;
+         (void) Backwards::Parser::Parser::Parse(lexer, table, quiet);
+       }
+    });
+   for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+
+   EXPECT_EQ(0U, wrong[0]);
+   EXPECT_EQ(0U, wrong[1]);
+   EXPECT_EQ(0U, logger.logs.size());
+   dm_fesetround(DM_FE_TONEAREST);
+ }
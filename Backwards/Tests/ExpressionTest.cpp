@@ -608,3 +608,39 @@ TEST(EngineTests, testBuildFunction)
    ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*std::dynamic_pointer_cast<Backwards::Types::FunctionValue>(res)->captures[0].get()));
    EXPECT_EQ(dm_double_fromdouble(9.0), std::dynamic_pointer_cast<Backwards::Types::FloatValue>(std::dynamic_pointer_cast<Backwards::Types::FunctionValue>(res)->captures[0])->value);
  }
+
+TEST(EngineTests, testStringOperations)
+ {
+   std::shared_ptr<Backwards::Engine::Constant> one = std::make_shared<Backwards::Engine::Constant>(Backwards::Input::Token(), std::make_shared<Backwards::Types::StringValue>("A"));
+   std::shared_ptr<Backwards::Engine::Constant> two = std::make_shared<Backwards::Engine::Constant>(Backwards::Input::Token(), std::make_shared<Backwards::Types::StringValue>("B"));
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+   context.logger = &logger;
+
+   Backwards::Engine::Plus plus (Backwards::Input::Token(), one, two);
+   std::shared_ptr<Backwards::Types::ValueType> res = plus.evaluate(context);
+
+   ASSERT_TRUE(typeid(Backwards::Types::StringValue) == typeid(*res.get()));
+   EXPECT_EQ("AB", std::dynamic_pointer_cast<Backwards::Types::StringValue>(res)->value);
+
+   Backwards::Engine::Less lessT (Backwards::Input::Token(), one, two);
+   res = lessT.evaluate(context);
+
+   ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*res.get()));
+   EXPECT_EQ(dm_double_fromdouble(1.0), std::dynamic_pointer_cast<Backwards::Types::FloatValue>(res)->value);
+
+   Backwards::Engine::Greater greaterF (Backwards::Input::Token(), one, two);
+   res = greaterF.evaluate(context);
+
+   ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*res.get()));
+   EXPECT_EQ(dm_double_fromdouble(0.0), std::dynamic_pointer_cast<Backwards::Types::FloatValue>(res)->value);
+
+   Backwards::Engine::Equals equalsT (Backwards::Input::Token(), one, one);
+   res = equalsT.evaluate(context);
+
+   ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*res.get()));
+   EXPECT_EQ(dm_double_fromdouble(1.0), std::dynamic_pointer_cast<Backwards::Types::FloatValue>(res)->value);
+
+   Backwards::Engine::Minus minus (Backwards::Input::Token(), one, two);
+   EXPECT_THROW(minus.evaluate(context), Backwards::Types::TypedOperationException);
+ }
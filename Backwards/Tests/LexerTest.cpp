@@ -37,6 +37,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Input/StringInput.h"
 #include "Backwards/Input/LineBufferedStreamInput.h"
 #include "Backwards/Input/BufferedGenericInput.h"
+#include "Backwards/Input/StringPool.h"
+#include "Backwards/Input/TokenHandle.h"
 
 TEST(LexerTests, testEverythingAndTheKitchenSink)
  {
@@ -207,3 +209,59 @@ TEST(LexerTests, testEverythingAndTheKitchenSink)
       EXPECT_EQ(Backwards::Input::END_OF_FILE, lexer.getNextToken().lexeme);
     }
  }
+
+TEST(LexerTests, testTokenHandles)
+ {
+   Backwards::Input::StringInput input ("set x to x + 1");
+   Backwards::Input::Lexer lexer (input, "TestFile");
+   std::vector<Backwards::Input::Token> tokens;
+   while (Backwards::Input::END_OF_FILE != lexer.peekNextToken().lexeme)
+    {
+      tokens.push_back(lexer.getNextToken());
+    }
+   ASSERT_EQ(6U, tokens.size());
+
+   Backwards::Input::TokenHandle plus (tokens[4]);
+   EXPECT_EQ(Backwards::Input::PLUS, plus.lexeme());
+   EXPECT_EQ("+", plus.text());
+   EXPECT_EQ("TestFile", plus.sourceFile());
+   EXPECT_EQ(tokens[4].lineNumber, plus.lineNumber());
+   EXPECT_EQ(tokens[4].lineLocation, plus.lineLocation());
+
+   Backwards::Input::Token copy = plus.token();
+   EXPECT_EQ(tokens[4].text, copy.text);
+   EXPECT_EQ(tokens[4].lineLocation, copy.lineLocation);
+
+      // The same token is only stored once, but the same text at another place is a different token.
+   EXPECT_EQ(plus, Backwards::Input::TokenHandle(tokens[4]));
+   EXPECT_NE(Backwards::Input::TokenHandle(tokens[1]), Backwards::Input::TokenHandle(tokens[3]));
+   EXPECT_EQ(&Backwards::Input::TokenHandle(tokens[1]).text(), &Backwards::Input::TokenHandle(tokens[3]).text());
+
+   Backwards::Input::TokenHandle none;
+   EXPECT_EQ(none, Backwards::Input::TokenHandle(Backwards::Input::Token()));
+   EXPECT_EQ(Backwards::Input::INVALID, none.lexeme());
+   EXPECT_EQ("", none.sourceFile());
+
+      // Strings are only held while a handle holds them.
+   const size_t before = Backwards::Input::StringPool::size();
+    {
+      Backwards::Input::TokenHandle once (Backwards::Input::Token(Backwards::Input::STRING, "Only used here", "Nowhere", 1U, 1U));
+      Backwards::Input::TokenHandle again (once);
+      EXPECT_EQ(before + 2U, Backwards::Input::StringPool::size());
+      EXPECT_EQ("Only used here", again.text());
+    }
+   EXPECT_EQ(before, Backwards::Input::StringPool::size());
+
+      // A thread's Local gives out the same strings as the pool, and holds them until it ends.
+    {
+      std::shared_ptr<const std::string> pooled = Backwards::Input::StringPool::intern("Pooled");
+      Backwards::Input::StringPool::Local outer;
+       {
+         Backwards::Input::StringPool::Local inner;
+         EXPECT_EQ(pooled.get(), Backwards::Input::StringPool::intern("Pooled").get());
+         (void) Backwards::Input::StringPool::intern("Held by the Local");
+       }
+      EXPECT_EQ(before + 2U, Backwards::Input::StringPool::size());
+    }
+   EXPECT_EQ(before, Backwards::Input::StringPool::size());
+ }
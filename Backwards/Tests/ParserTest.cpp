@@ -31,7 +31,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "gtest/gtest.h"
 
+#include <cmath>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
 #include "Backwards/Input/Lexer.h"
 #include "Backwards/Input/StringInput.h"
@@ -39,16 +42,26 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Parser/SymbolTable.h"
 #include "Backwards/Parser/Parser.h"
 #include "Backwards/Parser/ContextBuilder.h"
+#include "Backwards/Parser/CycleCollector.h"
+#include "Backwards/Parser/LazyFunction.h"
+#include "Backwards/Parser/LibraryCache.h"
 
 #include "Backwards/Engine/Statement.h"
+#include "Backwards/Engine/Expression.h"
 #include "Backwards/Engine/CallingContext.h"
 #include "Backwards/Engine/FunctionContext.h"
 #include "Backwards/Engine/FatalException.h"
 #include "Backwards/Engine/Logger.h"
 #include "Backwards/Engine/StackFrame.h"
 #include "Backwards/Engine/Scope.h"
+#include "Backwards/Engine/EvalCache.h"
+#include "Backwards/Engine/MemoCache.h"
+#include "Backwards/Engine/Profiler.h"
+#include "Backwards/Engine/Sampler.h"
+#include "Backwards/Engine/SelectTable.h"
 
 #include "Backwards/Types/FloatValue.h"
+#include "Backwards/Types/FunctionValue.h"
 
 #include "Backwards/Engine/ProgrammingException.h"
 
@@ -929,3 +942,881 @@ TEST(ParserTests, testIDontKnowHowToProgram)
       EXPECT_STREQ("If you see this, then the programmer is wrong: Request for non existent variable lucy.", e.what());
     }
  }
+
+static std::shared_ptr<Backwards::Engine::FunctionContext> getFunction (Backwards::Engine::Scope& global, const std::string& name)
+ {
+   return std::dynamic_pointer_cast<Backwards::Engine::FunctionContext>(
+      std::dynamic_pointer_cast<Backwards::Types::FunctionValue>(global.vars[global.var.find(name)->second])->value);
+ }
+
+TEST(ParserTests, testOptimizer)
+ {
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+
+   context.logger = &logger;
+   context.debugger = nullptr;
+   context.globalScope = &global;
+
+   Backwards::Input::StringInput string
+      (
+      "set f to function (n) is "
+      "   set total to 0 "
+      "   for i from 1 to n do "
+      "      set total to total + n * 2 + (-1 / 0 < 0) "
+      "   end "
+      "   if 1 < 0 then "
+      "      return 'dead' "
+      "   end "
+      "   return total "
+      "end "
+      "set g to function (n) is "
+      "   set total to 0 "
+      "   for i from 1 to n do "
+      "      set total to total + n * 2 + Abs(i) "
+      "   end "
+      "   return total "
+      "end "
+      "set h to function () is "
+      "   return 1 / 3 "
+      "end "
+      "set k to function () is "
+      "   return 1 / 4 + 'a' "
+      "end "
+      );
+   Backwards::Input::Lexer lexer (string, "InputString");
+
+   std::shared_ptr<Backwards::Engine::Statement> parse = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, parse.get());
+   parse->execute(context);
+
+      // The loop invariant is hoisted, the comparison is folded, and the if is gone.
+   std::shared_ptr<Backwards::Engine::FunctionContext> f = getFunction(global, "f");
+   EXPECT_EQ(f->locals.size() + 1U, f->nlocals);
+   std::shared_ptr<Backwards::Engine::StatementSeq> body = std::dynamic_pointer_cast<Backwards::Engine::StatementSeq>(f->function);
+   ASSERT_NE(nullptr, body.get());
+   ASSERT_EQ(4U, body->statements.size());
+   EXPECT_TRUE(typeid(Backwards::Engine::InvariantLoop) == typeid(*body->statements[1]));
+   EXPECT_FALSE(typeid(Backwards::Engine::IfStatement) == typeid(*body->statements[2]));
+
+      // The call could change the rounding mode, so the arithmetic must stay in the loop.
+   std::shared_ptr<Backwards::Engine::FunctionContext> g = getFunction(global, "g");
+   EXPECT_EQ(g->locals.size(), g->nlocals);
+
+      // 1 / 3 depends on the rounding mode; 1 / 4 doesn't, but adding a String is an error that must happen at run time.
+   std::shared_ptr<Backwards::Engine::FlowControlStatement> ret = std::dynamic_pointer_cast<Backwards::Engine::FlowControlStatement>(getFunction(global, "h")->function);
+   ASSERT_NE(nullptr, ret.get());
+   EXPECT_TRUE(typeid(Backwards::Engine::Divide) == typeid(*ret->value));
+   ret = std::dynamic_pointer_cast<Backwards::Engine::FlowControlStatement>(getFunction(global, "k")->function);
+   ASSERT_NE(nullptr, ret.get());
+   ASSERT_TRUE(typeid(Backwards::Engine::Plus) == typeid(*ret->value));
+   EXPECT_TRUE(typeid(Backwards::Engine::Constant) == typeid(*std::static_pointer_cast<Backwards::Engine::Plus>(ret->value)->lhs));
+
+   Backwards::Input::StringInput call1 ("f(3) + f(0) + g(3)");
+   Backwards::Input::Lexer lexer1 (call1, "InputString");
+   EXPECT_EQ(21.0 + 0.0 + 24.0, parseAndEvaluateDouble(lexer1, table, logger, context));
+
+   Backwards::Input::StringInput call2 ("k()");
+   Backwards::Input::Lexer lexer2 (call2, "InputString");
+   std::shared_ptr<Backwards::Engine::Expression> expr = Backwards::Parser::Parser::ParseFullExpression(lexer2, table, logger);
+   ASSERT_NE(nullptr, expr.get());
+   EXPECT_THROW(expr->evaluate(context), Backwards::Types::TypedOperationException);
+ }
+
+TEST(ParserTests, testTailCalls)
+ {
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+
+   context.logger = &logger;
+   context.debugger = nullptr;
+   context.globalScope = &global;
+
+   Backwards::Input::StringInput string
+      (
+      "set odd to 0 "
+      "set count to function (n; acc) is "
+      "   if n = 0 then "
+      "      return acc "
+      "   end "
+      "   return count(n - 1; acc + 1) "
+      "end "
+      "set even to function (n) is "
+      "   if n = 0 then return 1 else return odd(n - 1) end "
+      "end "
+      "set odd to function (n) is "
+      "   if n = 0 then return 0 else return even(n - 1) end "
+      "end "
+      "set bad to function (n) is "
+      "   if n = 0 then return 'a' + 1 end "
+      "   return bad(n - 1) "
+      "end "
+      );
+   Backwards::Input::Lexer lexer (string, "InputString");
+
+   std::shared_ptr<Backwards::Engine::Statement> parse = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, parse.get());
+   parse->execute(context);
+
+   std::shared_ptr<Backwards::Engine::StatementSeq> body = std::dynamic_pointer_cast<Backwards::Engine::StatementSeq>(getFunction(global, "count")->function);
+   ASSERT_NE(nullptr, body.get());
+   ASSERT_EQ(2U, body->statements.size());
+   EXPECT_TRUE(typeid(Backwards::Engine::TailCall) == typeid(*body->statements[1]));
+
+      // Deep enough to exhaust the native stack if every call took a frame.
+   Backwards::Input::StringInput call1 ("count(1000000; 0) + even(100001)");
+   Backwards::Input::Lexer lexer1 (call1, "InputString");
+   EXPECT_EQ(1000000.0 + 0.0, parseAndEvaluateDouble(lexer1, table, logger, context));
+
+   Backwards::Input::StringInput call2 ("bad(3)");
+   Backwards::Input::Lexer lexer2 (call2, "InputString");
+   std::shared_ptr<Backwards::Engine::Expression> expr = Backwards::Parser::Parser::ParseFullExpression(lexer2, table, logger);
+   ASSERT_NE(nullptr, expr.get());
+   EXPECT_THROW(expr->evaluate(context), Backwards::Types::TypedOperationException);
+ }
+
+TEST(ParserTests, testSelectTables)
+ {
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+
+   context.logger = &logger;
+   context.debugger = nullptr;
+   context.globalScope = &global;
+
+   Backwards::Input::StringInput string
+      (
+      "set fee to function (code) is "
+      "   select code from "
+      "      case 'A' is return 1 "
+      "      case 'B' is return 2 "
+      "      case 'C' is return 3 "
+      "      case 'D' is return 4 "
+      "      case 'B' is return 5 "
+      "      case else is return 0 "
+      "   end "
+      "end "
+      "set tax to function (income) is "
+      "   set r to 0 "
+      "   select income from "
+      "      case below -(1) is set r to -1 "
+      "      case below 10 is set r to 1 "
+      "      case 20 is set r to 20 "
+      "      also case from 30 to 25 is set r to r + 100 "
+      "      case from 25 to 30 is set r to 25 "
+      "      case below 40 is set r to 2 "
+      "      case above 90 is set r to 9 "
+      "      case 90 is set r to 90 "
+      "      case 50 is return 'error' + 1 "
+      "   end "
+      "   return r "
+      "end "
+      "set few to function (n) is "
+      "   select n from "
+      "      case 1 is return 1 "
+      "      case n is return 2 "
+      "      case 3 is return 3 "
+      "      case 4 is return 4 "
+      "      case 5 is return 5 "
+      "   end "
+      "   return 0 "
+      "end "
+      );
+   Backwards::Input::Lexer lexer (string, "InputString");
+
+   std::shared_ptr<Backwards::Engine::Statement> parse = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, parse.get());
+   parse->execute(context);
+
+   std::shared_ptr<Backwards::Engine::SelectStatement> fee = std::dynamic_pointer_cast<Backwards::Engine::SelectStatement>(getFunction(global, "fee")->function);
+   ASSERT_NE(nullptr, fee.get());
+   ASSERT_NE(nullptr, fee->table.get());
+   EXPECT_EQ(6U, fee->table->size());
+
+   std::shared_ptr<Backwards::Engine::StatementSeq> body = std::dynamic_pointer_cast<Backwards::Engine::StatementSeq>(getFunction(global, "tax")->function);
+   ASSERT_NE(nullptr, body.get());
+   std::shared_ptr<Backwards::Engine::SelectStatement> tax = std::dynamic_pointer_cast<Backwards::Engine::SelectStatement>(body->statements[1]);
+   ASSERT_NE(nullptr, tax.get());
+   ASSERT_NE(nullptr, tax->table.get());
+   EXPECT_EQ(9U, tax->table->size());
+
+      // A case that isn't constant ends the table, and leaves too few cases before it to bother.
+   body = std::dynamic_pointer_cast<Backwards::Engine::StatementSeq>(getFunction(global, "few")->function);
+   ASSERT_NE(nullptr, body.get());
+   std::shared_ptr<Backwards::Engine::SelectStatement> few = std::dynamic_pointer_cast<Backwards::Engine::SelectStatement>(body->statements[0]);
+   ASSERT_NE(nullptr, few.get());
+   EXPECT_EQ(nullptr, few->table.get());
+
+   Backwards::Input::StringInput call1 ("fee('A') + fee('B') * 10 + fee('D') * 100 + fee('Z') * 1000");
+   Backwards::Input::Lexer lexer1 (call1, "InputString");
+   EXPECT_EQ(421.0, parseAndEvaluateDouble(lexer1, table, logger, context));
+
+      // The table must pick the same case as testing them in order would, so run everything both ways.
+   const char* inputs [] = { "-5", "-1", "-0.5", "0", "9.99", "10", "15", "20", "22", "25", "27.5", "30", "35", "40", "45",
+      "89", "90", "90.01", "1000", "NaN()" };
+   std::shared_ptr<Backwards::Engine::SelectTable> built = tax->table;
+   for (const char* input : inputs)
+    {
+      std::string text = std::string("tax(") + input + ")";
+      Backwards::Input::StringInput call2 (text);
+      Backwards::Input::Lexer lexer2 (call2, "InputString");
+      tax->table = built;
+      double withTable = parseAndEvaluateDouble(lexer2, table, logger, context);
+
+      Backwards::Input::StringInput call3 (text);
+      Backwards::Input::Lexer lexer3 (call3, "InputString");
+      tax->table.reset();
+      double withoutTable = parseAndEvaluateDouble(lexer3, table, logger, context);
+
+      if (std::isnan(withoutTable))
+       {
+         EXPECT_TRUE(std::isnan(withTable)) << text;
+       }
+      else
+       {
+         EXPECT_EQ(withoutTable, withTable) << text;
+       }
+    }
+   tax->table = built;
+
+      // Errors happen just as they did: a case that raises one, and a control value of the wrong type.
+   Backwards::Input::StringInput call4 ("tax(50)");
+   Backwards::Input::Lexer lexer4 (call4, "InputString");
+   std::shared_ptr<Backwards::Engine::Expression> expr = Backwards::Parser::Parser::ParseFullExpression(lexer4, table, logger);
+   ASSERT_NE(nullptr, expr.get());
+   EXPECT_THROW(expr->evaluate(context), Backwards::Types::TypedOperationException);
+
+   Backwards::Input::StringInput call5 ("tax('rich') + fee(1)");
+   Backwards::Input::Lexer lexer5 (call5, "InputString");
+   expr = Backwards::Parser::Parser::ParseFullExpression(lexer5, table, logger);
+   ASSERT_NE(nullptr, expr.get());
+   EXPECT_THROW(expr->evaluate(context), Backwards::Types::TypedOperationException);
+ }
+
+TEST(ParserTests, testEvalCache)
+ {
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+
+   context.logger = &logger;
+   context.debugger = nullptr;
+   context.globalScope = &global;
+
+   table.addVariable("x");
+   global.vars[global.var.find("x")->second] = std::make_shared<Backwards::Types::FloatValue>(dm_double_fromdouble(1.0));
+
+   Backwards::Input::StringInput call1 ("Eval('x + 1') + Eval('x + 1') + Eval('x + 1')");
+   Backwards::Input::Lexer lexer1 (call1, "InputString");
+   EXPECT_EQ(6.0, parseAndEvaluateDouble(lexer1, table, logger, context));
+   ASSERT_NE(nullptr, global.evalCache.get());
+   EXPECT_EQ(1U, global.evalCache->size());
+
+      // Parsed against the scope, x is still the global; once the scope has its own x, the old parse is stale.
+   Backwards::Engine::Scope local;
+   table.pushScope(&local);
+   context.pushScope(&local);
+   table.addVariable("y");
+   local.vars[0] = std::make_shared<Backwards::Types::FloatValue>(dm_double_fromdouble(7.0));
+
+   Backwards::Input::StringInput call2 ("Eval('x + 1')");
+   Backwards::Input::Lexer lexer2 (call2, "InputString");
+   EXPECT_EQ(2.0, parseAndEvaluateDouble(lexer2, table, logger, context));
+
+   table.addVariable("x");
+   local.vars[1] = std::make_shared<Backwards::Types::FloatValue>(dm_double_fromdouble(5.0));
+   Backwards::Input::StringInput call3 ("Eval('x + 1')");
+   Backwards::Input::Lexer lexer3 (call3, "InputString");
+   EXPECT_EQ(6.0, parseAndEvaluateDouble(lexer3, table, logger, context));
+   EXPECT_EQ(1U, local.evalCache->size());
+
+   context.popScope();
+   table.popScope();
+   Backwards::Input::StringInput call4 ("Eval('x + 1')");
+   Backwards::Input::Lexer lexer4 (call4, "InputString");
+   EXPECT_EQ(2.0, parseAndEvaluateDouble(lexer4, table, logger, context));
+
+      // Only the most recently used expressions are kept.
+   for (size_t i = 0U; i < Backwards::Engine::EvalCache::CAPACITY + 10U; ++i)
+    {
+      Backwards::Input::StringInput call5 ("Eval('x + " + std::to_string(i) + "')");
+      Backwards::Input::Lexer lexer5 (call5, "InputString");
+      EXPECT_EQ(1.0 + i, parseAndEvaluateDouble(lexer5, table, logger, context));
+    }
+   EXPECT_EQ(Backwards::Engine::EvalCache::CAPACITY, global.evalCache->size());
+ }
+
+TEST(ParserTests, testMemoCache)
+ {
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   Backwards::Engine::MemoCache memo;
+   StringLogger logger;
+
+   context.logger = &logger;
+   context.debugger = nullptr;
+   context.globalScope = &global;
+
+   Backwards::Input::StringInput string
+      (
+      "set total to 0 "
+      "set odd to 0 "
+      "set square to function (n) is return n * n end "
+      "set twice to function (n) is return square(n) + square(n) end "
+      "set fact to function (n) is "
+      "   if n < 2 then return 1 end "
+      "   return n * fact(n - 1) "
+      "end "
+      "set even to function (n) is "
+      "   if n = 0 then return 1 else return odd(n - 1) end "
+      "end "
+      "set odd to function (n) is "
+      "   if n = 0 then return 0 else return even(n - 1) end "
+      "end "
+      "set reads to function (n) is return n + total end "
+      "set writes to function (n) is "
+      "   set total to total + n "
+      "   return n "
+      "end "
+      "set noisy to function (n) is "
+      "   call Info('noisy') "
+      "   return square(n) "
+      "end "
+      );
+   Backwards::Input::Lexer lexer (string, "InputString");
+
+   std::shared_ptr<Backwards::Engine::Statement> parse = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, parse.get());
+   parse->execute(context);
+
+   EXPECT_TRUE(getFunction(global, "square")->pure);
+   EXPECT_TRUE(getFunction(global, "twice")->pure);
+   EXPECT_EQ(2U, getFunction(global, "twice")->calls.size());
+   EXPECT_TRUE(getFunction(global, "fact")->pure);
+   EXPECT_EQ(1U, getFunction(global, "fact")->calls.size()); // Itself, through the global.
+   EXPECT_TRUE(getFunction(global, "even")->pure);
+   EXPECT_FALSE(getFunction(global, "reads")->pure);
+   EXPECT_FALSE(getFunction(global, "writes")->pure);
+   EXPECT_TRUE(getFunction(global, "noisy")->pure); // Only by itself: Info isn't.
+   EXPECT_TRUE(getFunction(global, "Sqr")->pure);
+   EXPECT_TRUE(getFunction(global, "GetRoundMode")->pure);
+   EXPECT_FALSE(getFunction(global, "Info")->pure);
+   EXPECT_FALSE(getFunction(global, "SetRoundMode")->pure);
+
+   context.memo = &memo;
+   EXPECT_TRUE(memo.remember(*getFunction(global, "twice"), context));
+   EXPECT_TRUE(memo.remember(*getFunction(global, "odd"), context));
+   EXPECT_FALSE(memo.remember(*getFunction(global, "noisy"), context));
+   EXPECT_FALSE(memo.remember(*getFunction(global, "reads"), context));
+   EXPECT_FALSE(memo.remember(*getFunction(global, "Sqr"), context)); // Quicker to just call.
+
+   Backwards::Input::StringInput call1 ("twice(3) + twice(3) + Sqr(2)");
+   Backwards::Input::Lexer lexer1 (call1, "InputString");
+   EXPECT_EQ(40.0, parseAndEvaluateDouble(lexer1, table, logger, context));
+   EXPECT_EQ(2U, memo.size());
+
+   Backwards::Input::StringInput call2 ("fact(5) + fact(6) + even(4) + reads(1)");
+   Backwards::Input::Lexer lexer2 (call2, "InputString");
+   EXPECT_EQ(120.0 + 720.0 + 1.0 + 1.0, parseAndEvaluateDouble(lexer2, table, logger, context));
+   EXPECT_EQ(2U + 6U + 1U, memo.size()); // fact(1) to fact(6), and even(4): its tail calls are made in its frame.
+
+      // Writing a global could change what any function calls, so everything is forgotten.
+   Backwards::Input::StringInput call3 ("writes(5) + reads(1)");
+   Backwards::Input::Lexer lexer3 (call3, "InputString");
+   EXPECT_EQ(11.0, parseAndEvaluateDouble(lexer3, table, logger, context));
+   EXPECT_EQ(0U, memo.size());
+
+      // The rounding mode is part of the call.
+   Backwards::Input::StringInput call4 ("GetRoundMode() + twice(3)");
+   Backwards::Input::Lexer lexer4 (call4, "InputString");
+   double nearest = parseAndEvaluateDouble(lexer4, table, logger, context);
+   context.roundMode = DM_FE_UPWARD;
+   Backwards::Input::StringInput call5 ("GetRoundMode() + twice(3)");
+   Backwards::Input::Lexer lexer5 (call5, "InputString");
+   EXPECT_NE(nearest, parseAndEvaluateDouble(lexer5, table, logger, context));
+   EXPECT_EQ(4U, memo.size());
+
+      // Only the most recently used calls are kept.
+   for (size_t i = 0U; i < Backwards::Engine::MemoCache::CAPACITY + 10U; ++i)
+    {
+      Backwards::Input::StringInput call6 ("square(" + std::to_string(i) + ")");
+      Backwards::Input::Lexer lexer6 (call6, "InputString");
+      EXPECT_EQ(static_cast<double>(i * i), parseAndEvaluateDouble(lexer6, table, logger, context));
+    }
+   EXPECT_EQ(Backwards::Engine::MemoCache::CAPACITY, memo.size());
+   context.roundMode = DM_FE_TONEAREST;
+ }
+
+class SiteProfiler final : public Backwards::Engine::Profiler
+ {
+public:
+   std::string where;
+   std::string site (Backwards::Engine::CallingContext&) const { return where; }
+ };
+
+TEST(ParserTests, testProfiler)
+ {
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+   SiteProfiler profiler;
+
+   context.logger = &logger;
+   context.debugger = nullptr;
+   context.globalScope = &global;
+
+   Backwards::Input::StringInput string
+      (
+      "set fact to function (n) is "
+      "   if n < 2 then return 1 end "
+      "   return n * fact(n - 1) "
+      "end "
+      "set twice to function (n) is "
+      "   return { fact(n) ; Abs(n) } "
+      "end "
+      );
+   Backwards::Input::Lexer lexer (string, "InputString");
+
+   std::shared_ptr<Backwards::Engine::Statement> parse = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, parse.get());
+   parse->execute(context);
+   EXPECT_EQ("fact", getFunction(global, "fact")->name);
+
+   context.profiler = &profiler;
+   profiler.where = "here";
+   Backwards::Input::StringInput call1 ("Size(twice(5))");
+   Backwards::Input::Lexer lexer1 (call1, "InputString");
+   EXPECT_EQ(2.0, parseAndEvaluateDouble(lexer1, table, logger, context));
+   context.profiler = nullptr;
+
+   EXPECT_EQ(1U, profiler.functions["twice"].calls);
+   EXPECT_EQ(5U, profiler.functions["fact"].calls);
+   EXPECT_EQ(1U, profiler.functions["Abs"].calls);
+   EXPECT_EQ(1U, profiler.functions["Size"].calls);
+   EXPECT_EQ(0U, profiler.functions["fact"].active);
+   EXPECT_LE(profiler.functions["fact"].exclusive.count(), profiler.functions["fact"].inclusive.count());
+   EXPECT_LE(profiler.functions["fact"].inclusive.count(), profiler.functions["twice"].inclusive.count());
+   EXPECT_LT(0U, profiler.functions["twice"].allocations);
+   EXPECT_EQ(5U, profiler.sites["here"]["fact"].calls);
+
+   std::stringstream report;
+   profiler.report(report);
+   EXPECT_NE(std::string::npos, report.str().find("twice"));
+   EXPECT_NE(std::string::npos, report.str().find("here:"));
+ }
+
+class OuterSampler final : public Backwards::Engine::Sampler
+ {
+public:
+   OuterSampler() : Backwards::Engine::Sampler(std::chrono::steady_clock::duration(0)) { }
+   void outer (Backwards::Engine::CallingContext&, std::vector<std::string>& frames) const { frames.emplace_back("cell"); }
+ };
+
+TEST(ParserTests, testSampler)
+ {
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+   OuterSampler sampler;
+
+   context.logger = &logger;
+   context.debugger = nullptr;
+   context.globalScope = &global;
+
+   Backwards::Input::StringInput string
+      (
+      "set busy to function (n) is "
+      "   set total to 0 "
+      "   for i from 1 to n do "
+      "      set total to total + i "
+      "   end "
+      "   return total "
+      "end "
+      "set outer to function (n) is "
+      "   return busy(n) + 0 "
+      "end "
+      );
+   Backwards::Input::Lexer lexer (string, "InputString");
+
+   std::shared_ptr<Backwards::Engine::Statement> parse = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, parse.get());
+   parse->execute(context);
+
+      // With no interval, every check takes a sample: ten of them, all in the loop.
+   ASSERT_EQ(64U, Backwards::Engine::Sampler::POLLS_PER_CHECK);
+   context.sampler = &sampler;
+   Backwards::Input::StringInput call1 ("outer(640)");
+   Backwards::Input::Lexer lexer1 (call1, "InputString");
+   EXPECT_EQ(640.0 * 641.0 / 2.0, parseAndEvaluateDouble(lexer1, table, logger, context));
+   context.sampler = nullptr;
+
+   ASSERT_EQ(1U, sampler.stacks.size());
+   EXPECT_EQ("cell;outer [InputString:1];busy [InputString:1]", sampler.stacks.begin()->first);
+   EXPECT_EQ(10U, sampler.stacks.begin()->second);
+
+   std::stringstream report;
+   sampler.report(report);
+   EXPECT_EQ("cell;outer [InputString:1];busy [InputString:1] 10\n", report.str());
+
+      // A check that comes late counts every interval it missed.
+   Backwards::Engine::Sampler late (std::chrono::milliseconds(1));
+   std::this_thread::sleep_for(std::chrono::milliseconds(10));
+   context.sampler = &late;
+   Backwards::Input::StringInput call2 ("outer(100)");
+   Backwards::Input::Lexer lexer2 (call2, "InputString");
+   EXPECT_EQ(100.0 * 101.0 / 2.0, parseAndEvaluateDouble(lexer2, table, logger, context));
+   context.sampler = nullptr;
+
+   ASSERT_EQ(1U, late.stacks.size());
+   EXPECT_LE(10U, late.stacks.begin()->second);
+ }
+
+TEST(ParserTests, testCycleCollector)
+ {
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+
+   context.logger = &logger;
+   context.debugger = nullptr;
+   context.globalScope = &global;
+
+   (void) Backwards::Parser::CycleCollector::collect(); // Whatever the other tests left behind.
+
+   Backwards::Input::StringInput string
+      (
+      "set f to function fact (n) is "
+      "   if n = 0 then return 1 end "
+      "   return n * fact(n - 1) "
+      "end "
+      "set g to function outer (n) is "
+      "   set inner to function inner (m) is return outer(m) end "
+      "   if n = 0 then return 0 end "
+      "   return inner(n - 1) "
+      "end "
+      "set h to function (n) is return n end "
+      "set k to function self () is return self end "
+      );
+   Backwards::Input::Lexer lexer (string, "InputString");
+
+   std::shared_ptr<Backwards::Engine::Statement> parse = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, parse.get());
+   parse->execute(context);
+
+   Backwards::Input::StringInput call1 ("f(5) + g(3)");
+   Backwards::Input::Lexer lexer1 (call1, "InputString");
+   EXPECT_EQ(120.0, parseAndEvaluateDouble(lexer1, table, logger, context));
+
+      // A function's value of itself is the same function.
+   Backwards::Input::StringInput call2 ("k() = k()()");
+   Backwards::Input::Lexer lexer2 (call2, "InputString");
+   EXPECT_EQ(1.0, parseAndEvaluateDouble(lexer2, table, logger, context));
+
+   std::weak_ptr<Backwards::Engine::FunctionContext> fact = getFunction(global, "f");
+   std::weak_ptr<Backwards::Engine::FunctionContext> outer = getFunction(global, "g");
+   std::weak_ptr<Backwards::Engine::FunctionContext> plain = getFunction(global, "h");
+   std::weak_ptr<Backwards::Engine::FunctionContext> self = getFunction(global, "k");
+   EXPECT_EQ(0U, Backwards::Parser::CycleCollector::collect());
+
+      // Keep a value made by the function itself: that keeps it alive.
+   std::shared_ptr<Backwards::Types::ValueType> made = Backwards::Engine::FunctionCall(Backwards::Input::TokenHandle(),
+      std::make_shared<Backwards::Engine::Constant>(Backwards::Input::TokenHandle(), global.vars[global.var.find("k")->second]),
+      std::vector<std::shared_ptr<Backwards::Engine::Expression> >()).evaluate(context);
+
+   parse.reset();
+   for (const char* name : { "f", "g", "h", "k" })
+    {
+      global.vars[global.var.find(name)->second] = std::make_shared<Backwards::Types::FloatValue>();
+    }
+   EXPECT_TRUE(plain.expired()); // No cycle: reference counting frees it.
+   EXPECT_FALSE(fact.expired());
+   EXPECT_FALSE(outer.expired());
+   EXPECT_FALSE(self.expired());
+
+   EXPECT_EQ(3U, Backwards::Parser::CycleCollector::collect()); // fact, outer and inner
+   EXPECT_TRUE(fact.expired());
+   EXPECT_TRUE(outer.expired());
+   EXPECT_FALSE(self.expired());
+
+   made.reset();
+   EXPECT_EQ(1U, Backwards::Parser::CycleCollector::collect());
+   EXPECT_TRUE(self.expired());
+   EXPECT_EQ(0U, Backwards::Parser::CycleCollector::collect());
+ }
+
+TEST(ParserTests, testLibraryCache)
+ {
+   const std::string source =
+      "set fact to function (n) is "
+      "   if n = 0 then return 1 end "
+      "   return n * fact(n - 1) "
+      "end "
+      "set fee to function (code) is "
+      "   select code from "
+      "      case 'A' is return 1 "
+      "      case 'B' is return 2 "
+      "      case 'C' is return 3 "
+      "      case 'D' is return 4 "
+      "      case else is return 0 "
+      "   end "
+      "end "
+      "set sum to function (n) is "
+      "   set total to 0 "
+      "   for i from 1 to n do "
+      "      set total to total + i * 2 "
+      "   end "
+      "   while n > 0 do "
+      "      set n to n - 1 "
+      "      if n = 2 then break end "
+      "   end "
+      "   return total + n "
+      "end "
+      "set adder to function (n) is "
+      "   return function [n] (m) [k] is return m + k end "
+      "end "
+      "set greet to function (name) is return 'Hello, ' + name end "
+      ;
+   const char* calls [] = { "fact(6)", "fee('B') + fee('D') * 10 + fee('Z') * 100", "sum(4)", "adder(3)(4)", "greet('you') = 'Hello, you'" };
+   const double results [] = { 720.0, 42.0, 22.0, 7.0, 1.0 };
+
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+
+   context.logger = &logger;
+   context.debugger = nullptr;
+   context.globalScope = &global;
+
+   const std::string key = Backwards::Parser::LibraryCache::key(source, "InputString", global);
+   const size_t firstGlobal = global.names.size();
+   Backwards::Input::StringInput string (source);
+   Backwards::Input::Lexer lexer (string, "InputString");
+   std::shared_ptr<Backwards::Engine::Statement> parse = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, parse.get());
+   const std::string data = Backwards::Parser::LibraryCache::save(key, parse, global, firstGlobal);
+   ASSERT_FALSE(data.empty());
+   parse->execute(context);
+
+      // A fresh program reads it back, and gets the same answers.
+   Backwards::Engine::Scope global2;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global2);
+   Backwards::Parser::GetterSetter gs2;
+   Backwards::Parser::SymbolTable table2 (gs2, global2);
+   Backwards::Engine::CallingContext context2;
+
+   context2.logger = &logger;
+   context2.debugger = nullptr;
+   context2.globalScope = &global2;
+
+   EXPECT_EQ(key, Backwards::Parser::LibraryCache::key(source, "InputString", global2));
+   EXPECT_NE(key, Backwards::Parser::LibraryCache::key(source + " ", "InputString", global2));
+   EXPECT_NE(key, Backwards::Parser::LibraryCache::key(source, "OtherString", global2));
+
+      // A stale or damaged cache changes nothing.
+   EXPECT_EQ(nullptr, Backwards::Parser::LibraryCache::load("0123456789abcdef", data, table2, global2).get());
+   EXPECT_EQ(nullptr, Backwards::Parser::LibraryCache::load(key, data.substr(0U, data.size() / 2U), table2, global2).get());
+   EXPECT_EQ(nullptr, Backwards::Parser::LibraryCache::load(key, data + "x", table2, global2).get());
+   std::string flipped = data;
+   flipped[flipped.size() - 2U] ^= 0x01;
+   EXPECT_EQ(nullptr, Backwards::Parser::LibraryCache::load(key, flipped, table2, global2).get());
+   EXPECT_EQ(firstGlobal, global2.names.size());
+
+      // A variable outside of where it lives is a miss, even in a file that is otherwise whole.
+   for (const std::shared_ptr<Backwards::Engine::Getter>& getter : std::vector<std::shared_ptr<Backwards::Engine::Getter> > {
+      std::make_shared<Backwards::Engine::GlobalGetter>(global2.names.size()), std::make_shared<Backwards::Engine::LocalGetter>(0U) })
+    {
+      std::shared_ptr<Backwards::Engine::Statement> stray = std::make_shared<Backwards::Engine::Expr>(Backwards::Input::TokenHandle(),
+         std::make_shared<Backwards::Engine::Variable>(Backwards::Input::TokenHandle(), getter));
+      const std::string strayData = Backwards::Parser::LibraryCache::save(key, stray, global2, global2.names.size());
+      ASSERT_FALSE(strayData.empty());
+      EXPECT_EQ(nullptr, Backwards::Parser::LibraryCache::load(key, strayData, table2, global2).get());
+    }
+
+   std::shared_ptr<Backwards::Engine::Statement> load = Backwards::Parser::LibraryCache::load(key, data, table2, global2);
+   ASSERT_NE(nullptr, load.get());
+   EXPECT_EQ(global.names, global2.names);
+   load->execute(context2);
+
+   for (size_t i = 0U; i < sizeof(results) / sizeof(results[0]); ++i)
+    {
+      Backwards::Input::StringInput call1 (calls[i]);
+      Backwards::Input::Lexer lexer1 (call1, "InputString");
+      EXPECT_EQ(results[i], parseAndEvaluateDouble(lexer1, table, logger, context));
+      Backwards::Input::StringInput call2 (calls[i]);
+      Backwards::Input::Lexer lexer2 (call2, "InputString");
+      EXPECT_EQ(results[i], parseAndEvaluateDouble(lexer2, table2, logger, context2));
+    }
+
+   EXPECT_NE(nullptr, std::dynamic_pointer_cast<Backwards::Engine::SelectStatement>(getFunction(global2, "fee")->function)->table.get());
+   EXPECT_EQ(getFunction(global, "fact")->pure, getFunction(global2, "fact")->pure);
+
+      // The globals it adds are already there, so it can't be loaded again.
+   EXPECT_EQ(nullptr, Backwards::Parser::LibraryCache::load(key, data, table2, global2).get());
+ }
+
+TEST(ParserTests, testLazyFunctions)
+ {
+   const std::string source =
+      "set fact to function factorial (n) is "
+      "   if n = 0 then return 1 end "
+      "   return n * factorial(n - 1) "
+      "end "
+      "set sum to function (n) is "
+      "   set total to 0 "
+      "   for i from 1 to n do "
+      "      select i from case 2 is set total to total + 10 case else is set total to total + i end "
+      "   end "
+      "   while n > 0 do set n to n - 1 end "
+      "   return total + n "
+      "end "
+      "set twice to function [2] (n) [k] is "
+      "   set f to function (m) is return m * 2 end "
+      "   return f(n) + k "
+      "end "
+      "set early to function () is "
+      "   set later to 5 "
+      "   return later "
+      "end "
+      "set later to 1 "
+      "set broken to function () is "
+      "   return 1 + "
+      "end "
+      ;
+   const char* calls [] = { "fact(5)", "sum(4)", "twice(3)", "early() + later * 10" };
+   const double results [] = { 120.0, 18.0, 8.0, 15.0 };
+
+   Backwards::Engine::Scope global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+   Backwards::Engine::CallingContext context;
+   StringLogger logger;
+
+   context.logger = &logger;
+   context.debugger = nullptr;
+   context.globalScope = &global;
+
+   std::shared_ptr<Backwards::Engine::Statement> parse = Backwards::Parser::Parser::ParseFunctionsLazily(source, "InputString", table, global, logger);
+   ASSERT_NE(nullptr, parse.get());
+   EXPECT_EQ(0U, logger.logs.size());
+   EXPECT_EQ(nullptr, table.lazySource.get());
+   parse->execute(context);
+
+      // Only the signature has been read.
+   std::shared_ptr<Backwards::Engine::FunctionContext> fact = getFunction(global, "fact");
+   EXPECT_EQ(nullptr, fact->function.get());
+   EXPECT_NE(nullptr, fact->deferred.get());
+   EXPECT_EQ(1U, fact->nargs);
+   EXPECT_EQ(1U, getFunction(global, "twice")->ncaptures);
+
+      // The same answers as an eager parse. The function defined before "later" gets its own local, as it would have.
+   for (size_t i = 0U; i < sizeof(results) / sizeof(results[0]); ++i)
+    {
+      Backwards::Input::StringInput call (calls[i]);
+      Backwards::Input::Lexer lexer (call, "InputString");
+      EXPECT_EQ(results[i], parseAndEvaluateDouble(lexer, table, logger, context));
+    }
+   EXPECT_NE(nullptr, fact->function.get());
+   EXPECT_EQ(nullptr, getFunction(global, "broken")->function.get());
+
+      // An error in a body is an error on every call, and is logged the first time, with where it is.
+   Backwards::Input::StringInput call ("broken()");
+   Backwards::Input::Lexer lexer (call, "InputString");
+   std::shared_ptr<Backwards::Engine::Expression> broken = Backwards::Parser::Parser::ParseFullExpression(lexer, table, logger);
+   ASSERT_NE(nullptr, broken.get());
+   std::string first;
+   try
+    {
+      broken->evaluate(context);
+      FAIL() << "A body that doesn't parse was run.";
+    }
+   catch (const Backwards::Engine::FatalException& e)
+    {
+      first = e.what();
+    }
+   ASSERT_EQ(1U, logger.logs.size());
+   EXPECT_NE(std::string::npos, logger.logs[0].find("on line 1 in file InputString"));
+   EXPECT_NE(std::string::npos, first.find(logger.logs[0]));
+   try
+    {
+      broken->evaluate(context);
+      FAIL() << "A body that doesn't parse was run.";
+    }
+   catch (const Backwards::Engine::FatalException& e)
+    {
+      EXPECT_EQ(first, e.what());
+    }
+   EXPECT_EQ(1U, logger.logs.size());
+
+      // Check parses whatever is left.
+   Backwards::Engine::Scope global2;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global2);
+   Backwards::Parser::GetterSetter gs2;
+   Backwards::Parser::SymbolTable table2 (gs2, global2);
+   Backwards::Engine::CallingContext context2;
+
+   context2.logger = &logger;
+   context2.debugger = nullptr;
+   context2.globalScope = &global2;
+
+   parse = Backwards::Parser::Parser::ParseFunctionsLazily(source, "InputString", table2, global2, logger);
+   ASSERT_NE(nullptr, parse.get());
+   parse->execute(context2);
+
+      // A body parsed on another thread doesn't read the global scope, which may be growing meanwhile.
+   std::shared_ptr<Backwards::Engine::FunctionContext> sum = getFunction(global2, "sum");
+   Backwards::Engine::CallingContext other;
+   other.logger = &logger;
+   std::thread resolver ([&sum, &other]() { sum->deferred->resolve(sum, other); });
+   for (int i = 0; i < 200; ++i)
+    {
+      Backwards::Input::StringInput more ("set extra" + std::to_string(i) + " to " + std::to_string(i));
+      Backwards::Input::Lexer moreLexer (more, "InputString");
+      EXPECT_NE(nullptr, Backwards::Parser::Parser::Parse(moreLexer, table2, logger).get());
+    }
+   resolver.join();
+   EXPECT_NE(nullptr, sum->function.get());
+
+   logger.logs.clear();
+   EXPECT_EQ(1U, Backwards::Parser::LazyFunction::check(global2, logger));
+   EXPECT_EQ(1U, logger.logs.size());
+   EXPECT_NE(nullptr, getFunction(global2, "sum")->function.get());
+   EXPECT_EQ(1U, Backwards::Parser::LazyFunction::check(global2, logger));
+
+      // A body that never ends is still an error up front.
+   Backwards::Engine::Scope global3;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global3);
+   Backwards::Parser::GetterSetter gs3;
+   Backwards::Parser::SymbolTable table3 (gs3, global3);
+   EXPECT_EQ(nullptr, Backwards::Parser::Parser::ParseFunctionsLazily("set f to function () is if 1 then return 1 end ", "InputString", table3, global3, logger).get());
+ }
@@ -237,18 +237,26 @@ TEST(EngineTests, testJustCalls) // Don't bother validating that the output is c
    (void) Backwards::Engine::Sqr(makeFloatValue(30.0));
    EXPECT_THROW(Backwards::Engine::Sqr(std::make_shared<Backwards::Types::StringValue>("hello")), Backwards::Types::TypedOperationException);
 
+   Backwards::Engine::CallingContext context;
+   Backwards::Engine::CallingContext other;
    EXPECT_EQ(DM_FE_TONEAREST, dm_fegetround());
-   (void) Backwards::Engine::SetRoundMode(makeFloatValue(4.0));
-   (void) Backwards::Engine::SetRoundMode(makeFloatValue(7.0));
+   (void) Backwards::Engine::SetRoundMode(context, makeFloatValue(4.0));
+   (void) Backwards::Engine::SetRoundMode(context, makeFloatValue(7.0));
    EXPECT_EQ(DM_FE_FROMZERO, dm_fegetround());
-   EXPECT_THROW(Backwards::Engine::SetRoundMode(makeFloatValue(30.0)), Backwards::Types::TypedOperationException);
-   EXPECT_THROW(Backwards::Engine::SetRoundMode(makeFloatValue(-1.0)), Backwards::Types::TypedOperationException);
-   EXPECT_THROW(Backwards::Engine::SetRoundMode(std::make_shared<Backwards::Types::StringValue>("hello")), Backwards::Types::TypedOperationException);
+   EXPECT_EQ(DM_FE_FROMZERO, context.roundMode);
+   EXPECT_THROW(Backwards::Engine::SetRoundMode(context, makeFloatValue(30.0)), Backwards::Types::TypedOperationException);
+   EXPECT_THROW(Backwards::Engine::SetRoundMode(context, makeFloatValue(-1.0)), Backwards::Types::TypedOperationException);
+   EXPECT_THROW(Backwards::Engine::SetRoundMode(context, std::make_shared<Backwards::Types::StringValue>("hello")), Backwards::Types::TypedOperationException);
 
       // Nasty assumption that previous part of test has been run.
-   res = Backwards::Engine::GetRoundMode();
+   res = Backwards::Engine::GetRoundMode(context);
    ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*res.get()));
    EXPECT_EQ(dm_double_fromdouble(7.0), std::dynamic_pointer_cast<Backwards::Types::FloatValue>(res)->value);
+
+      // The other context never asked for a mode, so it still has the one it started with.
+   res = Backwards::Engine::GetRoundMode(other);
+   ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*res.get()));
+   EXPECT_EQ(dm_double_fromdouble(0.0), std::dynamic_pointer_cast<Backwards::Types::FloatValue>(res)->value);
    dm_fesetround(DM_FE_TONEAREST);
  }
 
@@ -42,6 +42,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Types/CellRefValue.h"
 #include "Backwards/Types/CellRangeValue.h"
 
+#include "Backwards/Engine/Profiler.h"
+
 /*
    NOTE : The base cases for add/sub/mul/div for ArrayValue/DictionaryValue in ValueType.cpp are impossible calls.
    Those two values intercept the base call and commute first, so there can never be a type error.
@@ -159,6 +161,31 @@ TEST(TypesTests, testFloats)
    EXPECT_NE(static_cast<size_t>(dm_double_fromdouble(low.value)), low.hash());
  }
 
+TEST(TypesTests, testSmallIntegers)
+ {
+      // Values are only counted while a profiler exists.
+   size_t created = Backwards::Types::ValueType::created;
+   (void) Backwards::Types::FloatValue::make(dm_double_fromdouble(0.5));
+   EXPECT_EQ(created, Backwards::Types::ValueType::created);
+   Backwards::Engine::Profiler profiler;
+
+   std::shared_ptr<Backwards::Types::FloatValue> five = Backwards::Types::FloatValue::make(dm_double_fromdouble(5.0)); // The table is built by now.
+   created = Backwards::Types::ValueType::created;
+   EXPECT_EQ(five.get(), Backwards::Types::FloatValue::make(dm_double_fromdouble(5.0)).get());
+   EXPECT_EQ(five.get(), Backwards::Types::FloatValue::make(dm_double_fromdouble(5.0)).get());
+   EXPECT_TRUE(dm_double_isequal(dm_double_fromdouble(5.0), five->value));
+   EXPECT_EQ(Backwards::Types::FloatValue::make(dm_double_fromdouble(-128.0)).get(), Backwards::Types::FloatValue::make(dm_double_fromdouble(-128.0)).get());
+   EXPECT_EQ(Backwards::Types::FloatValue::make(dm_double_fromdouble(1023.0)).get(), Backwards::Types::FloatValue::make(dm_double_fromdouble(1023.0)).get());
+   EXPECT_EQ(0U, Backwards::Types::ValueType::created - created);
+
+   created = Backwards::Types::ValueType::created;
+   std::shared_ptr<Backwards::Types::FloatValue> half = Backwards::Types::FloatValue::make(dm_double_fromdouble(0.5));
+   EXPECT_NE(half.get(), Backwards::Types::FloatValue::make(dm_double_fromdouble(0.5)).get());
+   EXPECT_NE(Backwards::Types::FloatValue::make(dm_double_fromdouble(1024.0)).get(), Backwards::Types::FloatValue::make(dm_double_fromdouble(1024.0)).get());
+   EXPECT_EQ(4U, Backwards::Types::ValueType::created - created);
+   EXPECT_TRUE(dm_double_isequal(dm_double_fromdouble(0.5), half->value));
+ }
+
 TEST(TypesTests, testStrings)
  {
    Backwards::Types::StringValue defaulted;
@@ -239,6 +266,30 @@ TEST(TypesTests, testStrings)
    EXPECT_THROW(high.div(dynamic_cast<Backwards::Types::ValueType&>(med)), Backwards::Types::TypedOperationException);
 
    EXPECT_NE(0U, low.hash());
+
+      // Copies and interned Strings share their text.
+   Backwards::Types::StringValue copy (med);
+   EXPECT_EQ(med.holder.get(), copy.holder.get());
+   EXPECT_EQ(&med.value, &copy.value);
+   EXPECT_TRUE(med.equal(copy));
+   EXPECT_FALSE(med.sort(copy));
+   EXPECT_EQ(med.hash(), copy.hash());
+
+   Backwards::Types::StringValue other ("M");
+   EXPECT_NE(med.holder.get(), other.holder.get());
+   EXPECT_TRUE(med.equal(other));
+   EXPECT_FALSE(med.notEqual(other));
+   EXPECT_EQ(med.hash(), other.hash());
+
+   std::shared_ptr<Backwards::Types::StringValue> first = Backwards::Types::StringValue::intern("key");
+   std::shared_ptr<Backwards::Types::StringValue> second = Backwards::Types::StringValue::intern("key");
+   EXPECT_EQ(first.get(), second.get());
+   EXPECT_EQ("key", first->value);
+   EXPECT_NE(first.get(), Backwards::Types::StringValue::intern("Key").get());
+
+   temp = defaulted.add(med);
+   ASSERT_TRUE(typeid(Backwards::Types::StringValue) == typeid(*temp.get()));
+   EXPECT_EQ(med.holder.get(), std::dynamic_pointer_cast<Backwards::Types::StringValue>(temp)->holder.get());
  }
 
 class DummyFOH final : public Backwards::Types::FunctionObjectHolder
@@ -1358,3 +1409,23 @@ TEST(TypesTests, testCellRange)
 
    EXPECT_EQ(0U, low.hash());
  }
+
+TEST(TypesTests, testTypeTags)
+ {
+   EXPECT_EQ(Backwards::Types::FLOAT, Backwards::Types::FloatValue().getType());
+   EXPECT_EQ(Backwards::Types::STRING, Backwards::Types::StringValue().getType());
+   EXPECT_EQ(Backwards::Types::ARRAY, Backwards::Types::ArrayValue().getType());
+   EXPECT_EQ(Backwards::Types::DICTIONARY, Backwards::Types::DictionaryValue().getType());
+   EXPECT_EQ(Backwards::Types::FUNCTION, Backwards::Types::FunctionValue().getType());
+   EXPECT_EQ(Backwards::Types::NIL, Backwards::Types::NilValue().getType());
+   EXPECT_EQ(Backwards::Types::CELL_REF, Backwards::Types::CellRefValue().getType());
+   EXPECT_EQ(Backwards::Types::CELL_RANGE, Backwards::Types::CellRangeValue().getType());
+
+   Backwards::Types::StringValue str ("A");
+   Backwards::Types::StringValue copy (str);
+   EXPECT_EQ(Backwards::Types::STRING, copy.getType());
+
+   Backwards::Types::FloatValue one (dm_double_fromdouble(1.0));
+   EXPECT_FALSE(one.compare(str));
+   EXPECT_TRUE(str.compare(copy));
+ }
@@ -0,0 +1,118 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_ENGINE_BUDGET_H
+#define BACKWARDS_ENGINE_BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+    /*
+      Limits on how much work a run of code may do. Set CallingContext::budget to one of these,
+      call start(), and function calls and loop iterations will throw a FatalException once a limit is passed.
+      A step is one function call or one loop iteration. A limit of zero is no limit.
+      A run may be nested in another (a cell in a recalc), in which case it is held to whatever is left
+      of the outer run's limits as well as its own, and its steps are charged to the outer run by finish().
+      Setting cancelled, from any thread or a signal handler, stops the run (and any run nested in it) at the next check.
+    */
+   class Budget final
+    {
+   public:
+      static const size_t STEPS_PER_CHECK = 64U;
+
+      Budget();
+      Budget(const Budget&) = delete;
+      Budget& operator=(const Budget&) = delete;
+
+      size_t maxSteps;
+      std::chrono::steady_clock::duration maxTime;
+      size_t maxDepth;
+
+      std::atomic<bool> cancelled;
+
+       // Begin a run, clearing any earlier cancellation. The outer run may be null.
+      void start (Budget* outer);
+      void finish ();
+
+      void step ()
+       {
+         if (++used >= nextCheck)
+          {
+            check();
+          }
+       }
+
+       // Count steps taken elsewhere, as if they were taken here.
+      void charge (size_t count)
+       {
+         const size_t room = (used < stepLimit) ? (stepLimit - used) : 0U;
+         used += (count > room) ? (room + 1U) : count; // Just over the limit, as step() would have stopped.
+         if (used >= nextCheck)
+          {
+            check();
+          }
+       }
+
+      void depth (size_t frames) const
+       {
+         if ((0U != depthLimit) && (frames > depthLimit))
+          {
+            tooDeep();
+          }
+       }
+
+      size_t steps () const;
+
+   private:
+      void check ();
+      void tooDeep () const;
+
+      Budget* outer;
+      size_t used;
+      size_t nextCheck;
+      size_t stepLimit;
+      size_t depthLimit; // Zero if unlimited.
+      bool timed;
+      std::chrono::steady_clock::time_point deadline;
+    };
+
+ } // namespace Engine
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_ENGINE_BUDGET_H */
@@ -49,8 +49,12 @@ namespace Input
 namespace Engine
  {
 
+   class Budget;
    class DebuggerHook;
    class Logger;
+   class MemoCache;
+   class Profiler;
+   class Sampler;
    class StackFrame;
    class Statement;
 
@@ -65,6 +69,13 @@ namespace Engine
 
       Logger* logger;
       DebuggerHook* debugger;
+      Profiler* profiler;
+      Sampler* sampler;
+      Budget* budget;
+      MemoCache* memo; // The remembered calls to pure functions, when the owner of this context wants them.
+
+         // The rounding mode that this context's SetRoundMode last asked for, and that GetRoundMode reports.
+      int roundMode;
 
       StackFrame* currentFrame;
       Scope* globalScope;
@@ -89,6 +100,7 @@ namespace Engine
    public:
       GlobalGetter(size_t location);
       std::shared_ptr<Types::ValueType> get(CallingContext&) const;
+      size_t getLocation() const { return location; }
     };
 
    class GlobalSetter final : public Setter
@@ -98,6 +110,7 @@ namespace Engine
    public:
       GlobalSetter(size_t location);
       void set(CallingContext&, const std::shared_ptr<Types::ValueType>&) const;
+      size_t getLocation() const { return location; }
     };
 
    class ScopeGetter final : public Getter
@@ -107,6 +120,7 @@ namespace Engine
    public:
       ScopeGetter(size_t location);
       std::shared_ptr<Types::ValueType> get(CallingContext&) const;
+      size_t getLocation() const { return location; }
     };
 
    class ScopeSetter final : public Setter
@@ -116,6 +130,7 @@ namespace Engine
    public:
       ScopeSetter(size_t location);
       void set(CallingContext&, const std::shared_ptr<Types::ValueType>&) const;
+      size_t getLocation() const { return location; }
     };
 
    typedef std::shared_ptr<Types::ValueType> (*ConstantFunctionPointer)(void);
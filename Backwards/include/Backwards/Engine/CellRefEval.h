@@ -45,6 +45,9 @@ namespace Engine
     {
    public:
       virtual std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const = 0;
+
+         // What a call given this may be remembered by, here: anything that means the same thing has an equal key. Null if it can't be remembered.
+      virtual std::shared_ptr<Types::ValueType> key (CallingContext&) const { return std::shared_ptr<Types::ValueType>(); }
     };
 
  } // namespace Engine
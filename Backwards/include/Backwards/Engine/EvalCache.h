@@ -0,0 +1,88 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_ENGINE_EVALCACHE_H
+#define BACKWARDS_ENGINE_EVALCACHE_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+   class Expression;
+   class Scope;
+
+    /*
+      The expressions that Eval has parsed against a Scope, most recently used first.
+      A parsed expression reads variables by their position in the global scope and the top scope,
+      so it remains good until one of those scopes gains a variable that could change what a name means.
+      An entry is stamped with the global scope and the number of variables in each scope when it was parsed,
+      and is thrown away when the stamp no longer matches.
+      The cache of a frozen Scope is used by several threads at once, so every access takes the lock.
+    */
+   class EvalCache final
+    {
+   public:
+      static const size_t CAPACITY;
+
+      std::shared_ptr<Expression> get (const std::string&, const Scope*, size_t, size_t);
+      void put (const std::string&, const Scope*, size_t, size_t, const std::shared_ptr<Expression>&);
+
+      size_t size() const;
+
+   private:
+      class Entry final
+       {
+      public:
+         std::string text;
+         const Scope* global;
+         size_t globals;
+         size_t scoped;
+         std::shared_ptr<Expression> expr;
+       };
+
+      std::list<Entry> entries;
+      std::map<std::string, std::list<Entry>::iterator> index;
+      mutable std::mutex lock;
+    };
+
+ } // namespace Engine
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_ENGINE_EVALCACHE_H */
@@ -33,7 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define BACKWARDS_ENGINE_EXPRESSION_H
 
 #include "Backwards/Engine/CallingContext.h"
-#include "Backwards/Input/Token.h"
+#include "Backwards/Input/TokenHandle.h"
 
 namespace Backwards
  {
@@ -46,16 +46,16 @@ namespace Engine
    class Expression
     {
    public:
-      Input::Token token;
+      Input::TokenHandle token;
 
-      Expression(const Input::Token&);
+      Expression(const Input::TokenHandle&);
       virtual ~Expression() = default;
 
        /* CallingContext can't be const, because if we propagate it
           to a function call, the function call is allowed to modify it. */
       virtual std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const = 0;
 
-      static std::string constructMessage(const Types::TypedOperationException&, const Input::Token&);
+      static std::string constructMessage(const Types::TypedOperationException&, const Input::TokenHandle&);
       std::string constructMessage(const Types::TypedOperationException&) const;
     };
 
@@ -64,7 +64,7 @@ namespace Engine
    public:
       std::shared_ptr<Types::ValueType> value;
 
-      Constant(const Input::Token&, const std::shared_ptr<Types::ValueType>&);
+      Constant(const Input::TokenHandle&, const std::shared_ptr<Types::ValueType>&);
 
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const;
     };
@@ -74,7 +74,7 @@ namespace Engine
    public:
       std::shared_ptr<Getter> getter;
 
-      Variable(const Input::Token&, const std::shared_ptr<Getter>&);
+      Variable(const Input::TokenHandle&, const std::shared_ptr<Getter>&);
 
       std::shared_ptr<Types::ValueType> evaluate (CallingContext& context) const;
     };
@@ -84,7 +84,7 @@ namespace Engine
     { \
    public: \
       std::shared_ptr<Expression> lhs, rhs; \
-      x(const Input::Token&, const std::shared_ptr<Expression>&, const std::shared_ptr<Expression>&); \
+      x(const Input::TokenHandle&, const std::shared_ptr<Expression>&, const std::shared_ptr<Expression>&); \
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const; \
     };
 
@@ -108,7 +108,7 @@ namespace Engine
     { \
    public: \
       std::shared_ptr<Expression> arg; \
-      x(const Input::Token&, const std::shared_ptr<Expression>&); \
+      x(const Input::TokenHandle&, const std::shared_ptr<Expression>&); \
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const; \
     };
 
@@ -123,9 +123,12 @@ namespace Engine
       std::shared_ptr<Expression> location;
       std::vector<std::shared_ptr<Expression> > args;
 
-      FunctionCall(const Input::Token&, const std::shared_ptr<Expression>&, const std::vector<std::shared_ptr<Expression> >&);
+      FunctionCall(const Input::TokenHandle&, const std::shared_ptr<Expression>&, const std::vector<std::shared_ptr<Expression> >&);
 
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const;
+
+       // Validate that LOC is a Function that can be called with our arguments, and return it.
+      std::shared_ptr<FunctionContext> getFunction (CallingContext&, const std::shared_ptr<Types::ValueType>& LOC) const;
     };
 
 
@@ -134,11 +137,9 @@ namespace Engine
     {
    public:
       std::shared_ptr<FunctionContext> prototype;
-      std::weak_ptr<FunctionContext> prototypeToo;
       std::vector<std::shared_ptr<Expression> > captures;
 
-      BuildFunction(const Input::Token&, const std::shared_ptr<FunctionContext>&, const std::vector<std::shared_ptr<Expression> >&);
-      BuildFunction(const Input::Token&, const std::vector<std::shared_ptr<Expression> >&, const std::weak_ptr<FunctionContext>&);
+      BuildFunction(const Input::TokenHandle&, const std::shared_ptr<FunctionContext>&, const std::vector<std::shared_ptr<Expression> >&);
 
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const;
     };
@@ -150,12 +151,28 @@ namespace Engine
    public:
       std::shared_ptr<Expression> condition, thenCase, elseCase;
 
-      TernaryOperation(const Input::Token&,
+      TernaryOperation(const Input::TokenHandle&,
          const std::shared_ptr<Expression>&, const std::shared_ptr<Expression>&, const std::shared_ptr<Expression>&);
 
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const;
     };
 
+
+
+      // A loop-invariant subexpression, cached in a hidden local of the current frame.
+      // It is computed on first use, so any error still happens where it always did.
+      // The enclosing InvariantLoop clears the cache every time the loop is entered.
+   class Invariant final : public Expression
+    {
+   public:
+      std::shared_ptr<Expression> expr;
+      size_t location;
+
+      Invariant(const Input::TokenHandle&, const std::shared_ptr<Expression>&, size_t);
+
+      std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const;
+    };
+
  } // namespace Engine
 
  } // namespace Backwards
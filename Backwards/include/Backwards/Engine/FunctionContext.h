@@ -45,10 +45,29 @@ namespace Engine
  {
 
    class Statement;
+   class CallingContext;
+   class FunctionContext;
+
+    /*
+      The body of a function that hasn't been parsed yet: see Parser::LazyFunction.
+      The number of locals is only known once the body is parsed, so a call resolves it before it builds the frame.
+      resolve() is called on every call, so it must be cheap once it has succeeded, and safe to call from many threads.
+      It throws a FatalException if the body can't be parsed, and keeps throwing the same one.
+    */
+   class DeferredBody
+    {
+   public:
+      DeferredBody() = default;
+      virtual ~DeferredBody() = default;
+
+      virtual void resolve (const std::shared_ptr<FunctionContext>&, CallingContext&) = 0;
+    };
 
    class FunctionContext final : public Types::FunctionObjectHolder
     {
    public:
+      FunctionContext() : pure(false) { }
+
       std::string name; // For debugging.
 
       size_t nargs;
@@ -63,6 +82,14 @@ namespace Engine
       std::vector<std::string> argNames;
       std::vector<std::string> localNames;
       std::vector<std::string> captureNames;
+
+         // The function touches nothing but its arguments and locals, apart from calling the global functions in calls.
+         // Whether those are pure is only known when it is called: see MemoCache.
+      bool pure;
+      std::vector<size_t> calls;
+
+         // Until this resolves, function is NULL and only the signature is filled in.
+      std::shared_ptr<DeferredBody> deferred;
     };
 
  } // namespace Engine
@@ -0,0 +1,103 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_ENGINE_MEMOCACHE_H
+#define BACKWARDS_ENGINE_MEMOCACHE_H
+
+#include "Backwards/Types/ValueType.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+   class CallingContext;
+   class FunctionContext;
+
+    /*
+      The answers of calls to pure functions, most recently used first.
+      A call is keyed on the function, the rounding mode, and the values of its arguments.
+      Whether a function is pure depends on the global functions that it calls, so this is decided at the
+      first call and remembered: the remembered answers and the decisions are all forgotten when a global changes.
+      The library's own functions are quicker to call again than to look up, so they aren't remembered.
+      Arguments are remembered by what they mean where the call is made: a cell reference gives its own key(),
+      which a host can make the cell it resolves to, and dictionaries, functions, and ranges are never remembered.
+      A remembered call also remembers the steps it took, to charge them again when it is answered.
+      This is not shared between threads: each CallingContext brings its own.
+    */
+   class MemoCache final
+    {
+   public:
+      static const size_t CAPACITY;
+
+      bool remember (const FunctionContext&, CallingContext&);
+         // The arguments as they are remembered, or false if they can't be.
+      static bool keys (const std::vector<std::shared_ptr<Types::ValueType> >&, CallingContext&, std::vector<std::shared_ptr<Types::ValueType> >&);
+
+      std::shared_ptr<Types::ValueType> get (const FunctionContext*, int, const std::vector<std::shared_ptr<Types::ValueType> >&, size_t& steps);
+      void put (const std::shared_ptr<FunctionContext>&, int, const std::vector<std::shared_ptr<Types::ValueType> >&, const std::shared_ptr<Types::ValueType>&, size_t steps);
+
+      void clear();
+      size_t size() const;
+
+   private:
+      class Entry final
+       {
+      public:
+         std::shared_ptr<FunctionContext> function; // Holding this keeps another function from being built at the same address.
+         int roundMode;
+         std::vector<std::shared_ptr<Types::ValueType> > args;
+         size_t hash;
+         std::shared_ptr<Types::ValueType> result;
+         size_t steps;
+       };
+
+      std::list<Entry> entries;
+      std::unordered_multimap<size_t, std::list<Entry>::iterator> index;
+      std::map<const FunctionContext*, bool> verdicts;
+
+      bool pure (const FunctionContext&, CallingContext&, std::set<const FunctionContext*>&);
+      std::unordered_multimap<size_t, std::list<Entry>::iterator>::iterator find (const FunctionContext*, int, const std::vector<std::shared_ptr<Types::ValueType> >&, size_t);
+    };
+
+ } // namespace Engine
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_ENGINE_MEMOCACHE_H */
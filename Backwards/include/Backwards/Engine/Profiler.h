@@ -0,0 +1,110 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_ENGINE_PROFILER_H
+#define BACKWARDS_ENGINE_PROFILER_H
+
+#include "Backwards/Engine/CallingContext.h"
+
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+   class FunctionContext;
+
+    /*
+      Set CallingContext::profiler to one of these to count and time every function call.
+      Time spent in a function is counted both inclusive and exclusive of the functions it calls;
+      the inclusive time of a recursive function is only counted at its outermost call.
+      Calls are also broken down by site(), which a host can override to say what caused the call.
+    */
+   class Profiler
+    {
+   public:
+      class Record final
+       {
+      public:
+         Record();
+
+         size_t calls;
+         std::chrono::steady_clock::duration inclusive;
+         std::chrono::steady_clock::duration exclusive;
+         size_t allocations;
+
+         size_t active; // Calls in progress, to not count recursion twice.
+       };
+
+      Profiler();
+      virtual ~Profiler();
+
+      Profiler(const Profiler&) = delete;
+      Profiler& operator=(const Profiler&) = delete;
+
+      void enter (const FunctionContext&, CallingContext&);
+      void leave ();
+
+      void clear ();
+      void report (std::ostream&) const;
+
+      virtual std::string site (CallingContext&) const;
+
+      std::map<std::string, Record> functions;
+      std::map<std::string, std::map<std::string, Record> > sites;
+
+      static std::string functionName (const FunctionContext&);
+
+   private:
+      class Active final
+       {
+      public:
+         Record* function;
+         Record* site;
+         std::chrono::steady_clock::time_point start;
+         std::chrono::steady_clock::duration children;
+         size_t created;
+       };
+
+      std::vector<Active> stack;
+    };
+
+ } // namespace Engine
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_ENGINE_PROFILER_H */
@@ -0,0 +1,95 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_ENGINE_ROUNDINGMODE_H
+#define BACKWARDS_ENGINE_ROUNDINGMODE_H
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+    /*
+      libdecmath keeps one rounding mode for the whole process, and every operation on a Float reads it.
+      The mode belongs to a CallingContext, so contexts share the library's by taking turns:
+      any number of threads may evaluate while they agree on the mode, and a thread that wants another one
+      waits until they are done before it installs its own.
+      A thread never waits while it holds a mode, so threads that want different modes can't wait on each other forever.
+    */
+   class RoundingMode final
+    {
+   public:
+       // Held while a context evaluates. Holds nest: a hold for another mode gives the outer mode back when it ends.
+       // That includes a mode changed while the hold was held: a SetRoundMode run by Eval is undone, for the thread,
+       // when the Eval returns, though the context keeps the new mode for its next evaluation.
+      class Hold final
+       {
+      public:
+         explicit Hold(int mode);
+         ~Hold();
+
+         Hold(const Hold&) = delete;
+         Hold& operator=(const Hold&) = delete;
+
+      private:
+         bool wasHolding;
+         int previous;
+       };
+
+       // Held while the constant folder tries every mode in turn. Nobody evaluates in the meantime.
+      class Sweep final
+       {
+      public:
+         Sweep();
+         ~Sweep();
+
+         Sweep(const Sweep&) = delete;
+         Sweep& operator=(const Sweep&) = delete;
+
+      private:
+         bool wasHolding;
+         int previous;
+       };
+
+       // Moves the calling thread to another mode, as SetRoundMode does.
+       // Outside of a Hold, this installs the mode for whoever evaluates next.
+      static void change (int mode);
+
+       // Whether the calling thread is evaluating in some context.
+      static bool evaluating (void);
+    };
+
+ } // namespace Engine
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_ENGINE_ROUNDINGMODE_H */
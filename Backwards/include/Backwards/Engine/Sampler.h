@@ -0,0 +1,97 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_ENGINE_SAMPLER_H
+#define BACKWARDS_ENGINE_SAMPLER_H
+
+#include "Backwards/Engine/CallingContext.h"
+
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+    /*
+      Set CallingContext::sampler to one of these to periodically record the call stack.
+      Function calls and loop iterations poll the sampler. Every POLLS_PER_CHECK polls it looks at
+      the clock, and once an interval has passed it records the stack at that point.
+      So the stack is only ever looked at from the thread running the code, at a point where it is consistent,
+      and a poll usually costs a decrement. Time spent in a single long call to a builtin is charged to
+      wherever the next poll happens: that stack gets one sample for every interval that passed since the last one.
+      Stacks are kept in the "folded" format that flame graph tools read: frames from the root, separated by
+      semicolons, followed by the number of samples.
+    */
+   class Sampler
+    {
+   public:
+      static const size_t POLLS_PER_CHECK = 64U;
+
+      explicit Sampler(std::chrono::steady_clock::duration interval);
+      virtual ~Sampler() = default;
+
+      void poll (CallingContext& context)
+       {
+         if (0U == --countdown)
+          {
+            countdown = POLLS_PER_CHECK;
+            check(context);
+          }
+       }
+
+      void clear ();
+      void report (std::ostream&) const;
+
+       // Adds whatever is below the interpreter's frames to the stack, root first.
+      virtual void outer (CallingContext&, std::vector<std::string>&) const;
+
+      std::map<std::string, size_t> stacks;
+
+   private:
+      void check (CallingContext&);
+      void sample (CallingContext&, size_t weight);
+
+      std::chrono::steady_clock::duration interval;
+      std::chrono::steady_clock::time_point next;
+      size_t countdown;
+    };
+
+ } // namespace Engine
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_ENGINE_SAMPLER_H */
@@ -35,6 +35,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Types/ValueType.h"
 
 #include <map>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -44,15 +45,26 @@ namespace Backwards
 namespace Engine
  {
 
+   class EvalCache;
+
    class Scope final
    {
    public:
+      Scope() : frozen(false) { }
+
       std::string name;
 
       std::vector<std::shared_ptr<Types::ValueType> > vars;
 
       std::map<std::string, size_t> var;
       std::vector<std::string> names;
+
+       // Expressions that Eval has parsed against this scope, created on first use.
+      std::shared_ptr<EvalCache> evalCache;
+
+       // A frozen scope is shared by contexts running on different threads: its variables may be read, but not written.
+       // Freeze a scope only once everything that defines names in it has been parsed.
+      bool frozen;
    };
 
  } // namespace Engine
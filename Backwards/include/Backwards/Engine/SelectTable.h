@@ -0,0 +1,87 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_ENGINE_SELECTTABLE_H
+#define BACKWARDS_ENGINE_SELECTTABLE_H
+
+#include "Backwards/Types/ValueType.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+   class CaseContainer;
+
+    /*
+      A lookup table for the leading cases of a select whose conditions are all constants of one type.
+      Rather than testing the cases one at a time, it finds the first case that matches the control value:
+      with a hash when every case is a String tested for equality, and otherwise with a binary search over
+      the sorted case values, which cut the line into points and the gaps between them.
+      It only answers for a control value of the cases' type that is equal to itself (so not a NaN).
+      Anything else goes through the cases, so that errors are raised just as they always were.
+    */
+   class SelectTable final
+    {
+   public:
+      static const size_t MINIMUM; // The fewest constant cases worth building a table for.
+
+       // Returns null if the leading cases don't make a big enough table.
+      static std::shared_ptr<SelectTable> build (const std::vector<std::shared_ptr<CaseContainer> >&);
+
+       // Returns true if arm is the first case that matches. If not, the cases from arm onward still need to be tested.
+      bool find (const Types::ValueType&, size_t& arm) const;
+
+      size_t size() const { return covered; }
+
+   private:
+      Types::ValueTypes type;
+      size_t covered;
+
+      std::unordered_map<std::string, size_t> strings;
+      size_t otherwise;
+
+      std::vector<std::shared_ptr<Types::ValueType> > points;
+      std::vector<size_t> atPoint;
+      std::vector<size_t> between; // between[i] is the gap below points[i]; the last one is the gap above all of them.
+    };
+
+ } // namespace Engine
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_ENGINE_SELECTTABLE_H */
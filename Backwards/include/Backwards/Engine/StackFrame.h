@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Backwards/Types/ValueType.h"
 #include "Backwards/Engine/GetterSetter.h"
+#include "Backwards/Input/TokenHandle.h"
 
 #include <vector>
 
@@ -58,10 +59,10 @@ namespace Engine
       StackFrame* prev;
       StackFrame* next;
 
-      const Input::Token& callingToken;
+      Input::TokenHandle callingToken;
       size_t depth;
 
-      StackFrame(std::shared_ptr<FunctionContext> function, const Input::Token& callingToken, StackFrame* prev);
+      StackFrame(std::shared_ptr<FunctionContext> function, const Input::TokenHandle& callingToken, StackFrame* prev);
     };
 
    class LocalGetter final : public Getter
@@ -71,6 +72,7 @@ namespace Engine
    public:
       LocalGetter(size_t location);
       std::shared_ptr<Types::ValueType> get(CallingContext&) const;
+      size_t getLocation() const { return location; }
     };
 
    class LocalSetter final : public Setter
@@ -80,6 +82,7 @@ namespace Engine
    public:
       LocalSetter(size_t location);
       void set(CallingContext&, const std::shared_ptr<Types::ValueType>&) const;
+      size_t getLocation() const { return location; }
     };
 
    class ArgGetter final : public Getter
@@ -89,6 +92,7 @@ namespace Engine
    public:
       ArgGetter(size_t location);
       std::shared_ptr<Types::ValueType> get(CallingContext&) const;
+      size_t getLocation() const { return location; }
     };
 
    class ArgSetter final : public Setter
@@ -98,6 +102,7 @@ namespace Engine
    public:
       ArgSetter(size_t location);
       void set(CallingContext&, const std::shared_ptr<Types::ValueType>&) const;
+      size_t getLocation() const { return location; }
     };
 
    class CaptureGetter final : public Getter
@@ -107,6 +112,7 @@ namespace Engine
    public:
       CaptureGetter(size_t location);
       std::shared_ptr<Types::ValueType> get(CallingContext&) const;
+      size_t getLocation() const { return location; }
     };
 
    class CaptureSetter final : public Setter
@@ -116,6 +122,7 @@ namespace Engine
    public:
       CaptureSetter(size_t location);
       void set(CallingContext&, const std::shared_ptr<Types::ValueType>&) const;
+      size_t getLocation() const { return location; }
     };
 
  } // namespace Engine
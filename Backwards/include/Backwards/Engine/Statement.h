@@ -34,7 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Backwards/Engine/CallingContext.h"
 
-#include "Backwards/Input/Token.h"
+#include "Backwards/Input/TokenHandle.h"
 #include "Backwards/Types/ValueType.h"
 
 #include <string>
@@ -48,6 +48,9 @@ namespace Engine
  {
 
    class Expression;
+   class FunctionCall;
+   class FunctionContext;
+   class SelectTable;
 
    class FlowControl final
     {
@@ -62,21 +65,27 @@ namespace Engine
 
       static const size_t NO_TARGET;
 
-      const Input::Token& source;
+      Input::TokenHandle source;
       Type type;
       size_t target;
       std::shared_ptr<Types::ValueType> value;
 
-      FlowControl(const Input::Token&, Type, size_t, const std::shared_ptr<Types::ValueType>&);
+       // A RETURN of a call in tail position: value is the Function called, source is the call.
+       // The caller reuses its stack frame to perform the call.
+      std::shared_ptr<FunctionContext> tailFunction;
+      std::vector<std::shared_ptr<Types::ValueType> > tailArgs;
+
+      FlowControl(const Input::TokenHandle&, Type, size_t, const std::shared_ptr<Types::ValueType>&);
+      FlowControl(const Input::TokenHandle&, const std::shared_ptr<Types::ValueType>&, const std::shared_ptr<FunctionContext>&, std::vector<std::shared_ptr<Types::ValueType> >&&);
       ~FlowControl() = default;
     };
 
    class Statement
     {
    public:
-      Input::Token token;
+      Input::TokenHandle token;
 
-      Statement(const Input::Token&);
+      Statement(const Input::TokenHandle&);
       virtual ~Statement() = default;
 
        /* CallingContext can't be const, because if we propagate it
@@ -87,7 +96,7 @@ namespace Engine
    class NOP final : public Statement
     {
    public:
-      NOP(const Input::Token&);
+      NOP(const Input::TokenHandle&);
 
       std::shared_ptr<FlowControl> execute (CallingContext&) const;
     };
@@ -97,7 +106,7 @@ namespace Engine
    public:
       std::shared_ptr<Expression> expr;
 
-      Expr(const Input::Token&, const std::shared_ptr<Expression>&);
+      Expr(const Input::TokenHandle&, const std::shared_ptr<Expression>&);
 
       std::shared_ptr<FlowControl> execute (CallingContext&) const;
     };
@@ -107,7 +116,7 @@ namespace Engine
    public:
       std::vector<std::shared_ptr<Statement> > statements;
 
-      StatementSeq(const Input::Token&, const std::vector<std::shared_ptr<Statement> >&);
+      StatementSeq(const Input::TokenHandle&, const std::vector<std::shared_ptr<Statement> >&);
 
       std::shared_ptr<FlowControl> execute (CallingContext&) const;
     };
@@ -115,12 +124,12 @@ namespace Engine
    class RecAssignState final
     {
    public:
-      Input::Token token;
+      Input::TokenHandle token;
 
       std::shared_ptr<Expression> index;
       std::shared_ptr<RecAssignState> next;
 
-      RecAssignState(const Input::Token&, const std::shared_ptr<Expression>&);
+      RecAssignState(const Input::TokenHandle&, const std::shared_ptr<Expression>&);
 
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&, const std::shared_ptr<Types::ValueType>& lhs, const std::shared_ptr<Expression>& rhs) const;
 
@@ -137,7 +146,7 @@ namespace Engine
       std::shared_ptr<RecAssignState> index;
       std::shared_ptr<Expression> rhs;
 
-      Assignment(const Input::Token&, const std::shared_ptr<Getter>&, const std::shared_ptr<Setter>&,
+      Assignment(const Input::TokenHandle&, const std::shared_ptr<Getter>&, const std::shared_ptr<Setter>&,
          const std::shared_ptr<RecAssignState>&, const std::shared_ptr<Expression>&);
 
       std::shared_ptr<FlowControl> execute (CallingContext&) const;
@@ -150,7 +159,7 @@ namespace Engine
       std::shared_ptr<Statement> thenSeq;
       std::shared_ptr<Statement> elseSeq;
 
-      IfStatement(const Input::Token&, const std::shared_ptr<Expression>&, const std::shared_ptr<Statement>&, const std::shared_ptr<Statement>&);
+      IfStatement(const Input::TokenHandle&, const std::shared_ptr<Expression>&, const std::shared_ptr<Statement>&, const std::shared_ptr<Statement>&);
 
       std::shared_ptr<FlowControl> execute (CallingContext&) const;
     };
@@ -162,7 +171,7 @@ namespace Engine
       std::shared_ptr<Statement> seq;
       size_t id;
 
-      WhileStatement(const Input::Token&, const std::shared_ptr<Expression>&, const std::shared_ptr<Statement>&, size_t);
+      WhileStatement(const Input::TokenHandle&, const std::shared_ptr<Expression>&, const std::shared_ptr<Statement>&, size_t);
 
       std::shared_ptr<FlowControl> execute (CallingContext&) const;
     };
@@ -178,7 +187,7 @@ namespace Engine
          BELOW
        };
 
-      Input::Token token;
+      Input::TokenHandle token;
 
       bool breaking;
       CaseType type;
@@ -186,7 +195,7 @@ namespace Engine
       std::shared_ptr<Expression> lower;
       std::shared_ptr<Statement> seq;
 
-      CaseContainer(const Input::Token&, bool, CaseType, const std::shared_ptr<Expression>&, const std::shared_ptr<Expression>&, const std::shared_ptr<Statement>&);
+      CaseContainer(const Input::TokenHandle&, bool, CaseType, const std::shared_ptr<Expression>&, const std::shared_ptr<Expression>&, const std::shared_ptr<Statement>&);
 
       bool evaluate (CallingContext&, const std::shared_ptr<Types::ValueType>&) const;
     };
@@ -196,8 +205,9 @@ namespace Engine
    public:
       std::shared_ptr<Expression> control;
       std::vector<std::shared_ptr<CaseContainer> > cases;
+      std::shared_ptr<SelectTable> table; // Built by the optimizer when the leading cases are constants.
 
-      SelectStatement(const Input::Token&, const std::shared_ptr<Expression>&, const std::vector<std::shared_ptr<CaseContainer> >&);
+      SelectStatement(const Input::TokenHandle&, const std::shared_ptr<Expression>&, const std::vector<std::shared_ptr<CaseContainer> >&);
 
       std::shared_ptr<FlowControl> execute (CallingContext&) const;
     };
@@ -218,13 +228,25 @@ namespace Engine
       std::shared_ptr<Statement> seq;
       size_t id;
 
-      ForStatement(const Input::Token&, const std::shared_ptr<Getter>&, const std::shared_ptr<Setter>&,
+      ForStatement(const Input::TokenHandle&, const std::shared_ptr<Getter>&, const std::shared_ptr<Setter>&,
          const std::shared_ptr<Expression>&, bool, const std::shared_ptr<Expression>&,
          const std::shared_ptr<Expression>&, const std::shared_ptr<Statement>&, size_t);
 
       std::shared_ptr<FlowControl> execute (CallingContext&) const;
     };
 
+      // Wraps a loop that had invariant subexpressions hoisted out of it.
+   class InvariantLoop final : public Statement
+    {
+   public:
+      std::vector<size_t> locations;
+      std::shared_ptr<Statement> loop;
+
+      InvariantLoop(const Input::TokenHandle&, const std::vector<size_t>&, const std::shared_ptr<Statement>&);
+
+      std::shared_ptr<FlowControl> execute (CallingContext&) const;
+    };
+
    class FlowControlStatement final : public Statement
     {
    public:
@@ -232,7 +254,17 @@ namespace Engine
       size_t target;
       std::shared_ptr<Expression> value;
 
-      FlowControlStatement(const Input::Token&, FlowControl::Type, size_t, const std::shared_ptr<Expression>&);
+      FlowControlStatement(const Input::TokenHandle&, FlowControl::Type, size_t, const std::shared_ptr<Expression>&);
+
+      std::shared_ptr<FlowControl> execute (CallingContext&) const;
+    };
+
+   class TailCall final : public Statement
+    {
+   public:
+      std::shared_ptr<FunctionCall> call;
+
+      TailCall(const Input::TokenHandle&, const std::shared_ptr<FunctionCall>&);
 
       std::shared_ptr<FlowControl> execute (CallingContext&) const;
     };
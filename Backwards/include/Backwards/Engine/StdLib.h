@@ -48,12 +48,12 @@ namespace Engine
    STDLIB_CONSTANT_DECL(NaN);
    STDLIB_CONSTANT_DECL(NewArray);
    STDLIB_CONSTANT_DECL(NewDictionary);
-   STDLIB_CONSTANT_DECL(GetRoundMode);
 
 #define STDLIB_CONSTANT_DECL_WITH_CONTEXT(x) \
    std::shared_ptr<Types::ValueType> x (CallingContext& context)
 
    STDLIB_CONSTANT_DECL_WITH_CONTEXT(EnterDebugger);
+   STDLIB_CONSTANT_DECL_WITH_CONTEXT(GetRoundMode);
 
 #define STDLIB_UNARY_DECL(x) \
    std::shared_ptr<Types::ValueType> x (const std::shared_ptr<Types::ValueType>& arg)
@@ -82,7 +82,6 @@ namespace Engine
    STDLIB_UNARY_DECL(PopFront);
    STDLIB_UNARY_DECL(PopBack);
    STDLIB_UNARY_DECL(GetKeys);
-   STDLIB_UNARY_DECL(SetRoundMode);
 
 #define STDLIB_UNARY_DECL_WITH_CONTEXT(x) \
    std::shared_ptr<Types::ValueType> x (CallingContext& context, const std::shared_ptr<Types::ValueType>& arg)
@@ -93,6 +92,7 @@ namespace Engine
    STDLIB_UNARY_DECL_WITH_CONTEXT(Info);
    STDLIB_UNARY_DECL_WITH_CONTEXT(DebugPrint);
    STDLIB_UNARY_DECL_WITH_CONTEXT(Eval);
+   STDLIB_UNARY_DECL_WITH_CONTEXT(SetRoundMode);
 
    STDLIB_UNARY_DECL_WITH_CONTEXT(EvalCell);
    STDLIB_UNARY_DECL_WITH_CONTEXT(ExpandRange);
@@ -0,0 +1,77 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_INPUT_STRINGPOOL_H
+#define BACKWARDS_INPUT_STRINGPOOL_H
+
+#include <memory>
+#include <string>
+
+namespace Backwards
+ {
+
+namespace Input
+ {
+
+    /*
+      Interns the strings that parse trees keep of their tokens: names, literals, and file names.
+      A string is only in the pool while something holds it, so the pool shrinks with the trees.
+      The pool is split into stripes, each with its own lock, so that threads parsing at once seldom wait on each other.
+      A thread that is about to intern a great deal can also keep a Local, and then only goes to the pool
+      the first time it sees each string.
+    */
+   class StringPool final
+    {
+   public:
+      static std::shared_ptr<const std::string> intern (const std::string&);
+      static size_t size (void); // How many strings are held.
+
+       // While one is alive, the thread remembers what it has interned, and holds it until the Local ends.
+       // Locals nest: only the outermost one does anything.
+      class Local final
+       {
+      public:
+         Local();
+         ~Local();
+
+         Local(const Local&) = delete;
+         Local& operator=(const Local&) = delete;
+
+      private:
+         bool owner;
+       };
+    };
+
+ } // namespace Input
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_INPUT_STRINGPOOL_H */
@@ -0,0 +1,89 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_INPUT_TOKENHANDLE_H
+#define BACKWARDS_INPUT_TOKENHANDLE_H
+
+#include "Backwards/Input/Token.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace Backwards
+ {
+
+namespace Input
+ {
+
+    /*
+      What the AST keeps of a Token.
+      The line and column are kept in the handle. The text and file name, which repeat across a library,
+      are held from the StringPool, so equal strings are stored once and freed with the last tree that uses them.
+      Strings returned are valid for as long as the handle they came from.
+    */
+   class TokenHandle final
+    {
+   private:
+      std::shared_ptr<const std::string> spelling;
+      std::shared_ptr<const std::string> source;
+      uint32_t line;
+      uint32_t column;
+      Lexeme kind;
+
+   public:
+      TokenHandle() : spelling(), source(), line(0U), column(0U), kind(INVALID) { }
+      TokenHandle(const Token&);
+
+      TokenHandle(const TokenHandle &) = default;
+      TokenHandle& operator= (const TokenHandle &) = default;
+
+      Token token() const;
+
+      Lexeme lexeme() const { return kind; }
+      const std::string& text() const;
+      const std::string& sourceFile() const;
+      size_t lineNumber() const { return line; }
+      size_t lineLocation() const { return column; }
+
+       // Interned strings are equal exactly when they are the same string.
+      friend bool operator== (const TokenHandle& lhs, const TokenHandle& rhs)
+       {
+         return (lhs.kind == rhs.kind) && (lhs.line == rhs.line) && (lhs.column == rhs.column) &&
+            (lhs.spelling == rhs.spelling) && (lhs.source == rhs.source);
+       }
+      friend bool operator!= (const TokenHandle& lhs, const TokenHandle& rhs) { return !(lhs == rhs); }
+    };
+
+ } // namespace Input
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_INPUT_TOKENHANDLE_H */
@@ -0,0 +1,79 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_PARSER_CYCLECOLLECTOR_H
+#define BACKWARDS_PARSER_CYCLECOLLECTOR_H
+
+#include <memory>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+   class FunctionContext;
+ }
+
+namespace Parser
+ {
+
+    /*
+      Values can't form cycles: collections and captures are copied when they are made, and never change after.
+      Code can: a function that names itself builds a Function value of itself, so its body holds a
+      reference to its own FunctionContext, as do two nested functions that call each other.
+      Such a function is never freed by reference counting alone.
+
+      The symbol table tracks every function it builds. collect() does trial deletion over them:
+      it counts the references each function gets from the bodies of tracked functions, and anything
+      with more references than that is in use from outside. Everything those functions reach is in use too.
+      The rest can only be reached from each other, so their bodies are freed, which breaks the cycles.
+      A reference that the walk doesn't see only keeps a function alive that could have been freed.
+
+      collect() looks at every tracked function in the process, so don't call it while anything, on any thread,
+      is parsing or running Backwards code. Nothing here calls it: the host does, when it knows everything is idle.
+    */
+   class CycleCollector final
+    {
+   public:
+      static void track (const std::shared_ptr<Engine::FunctionContext>&);
+
+       // Returns the number of functions freed.
+      static size_t collect ();
+
+       // The number of tracked functions that are still alive.
+      static size_t tracked ();
+    };
+
+ } // namespace Parser
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_PARSER_CYCLECOLLECTOR_H */
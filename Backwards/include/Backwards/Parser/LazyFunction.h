@@ -0,0 +1,118 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_PARSER_LAZYFUNCTION_H
+#define BACKWARDS_PARSER_LAZYFUNCTION_H
+
+#include "Backwards/Engine/FunctionContext.h"
+#include "Backwards/Input/Token.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+   class Logger;
+   class Scope;
+ }
+
+namespace Parser
+ {
+
+    /*
+      The text of a library that was parsed lazily, kept for the bodies that haven't been parsed yet.
+    */
+   class LazySource final
+    {
+   public:
+      LazySource(const std::string& text, const std::string& sourceName, Engine::Scope& global);
+
+      const std::string text;
+      const std::string sourceName;
+      Engine::Scope* const global;
+
+      size_t offset (size_t lineNumber, size_t lineLocation) const; // Where in text a Token starts.
+
+       // Copies what the bodies need from global once the library has been parsed.
+       // The bodies are parsed while other threads run, and global may be written or grown by then.
+      void snapshot (void);
+
+      std::vector<std::string> names; // The names of the globals, after the library was parsed.
+      std::vector<std::shared_ptr<Types::ValueType> > builders; // PushBack and Insert, as the table reads them.
+
+   private:
+      std::vector<size_t> lines; // Where each line of text starts.
+    };
+
+    /*
+      The body of a function defined in a library that was parsed lazily.
+      The parse of the library reads the function's signature, and then only skips to the "end" that closes it.
+      The first call parses the body, with the function as the current context, so it fills in the same FunctionContext
+      that the library's globals already hold, and anything that names the function is still right.
+      The body sees only the globals that existed when it was defined, as it would have then: a global defined
+      later doesn't turn an assignment to a new local into an assignment to the global.
+      A body that doesn't parse fails every call to it with the same error, which is also logged once.
+      check() parses everything that is left, for a program that wants every error up front.
+    */
+   class LazyFunction final : public Engine::DeferredBody
+    {
+   public:
+      LazyFunction(const std::shared_ptr<const LazySource>& source, const Input::Token& first, const Input::Token& last, const std::string& name);
+
+      void resolve (const std::shared_ptr<Engine::FunctionContext>&, Engine::CallingContext&);
+
+       // Parses the body of every function held by a global. Errors go to the logger: returns how many failed.
+      static size_t check (const Engine::Scope& global, Engine::Logger&);
+
+   private:
+      std::shared_ptr<const LazySource> source;
+      size_t begin;
+      size_t end;
+      size_t lineNumber;
+      size_t lineLocation;
+      std::string name; // The name the function had in its own body.
+      size_t nglobals;
+
+      std::mutex lock;
+      std::atomic<bool> done;
+      std::string error;
+    };
+
+ } // namespace Parser
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_PARSER_LAZYFUNCTION_H */
@@ -0,0 +1,84 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_PARSER_LIBRARYCACHE_H
+#define BACKWARDS_PARSER_LIBRARYCACHE_H
+
+#include <memory>
+#include <string>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+   class Logger;
+   class Scope;
+   class Statement;
+ }
+
+namespace Parser
+ {
+   class SymbolTable;
+
+    /*
+      Parsed libraries, saved to disk so that the next run of the program can skip parsing them.
+      What a parse produces depends on more than the text: the names of the globals that already exist decide
+      what an identifier means and where each new global goes, and the layout of the tree is given by VERSION.
+      So the key hashes the text, the name it was loaded from, every global name, and the version.
+      A cached library is the tree that ParseFunctions returned, and the names of the globals that the parse added,
+      so loading it adds the same globals in the same order. Nothing is run: the caller runs the result, as it would a parse.
+      Anything that can't be read back as it was written is a miss, and the library is parsed again: the file carries
+      a checksum of itself, and every variable slot is checked against the frame or scope it will be read from.
+    */
+   class LibraryCache final
+    {
+   public:
+      static const unsigned int VERSION;
+
+      static std::string key (const std::string& text, const std::string& sourceName, const Engine::Scope& global);
+
+       // Returns an empty string if the tree has something in it that can't be saved.
+      static std::string save (const std::string& key, const std::shared_ptr<Engine::Statement>&, const Engine::Scope& global, size_t firstGlobal);
+
+       // Returns NULL, and changes nothing, if the data isn't a library saved with this key.
+      static std::shared_ptr<Engine::Statement> load (const std::string& key, const std::string& data, SymbolTable&, Engine::Scope& global);
+
+       // Parser::ParseFunctions, through a cache in the given directory.
+      static std::shared_ptr<Engine::Statement> ParseFunctions (const std::string& directory, const std::string& text, const std::string& sourceName,
+         SymbolTable&, Engine::Scope& global, Engine::Logger&);
+    };
+
+ } // namespace Parser
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_PARSER_LIBRARYCACHE_H */
@@ -0,0 +1,97 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_PARSER_OPTIMIZER_H
+#define BACKWARDS_PARSER_OPTIMIZER_H
+
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+   class Statement;
+   class Expression;
+   class FunctionContext;
+   class Setter;
+ }
+
+namespace Parser
+ {
+   class GetterSetter;
+
+    /*
+      This runs over a function body after it has been parsed. It does six things:
+      folds constant expressions, drops branches that can never be taken,
+      hoists loop-invariant expressions into hidden locals of the function,
+      builds lookup tables for selects over constant cases,
+      notes whether the function is pure, so that calls to it may be remembered, and
+      turns the return of a function call into a tail call that reuses the caller's stack frame.
+      The function may be called after a SetRoundMode, so arithmetic is only folded when
+      it gives the same answer in every rounding mode. Anything else is left for run time.
+      Trying every mode needs the library's one rounding mode to itself, so a function parsed
+      while other code may be evaluating is given sweep = false, and its arithmetic is left for run time.
+      Likewise, an expression that would raise an error is left alone, so that the error
+      happens when it always did and the debugger still gets to see it.
+    */
+   class Optimizer final
+    {
+   public:
+      Optimizer(Engine::FunctionContext&, const GetterSetter&, bool sweep);
+
+      void optimize();
+
+      static std::shared_ptr<Engine::Expression> fold (const std::shared_ptr<Engine::Expression>&, bool sweep);
+
+   private:
+      Engine::FunctionContext& function;
+      const GetterSetter& gs;
+      bool sweep;
+
+      std::shared_ptr<Engine::Statement> statement (const std::shared_ptr<Engine::Statement>&);
+      std::shared_ptr<Engine::Statement> hoist (const std::shared_ptr<Engine::Statement>&);
+
+      bool isInvariant (Engine::Expression&, const std::set<const Engine::Setter*>&, bool) const;
+      void lift (std::shared_ptr<Engine::Expression>&, const std::set<const Engine::Setter*>&, bool, std::vector<size_t>&);
+
+      bool isPure (Engine::Expression&);
+      bool isPureCallee (Engine::Expression&);
+      void purity ();
+    };
+
+ } // namespace Parser
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_PARSER_OPTIMIZER_H */
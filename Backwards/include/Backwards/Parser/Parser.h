@@ -44,6 +44,7 @@ namespace Engine
    class Statement;
    class Expression;
    class Logger;
+   class Scope;
  }
 
 namespace Parser
@@ -56,6 +57,12 @@ namespace Parser
 
       static std::shared_ptr<Engine::Statement> ParseFunctions (Input::Lexer& src, SymbolTable&, Engine::Logger&);
 
+       // ParseFunctions, but the body of each function is only parsed when it is first called: see LazyFunction.
+      static std::shared_ptr<Engine::Statement> ParseFunctionsLazily (const std::string& text, const std::string& sourceName,
+         SymbolTable&, Engine::Scope& global, Engine::Logger&);
+       // Parses the rest of a function body, up to and including its "end", into the function on top of the table.
+      static std::shared_ptr<Engine::Statement> ParseFunctionBody (Input::Lexer& src, SymbolTable&, Engine::Logger&);
+
       static std::shared_ptr<Engine::Statement> Parse (Input::Lexer& src, SymbolTable&, Engine::Logger&);
       static std::shared_ptr<Engine::Statement> ParseStatement (Input::Lexer& src, SymbolTable&, Engine::Logger&);
 
@@ -87,6 +94,8 @@ namespace Parser
       static std::shared_ptr<Engine::Statement> innerStatementSeq (Input::Lexer& src, SymbolTable&, Engine::Logger&);
 
       static std::shared_ptr<Engine::Expression> expressionRecover (Input::Lexer& src, SymbolTable&, Engine::Logger&);
+
+      static void deferBody (Input::Lexer& src, SymbolTable&);
     };
 
  } // namespace Parser
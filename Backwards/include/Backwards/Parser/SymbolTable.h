@@ -51,6 +51,8 @@ namespace Engine
 namespace Parser
  {
 
+   class LazySource;
+
    class GetterSetter final
     {
    public:
@@ -95,6 +97,8 @@ namespace Parser
       std::shared_ptr<Engine::Getter> getVariableGetter(const std::string&) const;
       std::shared_ptr<Engine::Setter> getVariableSetter(const std::string&) const;
 
+      const GetterSetter& getGetterSetter() const;
+
       std::shared_ptr<Engine::Expression> buildPushBack(const Input::Token&, const std::shared_ptr<Engine::Expression>&, const std::shared_ptr<Engine::Expression>&) const;
       std::shared_ptr<Engine::Expression> buildInsert(const Input::Token&,
          const std::shared_ptr<Engine::Expression>&, const std::shared_ptr<Engine::Expression>&, const std::shared_ptr<Engine::Expression>&) const;
@@ -112,6 +116,7 @@ namespace Parser
        };
 
       std::map<std::string, std::weak_ptr<Engine::FunctionContext> > activeFunctions;
+      std::shared_ptr<const LazySource> lazySource; // Set while Parser::ParseFunctionsLazily runs.
       IdentifierType lookup (const std::string&) const;
 
       size_t newLoop();
@@ -0,0 +1,66 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef BACKWARDS_PARSER_TREEWALK_H
+#define BACKWARDS_PARSER_TREEWALK_H
+
+#include <functional>
+#include <memory>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+   class Statement;
+   class Expression;
+ }
+
+namespace Parser
+ {
+
+    /*
+      Walks over parse trees, for passes that run over a function after it is built.
+      The visitor gets the pointer itself, so that it may replace the node.
+    */
+   typedef std::function<void (std::shared_ptr<Engine::Expression>&)> ExpressionVisitor;
+   typedef std::function<void (std::shared_ptr<Engine::Statement>&)> StatementVisitor;
+
+   void forEachChild (Engine::Expression&, const ExpressionVisitor&);
+   void forEachExpression (Engine::Statement&, const ExpressionVisitor&);
+   void forEachChild (Engine::Statement&, const StatementVisitor&);
+   void forEachStatement (std::shared_ptr<Engine::Statement>&, const StatementVisitor&);
+
+ } // namespace Parser
+
+ } // namespace Backwards
+
+#endif /* BACKWARDS_PARSER_TREEWALK_H */
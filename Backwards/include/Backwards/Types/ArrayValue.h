@@ -48,6 +48,8 @@ namespace Types
    public:
       std::vector<std::shared_ptr<ValueType> > value;
 
+      ArrayValue();
+
       const std::string& getTypeName() const;
 
       std::shared_ptr<ValueType> neg() const;
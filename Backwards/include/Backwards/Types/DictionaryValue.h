@@ -55,6 +55,8 @@ namespace Types
       // Should probably use an unsorted_map. We'll see how this goes.
       std::map<std::shared_ptr<ValueType>, std::shared_ptr<ValueType>, ChristHowHorrifying> value;
 
+      DictionaryValue();
+
       const std::string& getTypeName() const;
 
       std::shared_ptr<ValueType> neg() const;
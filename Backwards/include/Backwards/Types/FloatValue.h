@@ -50,6 +50,10 @@ namespace Types
       FloatValue();
       FloatValue(dm_double value);
 
+       // Values are never changed once made, so every small integer is made once and shared.
+       // Anything else gets a new value.
+      static std::shared_ptr<FloatValue> make (dm_double value);
+
       const std::string& getTypeName() const;
 
       std::shared_ptr<ValueType> neg() const;
@@ -34,6 +34,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Backwards/Types/ValueType.h"
 
+#include <vector>
+
 namespace Backwards
  {
 
@@ -57,12 +59,10 @@ namespace Types
 
    public:
       std::shared_ptr<FunctionObjectHolder> value;
-      std::weak_ptr<FunctionObjectHolder> valueToo;
       std::vector<std::shared_ptr<ValueType> > captures;
 
       FunctionValue();
       FunctionValue(const std::shared_ptr<FunctionObjectHolder>& value, const std::vector<std::shared_ptr<ValueType> >& captures);
-      FunctionValue(const std::vector<std::shared_ptr<ValueType> >& captures, const std::weak_ptr<FunctionObjectHolder>& value);
       FunctionValue(const FunctionValue&) = delete;
 
       FunctionValue& operator=(const FunctionValue&) = delete;
@@ -47,6 +47,9 @@ namespace Types
 
       NilValue();
 
+       // Nil is immutable and all alike, so one can be shared.
+      static std::shared_ptr<NilValue> make();
+
       const std::string& getTypeName() const;
 
       bool equal (const NilValue& lhs) const;
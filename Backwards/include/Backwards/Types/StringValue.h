@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Backwards/Types/ValueType.h"
 
+#include <atomic>
 #include <string>
 
 namespace Backwards
@@ -42,14 +43,49 @@ namespace Backwards
 namespace Types
  {
 
+    /*
+      The immutable body of a String. StringValues share these instead of copying the text around,
+      and the Forwards StringValue uses the same body so that moving a String between the
+      languages is a reference count bump. std::string already keeps short strings inline,
+      so that is where the small-string storage comes from. The hash is computed on first use,
+      by whichever thread gets there first.
+    */
+   class StringHolder final
+    {
+
+   public:
+      const std::string text;
+
+      explicit StringHolder(const std::string& text);
+      explicit StringHolder(std::string&& text);
+
+      size_t hash() const;
+
+   private:
+      mutable std::atomic<size_t> hashCode;
+      mutable std::atomic<bool> hashed;
+
+    };
+
    class StringValue final : public ValueType
     {
 
    public:
-      std::string value;
+      const std::shared_ptr<const StringHolder> holder;
+      const std::string& value;
 
       StringValue();
       StringValue(const std::string& value);
+      StringValue(std::string&& value);
+      StringValue(const char* value);
+      StringValue(const std::shared_ptr<const StringHolder>& holder);
+      StringValue(const StringValue& src);
+
+      StringValue& operator=(const StringValue&) = delete;
+
+         // Returns the one shared StringValue for this text. Meant for identifier-like keys
+         // that the parser sees over and over, not for computed strings.
+      static std::shared_ptr<StringValue> intern (const std::string& value);
 
       const std::string& getTypeName() const;
 
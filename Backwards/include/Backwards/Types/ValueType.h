@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define BACKWARDS_TYPES_VALUETYPE_H
 
 #include <string>
+#include <atomic>
 #include <exception>
 #include <memory>
 
@@ -51,6 +52,18 @@ namespace Types
    class CellRefValue;
    class CellRangeValue;
 
+   enum ValueTypes
+    {
+      FLOAT,
+      STRING,
+      ARRAY,
+      DICTIONARY,
+      FUNCTION,
+      NIL,
+      CELL_REF,
+      CELL_RANGE
+    };
+
    inline void boost_hash_combine(size_t& seed, size_t value)
     {
       seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
@@ -124,9 +137,27 @@ namespace Types
    class ValueType
     {
 
+   private:
+      const ValueTypes type;
+
    public:
+      explicit ValueType(ValueTypes type) : type(type)
+       {
+         if (0U != counting.load(std::memory_order_relaxed))
+          {
+            ++created;
+          }
+       }
       virtual ~ValueType() = default;
 
+         // The number of values created on this thread while a profiler exists: the profiler reports the difference across a call.
+         // Without a profiler, making a value doesn't touch a thread local.
+      static thread_local size_t created;
+      static std::atomic<size_t> counting; // How many profilers exist.
+
+         // Not virtual: the engine checks this before falling back to double dispatch.
+      ValueTypes getType() const { return type; }
+
       virtual const std::string& getTypeName() const = 0;
 
       virtual std::shared_ptr<ValueType> neg() const;
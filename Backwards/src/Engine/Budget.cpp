@@ -0,0 +1,138 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Engine/Budget.h"
+
+#include <exception>
+#include <string>
+
+#include "Backwards/Engine/FatalException.h"
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+   const size_t Budget::STEPS_PER_CHECK;
+
+   static const size_t UNLIMITED = static_cast<size_t>(0U) - 1U;
+
+   Budget::Budget() : maxSteps(0U), maxTime(0), maxDepth(0U), cancelled(false),
+      outer(nullptr), used(0U), nextCheck(STEPS_PER_CHECK), stepLimit(UNLIMITED), depthLimit(0U), timed(false)
+    {
+    }
+
+    // Combine two depth limits where zero is no limit.
+   static size_t tighter (size_t lhs, size_t rhs)
+    {
+      if (0U == lhs)
+       {
+         return rhs;
+       }
+      if (0U == rhs)
+       {
+         return lhs;
+       }
+      return (lhs < rhs) ? lhs : rhs;
+    }
+
+   void Budget::start (Budget* newOuter)
+    {
+      outer = newOuter;
+      used = 0U;
+      cancelled = false;
+
+      stepLimit = (0U != maxSteps) ? maxSteps : UNLIMITED;
+      depthLimit = maxDepth;
+      timed = (std::chrono::steady_clock::duration(0) != maxTime);
+      if (true == timed)
+       {
+         deadline = std::chrono::steady_clock::now() + maxTime;
+       }
+
+      if (nullptr != outer)
+       {
+         const size_t remaining = (outer->used < outer->stepLimit) ? (outer->stepLimit - outer->used) : 0U;
+         if (remaining < stepLimit)
+          {
+            stepLimit = remaining;
+          }
+         depthLimit = tighter(depthLimit, outer->depthLimit);
+         if ((true == outer->timed) && ((false == timed) || (outer->deadline < deadline)))
+          {
+            timed = true;
+            deadline = outer->deadline;
+          }
+       }
+
+      nextCheck = (stepLimit < STEPS_PER_CHECK) ? (stepLimit + 1U) : STEPS_PER_CHECK;
+    }
+
+   void Budget::finish ()
+    {
+      if (nullptr != outer)
+       {
+         outer->used += used;
+       }
+    }
+
+   size_t Budget::steps () const
+    {
+      return used;
+    }
+
+   void Budget::check ()
+    {
+      if (used > stepLimit)
+       {
+         throw FatalException("Execution budget exceeded: ran for more than " + std::to_string(stepLimit) + " function calls and loop iterations.");
+       }
+      if ((true == cancelled) || ((nullptr != outer) && (true == outer->cancelled)))
+       {
+         throw FatalException("Execution cancelled.");
+       }
+      if ((true == timed) && (std::chrono::steady_clock::now() > deadline))
+       {
+         throw FatalException("Execution budget exceeded: ran out of time.");
+       }
+
+      nextCheck = ((stepLimit - used) < STEPS_PER_CHECK) ? (stepLimit + 1U) : (used + STEPS_PER_CHECK);
+    }
+
+   void Budget::tooDeep () const
+    {
+      throw FatalException("Execution budget exceeded: function calls nested more than " + std::to_string(depthLimit) + " deep.");
+    }
+
+ } // namespace Engine
+
+ } // namespace Backwards
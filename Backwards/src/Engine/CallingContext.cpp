@@ -32,15 +32,18 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Engine/CallingContext.h"
 
 #include "Backwards/Engine/FatalException.h"
+#include "Backwards/Engine/MemoCache.h"
 #include "Backwards/Engine/StackFrame.h"
 
+#include "dm_double.h"
+
 namespace Backwards
  {
 
 namespace Engine
  {
 
-   CallingContext::CallingContext() : logger(nullptr), debugger(nullptr), currentFrame(nullptr), globalScope(nullptr)
+   CallingContext::CallingContext() : logger(nullptr), debugger(nullptr), profiler(nullptr), sampler(nullptr), budget(nullptr), memo(nullptr), roundMode(dm_fegetround()), currentFrame(nullptr), globalScope(nullptr)
     {
     }
 
@@ -97,6 +100,11 @@ namespace Engine
     {
       result->logger = logger;
       result->debugger = nullptr; // Prevent Debugger-ception
+      result->profiler = nullptr; // What the user does in the debugger isn't part of the profile.
+      result->sampler = nullptr;
+      result->budget = nullptr; // The user in the debugger gets as long as they like.
+      result->memo = memo; // A global set in the debugger has to clear the remembered calls.
+      result->roundMode = roundMode;
       result->globalScope = globalScope;
       result->pushScope(topScope());
     }
@@ -199,7 +207,15 @@ namespace Engine
 
    void GlobalSetter::set(CallingContext& context, const std::shared_ptr<Types::ValueType>& value) const
     {
+      if (true == context.globalScope->frozen)
+       {
+         throw FatalException("Write of global variable in a shared scope.");
+       }
       context.globalScope->vars[location] = value;
+      if (nullptr != context.memo)
+       {
+         context.memo->clear();
+       }
     }
 
    ScopeSetter::ScopeSetter(size_t location) : location(location)
@@ -216,7 +232,15 @@ namespace Engine
        {
          throw FatalException("Write of local variable with bad location.");
        }
+      if (true == context.topScope()->frozen)
+       {
+         throw FatalException("Write of scope variable in a shared scope.");
+       }
       context.topScope()->vars[location] = value;
+      if (nullptr != context.memo)
+       {
+         context.memo->clear();
+       }
     }
 
  } // namespace Engine
@@ -42,11 +42,11 @@ namespace Engine
  {
 
    ConstantsSingleton::ConstantsSingleton() :
-      FLOAT_ZERO(std::make_shared<Types::FloatValue>(dm_double_fromdouble(0.0))),
-      FLOAT_ONE(std::make_shared<Types::FloatValue>(dm_double_fromdouble(1.0))),
+      FLOAT_ZERO(Types::FloatValue::make(dm_double_fromdouble(0.0))),
+      FLOAT_ONE(Types::FloatValue::make(dm_double_fromdouble(1.0))),
       EMPTY_ARRAY(std::make_shared<Types::ArrayValue>()),
       EMPTY_DICTIONARY(std::make_shared<Types::DictionaryValue>()),
-      ONE_TRUE_NOP(std::make_shared<NOP>(Input::Token())),
+      ONE_TRUE_NOP(std::make_shared<NOP>(Input::TokenHandle())),
       FLOAT_NAN(std::make_shared<Types::FloatValue>(dm_double_fromdouble(std::nan(""))))
     {
     }
@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Engine/StdLib.h"
 #include "Backwards/Engine/Statement.h"
 #include "Backwards/Types/FloatValue.h"
+#include "Backwards/Types/StringValue.h"
 #include "Backwards/Types/ArrayValue.h"
 #include "Backwards/Types/DictionaryValue.h"
 #include "Backwards/Engine/FatalException.h"
@@ -40,6 +41,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Engine/DebuggerHook.h"
 #include "Backwards/Engine/FunctionContext.h"
 #include "Backwards/Engine/StackFrame.h"
+#include "Backwards/Engine/Profiler.h"
+#include "Backwards/Engine/Sampler.h"
+#include "Backwards/Engine/Budget.h"
+#include "Backwards/Engine/MemoCache.h"
 
 #include <sstream>
 
@@ -49,7 +54,7 @@ namespace Backwards
 namespace Engine
  {
 
-   Expression::Expression(const Input::Token& token) : token(token)
+   Expression::Expression(const Input::TokenHandle& token) : token(token)
     {
     }
 
@@ -58,16 +63,16 @@ namespace Engine
       return constructMessage(e, token);
     }
 
-   std::string Expression::constructMessage(const Types::TypedOperationException& e, const Input::Token& token)
+   std::string Expression::constructMessage(const Types::TypedOperationException& e, const Input::TokenHandle& token)
     {
       std::stringstream str;
       str << e.what() << std::endl
-          << "\tFrom file " << token.sourceFile << " on line " << token.lineNumber << " at " << token.lineLocation;
+          << "\tFrom file " << token.sourceFile() << " on line " << token.lineNumber() << " at " << token.lineLocation();
       return str.str();
     }
 
 
-   Constant::Constant(const Input::Token& token, const std::shared_ptr<Types::ValueType>& value) : Expression(token), value(value)
+   Constant::Constant(const Input::TokenHandle& token, const std::shared_ptr<Types::ValueType>& value) : Expression(token), value(value)
     {
     }
 
@@ -77,7 +82,7 @@ namespace Engine
     }
 
 
-   Variable::Variable(const Input::Token& token, const std::shared_ptr<Getter>& getter) : Expression(token), getter(getter)
+   Variable::Variable(const Input::TokenHandle& token, const std::shared_ptr<Getter>& getter) : Expression(token), getter(getter)
     {
     }
 
@@ -87,8 +92,24 @@ namespace Engine
     }
 
 
-#define FullBinaryOperation(x,y) \
-   x::x(const Input::Token& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) : \
+   /*
+      The common cases of Float with Float and String with String skip the double dispatch:
+      the type tags are checked, and the final class's member is called directly.
+      Remember that the visitor flips the operands, so RHS is the object and LHS the argument.
+      These operations cannot throw, so they stay outside of the try.
+   */
+#define FastPath(y,z,w) \
+      if ((Types::z == LHS->getType()) && (Types::z == RHS->getType())) \
+       { \
+         result = static_cast<const Types::w&>(*RHS).Types::w::y(static_cast<const Types::w&>(*LHS)); \
+       } \
+      else
+
+#define FloatFastPath(y) FastPath(y,FLOAT,FloatValue)
+#define StringFastPath(y) FastPath(y,STRING,StringValue)
+
+#define FullBinaryOperation(x,y,z) \
+   x::x(const Input::TokenHandle& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) : \
       Expression(token), lhs(lhs), rhs(rhs) \
     { \
     } \
@@ -99,6 +120,8 @@ namespace Engine
       std::shared_ptr<Types::ValueType> LHS = lhs->evaluate(context); \
       std::shared_ptr<Types::ValueType> RHS = rhs->evaluate(context); \
       std::shared_ptr<Types::ValueType> result; \
+      FloatFastPath(y) \
+      z \
       try \
        { \
          result = LHS->y(*RHS); \
@@ -115,14 +138,14 @@ namespace Engine
       return result; \
     }
 
-   FullBinaryOperation(Plus, add)
-   FullBinaryOperation(Minus, sub)
-   FullBinaryOperation(Multiply, mul)
-   FullBinaryOperation(Divide, div)
+   FullBinaryOperation(Plus, add, StringFastPath(add))
+   FullBinaryOperation(Minus, sub, )
+   FullBinaryOperation(Multiply, mul, )
+   FullBinaryOperation(Divide, div, )
 
 
 #define FullBinaryOperationShort(x,y) \
-   x::x(const Input::Token& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) : \
+   x::x(const Input::TokenHandle& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) : \
       Expression(token), lhs(lhs), rhs(rhs) \
     { \
     } \
@@ -175,7 +198,7 @@ namespace Engine
 
 
 #define FullBinaryOperationRel(x,y) \
-   x::x(const Input::Token& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) : \
+   x::x(const Input::TokenHandle& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) : \
       Expression(token), lhs(lhs), rhs(rhs) \
     { \
     } \
@@ -186,6 +209,8 @@ namespace Engine
       std::shared_ptr<Types::ValueType> LHS = lhs->evaluate(context); \
       std::shared_ptr<Types::ValueType> RHS = rhs->evaluate(context); \
       bool result; \
+      FloatFastPath(y) \
+      StringFastPath(y) \
       try \
        { \
          result = LHS->y(*RHS); \
@@ -212,7 +237,7 @@ namespace Engine
    FullBinaryOperationRel(LEQ, leq)
 
 
-   DerefVar::DerefVar(const Input::Token& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) :
+   DerefVar::DerefVar(const Input::TokenHandle& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) :
       Expression(token), lhs(lhs), rhs(rhs)
     {
     }
@@ -252,7 +277,7 @@ namespace Engine
     }
 
 
-   Not::Not(const Input::Token& token, const std::shared_ptr<Expression>& arg) : Expression(token), arg(arg)
+   Not::Not(const Input::TokenHandle& token, const std::shared_ptr<Expression>& arg) : Expression(token), arg(arg)
     {
     }
 
@@ -281,7 +306,7 @@ namespace Engine
     }
 
 
-   Negate::Negate(const Input::Token& token, const std::shared_ptr<Expression>& arg) : Expression(token), arg(arg)
+   Negate::Negate(const Input::TokenHandle& token, const std::shared_ptr<Expression>& arg) : Expression(token), arg(arg)
     {
     }
 
@@ -308,7 +333,7 @@ namespace Engine
     }
 
 
-   StackFrame::StackFrame(std::shared_ptr<FunctionContext> function, const Input::Token& callingToken, StackFrame* prev) :
+   StackFrame::StackFrame(std::shared_ptr<FunctionContext> function, const Input::TokenHandle& callingToken, StackFrame* prev) :
       function(function), args(function->nargs), locals(function->nlocals), prev(prev), next(nullptr), callingToken(callingToken), depth(1U)
     {
       if (nullptr != prev)
@@ -318,100 +343,177 @@ namespace Engine
     }
 
 
-   FunctionCall::FunctionCall(const Input::Token& token, const std::shared_ptr<Expression>& location, const std::vector<std::shared_ptr<Expression> >& args) :
+   FunctionCall::FunctionCall(const Input::TokenHandle& token, const std::shared_ptr<Expression>& location, const std::vector<std::shared_ptr<Expression> >& args) :
       Expression(token), location(location), args(args)
     {
     }
 
-   std::shared_ptr<Types::ValueType> FunctionCall::evaluate (CallingContext& context) const
+   std::shared_ptr<FunctionContext> FunctionCall::getFunction (CallingContext& context, const std::shared_ptr<Types::ValueType>& LOC) const
     {
-      /* We don't want to catch an exception generated while evaluating the arguments, */
-      /* just the one from performing this operation. */
-      std::shared_ptr<Types::ValueType> LOC = location->evaluate(context);
       if (false == (typeid(Types::FunctionValue) == typeid(*LOC)))
        {
          std::stringstream str;
-         str << "Call to not a Function at " << token.lineLocation << " on line " << token.lineNumber << " in file " << token.sourceFile;
+         str << "Call to not a Function at " << token.lineLocation() << " on line " << token.lineNumber() << " in file " << token.sourceFile();
          if (nullptr != context.debugger)
           {
             context.debugger->EnterDebugger(str.str(), context);
           }
          throw FatalException(str.str());
        }
-      std::shared_ptr<FunctionContext> function = std::dynamic_pointer_cast<FunctionContext>((std::dynamic_pointer_cast<Types::FunctionValue>(LOC)->valueToo).lock());
-      if (nullptr == function.get())
-       {
-         function = std::dynamic_pointer_cast<FunctionContext>(std::dynamic_pointer_cast<Types::FunctionValue>(LOC)->value);
-       }
+      std::shared_ptr<FunctionContext> function = std::dynamic_pointer_cast<FunctionContext>(std::dynamic_pointer_cast<Types::FunctionValue>(LOC)->value);
       if (args.size() != function->nargs)
        {
          std::stringstream str;
          str << "Call to function with " << args.size() << " arguments, but function takes " << function->nargs <<
-            " arguments at " << token.lineLocation << " on line " << token.lineNumber << " in file " << token.sourceFile;
+            " arguments at " << token.lineLocation() << " on line " << token.lineNumber() << " in file " << token.sourceFile();
          if (nullptr != context.debugger)
           {
             context.debugger->EnterDebugger(str.str(), context);
           }
          throw FatalException(str.str());
        }
+      if (nullptr != function->deferred.get())
+       {
+         function->deferred->resolve(function, context);
+       }
+      return function;
+    }
+
+   std::shared_ptr<Types::ValueType> FunctionCall::evaluate (CallingContext& context) const
+    {
+      /* We don't want to catch an exception generated while evaluating the arguments, */
+      /* just the one from performing this operation. */
+      std::shared_ptr<Types::ValueType> LOC = location->evaluate(context);
+      std::shared_ptr<FunctionContext> function = getFunction(context, LOC);
       StackFrame frame (function, token, context.currentFrame);
       frame.captures = std::dynamic_pointer_cast<Types::FunctionValue>(LOC)->captures;
       for (size_t i = 0U; i < args.size(); ++i)
        {
          frame.args[i] = args[i]->evaluate(context);
        }
+      /* A pure function gives the same answer to the same arguments: don't ask it twice. */
+      /* An answer found costs the steps it took to work out, so a budget runs out the same either way. */
+      std::shared_ptr<FunctionContext> memoFunction;
+      std::vector<std::shared_ptr<Types::ValueType> > memoArgs;
+      Budget* memoBudget = context.budget;
+      size_t memoSteps = 0U;
+      if ((nullptr != context.memo) && (true == frame.captures.empty()) &&
+         (true == context.memo->remember(*frame.function, context)) && (true == MemoCache::keys(frame.args, context, memoArgs)))
+       {
+         std::shared_ptr<Types::ValueType> known = context.memo->get(frame.function.get(), context.roundMode, memoArgs, memoSteps);
+         if (nullptr != known.get())
+          {
+            if (nullptr != context.budget)
+             {
+               context.budget->charge(memoSteps);
+             }
+            return known;
+          }
+         memoFunction = frame.function;
+         memoSteps = (nullptr != memoBudget) ? memoBudget->steps() : 0U;
+       }
       /* Can't link the frames until here, as we may use the current frame to compute the args, */
       /* and/or push multiple other frames onto the stack. */
       context.pushContext(&frame);
+      if (nullptr != context.profiler)
+       {
+         context.profiler->enter(*function, context);
+       }
+      if (nullptr != context.sampler)
+       {
+         context.sampler->poll(context);
+       }
       try
        {
-         std::shared_ptr<FlowControl> result;
-         try
+         if (nullptr != context.budget)
           {
-            result = function->function->execute(context);
+            context.budget->depth(frame.depth);
           }
-         catch (const Types::TypedOperationException& e)
+
+          /* The call currently being made in this frame: either us, or a call in tail position. */
+         Input::TokenHandle callToken = token;
+         bool tailCalled = false;
+         std::shared_ptr<FlowControl> result;
+         for (;;)
           {
-            std::string msg = constructMessage(e);
-            throw Types::TypedOperationException(msg);
+            if (nullptr != context.budget)
+             {
+               context.budget->step();
+             }
+            try
+             {
+               result = frame.function->function->execute(context);
+             }
+            catch (const Types::TypedOperationException& e)
+             {
+               std::string msg = constructMessage(e, callToken);
+               if (true == tailCalled)
+                {
+                  msg = constructMessage(Types::TypedOperationException(msg));
+                }
+               throw Types::TypedOperationException(msg);
+             }
+            if (nullptr == result.get())
+             {
+               std::stringstream str;
+               str << "Function failed to return a value at " << callToken.lineLocation() << " on line " << callToken.lineNumber() << " in file " << callToken.sourceFile();
+               throw FatalException(str.str());
+             }
+            if (FlowControl::RETURN != result->type)
+             {
+               std::stringstream str;
+               str << "Function had a 'break' or 'continue' outside of a loop at " << callToken.lineLocation() << " on line " << callToken.lineNumber() << " in file " << callToken.sourceFile();
+               if (nullptr != context.debugger)
+                {
+                  context.debugger->EnterDebugger(str.str(), context);
+                }
+               throw FatalException(str.str());
+             }
+            if (nullptr == result->tailFunction.get())
+             {
+               break;
+             }
+             /* The function returned a call in tail position: make that call in this frame. */
+            callToken = result->source;
+            tailCalled = true;
+            frame.function = result->tailFunction;
+            frame.args = std::move(result->tailArgs);
+            frame.locals.assign(frame.function->nlocals, std::shared_ptr<Types::ValueType>());
+            frame.captures = std::dynamic_pointer_cast<Types::FunctionValue>(result->value)->captures;
+            if (nullptr != context.profiler)
+             {
+               context.profiler->leave();
+               context.profiler->enter(*frame.function, context);
+             }
           }
-         if (nullptr == result.get())
+         if (nullptr != context.profiler)
           {
-            std::stringstream str;
-            str << "Function failed to return a value at " << token.lineLocation << " on line " << token.lineNumber << " in file " << token.sourceFile;
-            throw FatalException(str.str());
+            context.profiler->leave();
           }
-         if (FlowControl::RETURN != result->type)
+         context.popContext();
+         if ((nullptr != memoFunction.get()) && (nullptr != context.memo))
           {
-            std::stringstream str;
-            str << "Function had a 'break' or 'continue' outside of a loop at " << token.lineLocation << " on line " << token.lineNumber << " in file " << token.sourceFile;
-            if (nullptr != context.debugger)
-             {
-               context.debugger->EnterDebugger(str.str(), context);
-             }
-            throw FatalException(str.str());
+            context.memo->put(memoFunction, context.roundMode, memoArgs, result->value, (nullptr != memoBudget) ? (memoBudget->steps() - memoSteps) : 0U);
           }
-         context.popContext();
          return result->value;
        }
       catch (...)
        {
+         if (nullptr != context.profiler)
+          {
+            context.profiler->leave();
+          }
          context.popContext();
          throw;
        }
     }
 
 
-   BuildFunction::BuildFunction(const Input::Token& token, const std::shared_ptr<FunctionContext>& prototype, const std::vector<std::shared_ptr<Expression> >& captures) :
+   BuildFunction::BuildFunction(const Input::TokenHandle& token, const std::shared_ptr<FunctionContext>& prototype, const std::vector<std::shared_ptr<Expression> >& captures) :
       Expression(token), prototype(prototype), captures(captures)
     {
     }
 
-   BuildFunction::BuildFunction(const Input::Token& token, const std::vector<std::shared_ptr<Expression> >& captures, const std::weak_ptr<FunctionContext>& prototype) :
-      Expression(token), prototypeToo(prototype), captures(captures)
-    {
-    }
-
    std::shared_ptr<Types::ValueType> BuildFunction::evaluate (CallingContext& context) const
     {
        /* This doesn't perform an operation that can fail. */
@@ -420,15 +522,11 @@ namespace Engine
        {
          captured.emplace_back((*iter)->evaluate(context));
        }
-      if (true == prototypeToo.expired())
-       {
-         return std::make_shared<Types::FunctionValue>(prototype, captured);
-       }
-      return std::make_shared<Types::FunctionValue>(captured, prototypeToo);
+      return std::make_shared<Types::FunctionValue>(prototype, captured);
     }
 
 
-   TernaryOperation::TernaryOperation(const Input::Token& token,
+   TernaryOperation::TernaryOperation(const Input::TokenHandle& token,
       const std::shared_ptr<Expression>& condition, const std::shared_ptr<Expression>& thenCase, const std::shared_ptr<Expression>& elseCase) :
       Expression(token), condition(condition), thenCase(thenCase), elseCase(elseCase)
     {
@@ -458,6 +556,22 @@ namespace Engine
          elseCase->evaluate(context);
     }
 
+
+   Invariant::Invariant(const Input::TokenHandle& token, const std::shared_ptr<Expression>& expr, size_t location) :
+      Expression(token), expr(expr), location(location)
+    {
+    }
+
+   std::shared_ptr<Types::ValueType> Invariant::evaluate (CallingContext& context) const
+    {
+      std::shared_ptr<Types::ValueType>& cache = context.currentFrame->locals[location];
+      if (nullptr == cache.get())
+       {
+         cache = expr->evaluate(context);
+       }
+      return cache;
+    }
+
  } // namespace Engine
 
  } // namespace Backwards
@@ -0,0 +1,309 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Engine/MemoCache.h"
+#include "Backwards/Engine/CellRefEval.h"
+#include "Backwards/Engine/CallingContext.h"
+#include "Backwards/Engine/FunctionContext.h"
+#include "Backwards/Engine/Scope.h"
+#include "Backwards/Engine/Statement.h"
+
+#include "Backwards/Types/FloatValue.h"
+#include "Backwards/Types/StringValue.h"
+#include "Backwards/Types/ArrayValue.h"
+#include "Backwards/Types/FunctionValue.h"
+#include "Backwards/Types/CellRefValue.h"
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+   const size_t MemoCache::CAPACITY = 4096U;
+
+    // The value itself when it can be compared as it is, null when it can't be remembered at all.
+   static std::shared_ptr<Types::ValueType> keyValue (const std::shared_ptr<Types::ValueType>& value, CallingContext& context)
+    {
+      switch (value->getType())
+       {
+      case Types::FLOAT:
+      case Types::STRING:
+      case Types::NIL:
+         return value;
+      case Types::ARRAY:
+       {
+         const std::vector<std::shared_ptr<Types::ValueType> >& elements = static_cast<const Types::ArrayValue&>(*value).value;
+         std::shared_ptr<Types::ArrayValue> result;
+         for (size_t i = 0U; i < elements.size(); ++i)
+          {
+            std::shared_ptr<Types::ValueType> element = keyValue(elements[i], context);
+            if (nullptr == element.get())
+             {
+               return element;
+             }
+            if ((nullptr == result.get()) && (element.get() != elements[i].get()))
+             {
+               result = std::make_shared<Types::ArrayValue>();
+               result->value.assign(elements.begin(), elements.begin() + i);
+             }
+            if (nullptr != result.get())
+             {
+               result->value.emplace_back(element);
+             }
+          }
+         if (nullptr == result.get())
+          {
+            return value;
+          }
+         return result;
+       }
+      case Types::CELL_REF:
+       {
+         const CellRefEval* ref = dynamic_cast<const CellRefEval*>(static_cast<const Types::CellRefValue&>(*value).value.get());
+         if (nullptr == ref)
+          {
+            return std::shared_ptr<Types::ValueType>();
+          }
+         return ref->key(context);
+       }
+      default:
+         return std::shared_ptr<Types::ValueType>();
+       }
+    }
+
+    // Stricter than equal: 0 and -0 round differently, and a NaN is the same NaN as itself.
+   static bool sameValue (const Types::ValueType& lhs, const Types::ValueType& rhs)
+    {
+      if (lhs.getType() != rhs.getType())
+       {
+         return false;
+       }
+      switch (lhs.getType())
+       {
+      case Types::FLOAT:
+         return static_cast<const Types::FloatValue&>(lhs).value == static_cast<const Types::FloatValue&>(rhs).value;
+      case Types::STRING:
+         return static_cast<const Types::StringValue&>(lhs).value == static_cast<const Types::StringValue&>(rhs).value;
+      case Types::ARRAY:
+       {
+         const std::vector<std::shared_ptr<Types::ValueType> >& LHS = static_cast<const Types::ArrayValue&>(lhs).value;
+         const std::vector<std::shared_ptr<Types::ValueType> >& RHS = static_cast<const Types::ArrayValue&>(rhs).value;
+         if (LHS.size() != RHS.size())
+          {
+            return false;
+          }
+         for (size_t i = 0U; i < LHS.size(); ++i)
+          {
+            if (false == sameValue(*LHS[i], *RHS[i]))
+             {
+               return false;
+             }
+          }
+         return true;
+       }
+      default:
+         return lhs.compare(rhs);
+       }
+    }
+
+   static size_t hashCall (const FunctionContext* function, int roundMode, const std::vector<std::shared_ptr<Types::ValueType> >& args)
+    {
+      size_t result = std::hash<const FunctionContext*>()(function);
+      Types::boost_hash_combine(result, std::hash<int>()(roundMode));
+      for (const std::shared_ptr<Types::ValueType>& arg : args)
+       {
+         Types::boost_hash_combine(result, arg->hash());
+       }
+      return result;
+    }
+
+   bool MemoCache::keys (const std::vector<std::shared_ptr<Types::ValueType> >& args, CallingContext& context, std::vector<std::shared_ptr<Types::ValueType> >& keys)
+    {
+      keys.clear();
+      for (const std::shared_ptr<Types::ValueType>& arg : args)
+       {
+         keys.emplace_back(keyValue(arg, context));
+         if (nullptr == keys.back().get())
+          {
+            keys.clear();
+            return false;
+          }
+       }
+      return true;
+    }
+
+   static bool isLibrary (const FunctionContext& function)
+    {
+      const Statement& body = *function.function;
+      return (typeid(StandardConstantFunction) == typeid(body)) || (typeid(StandardConstantFunctionWithContext) == typeid(body)) ||
+         (typeid(StandardUnaryFunction) == typeid(body)) || (typeid(StandardUnaryFunctionWithContext) == typeid(body)) ||
+         (typeid(StandardBinaryFunction) == typeid(body)) || (typeid(StandardTernaryFunction) == typeid(body));
+    }
+
+   bool MemoCache::remember (const FunctionContext& function, CallingContext& context)
+    {
+      std::map<const FunctionContext*, bool>::const_iterator found = verdicts.find(&function);
+      if (verdicts.end() != found)
+       {
+         return found->second;
+       }
+      std::set<const FunctionContext*> checking;
+      bool result = (false == isLibrary(function)) && (true == pure(function, context, checking));
+      verdicts[&function] = result;
+      return result;
+    }
+
+    /*
+      A function that is being checked is taken to be pure while we check what it calls,
+      so that recursion ends. That makes the answer for any function but the first only
+      an assumption, so only the impure ones are remembered.
+    */
+   bool MemoCache::pure (const FunctionContext& function, CallingContext& context, std::set<const FunctionContext*>& checking)
+    {
+      if (false == function.pure)
+       {
+         return false;
+       }
+      if (checking.end() != checking.find(&function))
+       {
+         return true;
+       }
+      std::map<const FunctionContext*, bool>::const_iterator found = verdicts.find(&function);
+      if (verdicts.end() != found)
+       {
+         return found->second;
+       }
+      checking.insert(&function);
+      for (size_t global : function.calls)
+       {
+         if (global >= context.globalScope->vars.size())
+          {
+            verdicts.emplace(std::make_pair(&function, false));
+            return false;
+          }
+         const std::shared_ptr<Types::ValueType>& callee = context.globalScope->vars[global];
+         if ((nullptr == callee.get()) || (Types::FUNCTION != callee->getType()) ||
+            (false == static_cast<const Types::FunctionValue&>(*callee).captures.empty()) ||
+            (false == pure(static_cast<const FunctionContext&>(*static_cast<const Types::FunctionValue&>(*callee).value), context, checking)))
+          {
+            verdicts.emplace(std::make_pair(&function, false));
+            return false;
+          }
+       }
+      return true;
+    }
+
+   std::unordered_multimap<size_t, std::list<MemoCache::Entry>::iterator>::iterator MemoCache::find
+      (const FunctionContext* function, int roundMode, const std::vector<std::shared_ptr<Types::ValueType> >& args, size_t hash)
+    {
+      std::pair<std::unordered_multimap<size_t, std::list<Entry>::iterator>::iterator, std::unordered_multimap<size_t, std::list<Entry>::iterator>::iterator>
+         range = index.equal_range(hash);
+      for (; range.first != range.second; ++range.first)
+       {
+         const Entry& entry = *range.first->second;
+         if ((function == entry.function.get()) && (roundMode == entry.roundMode) && (args.size() == entry.args.size()))
+          {
+            bool same = true;
+            for (size_t i = 0U; (true == same) && (i < args.size()); ++i)
+             {
+               same = sameValue(*args[i], *entry.args[i]);
+             }
+            if (true == same)
+             {
+               return range.first;
+             }
+          }
+       }
+      return index.end();
+    }
+
+   std::shared_ptr<Types::ValueType> MemoCache::get (const FunctionContext* function, int roundMode, const std::vector<std::shared_ptr<Types::ValueType> >& args, size_t& steps)
+    {
+      std::unordered_multimap<size_t, std::list<Entry>::iterator>::iterator found = find(function, roundMode, args, hashCall(function, roundMode, args));
+      if (index.end() == found)
+       {
+         return std::shared_ptr<Types::ValueType>();
+       }
+      entries.splice(entries.begin(), entries, found->second);
+      steps = found->second->steps;
+      return found->second->result;
+    }
+
+   void MemoCache::put (const std::shared_ptr<FunctionContext>& function, int roundMode, const std::vector<std::shared_ptr<Types::ValueType> >& args,
+      const std::shared_ptr<Types::ValueType>& result, size_t steps)
+    {
+      size_t hash = hashCall(function.get(), roundMode, args);
+      std::unordered_multimap<size_t, std::list<Entry>::iterator>::iterator found = find(function.get(), roundMode, args, hash);
+      if (index.end() != found)
+       {
+         entries.erase(found->second);
+         index.erase(found);
+       }
+      entries.emplace_front();
+      entries.front().function = function;
+      entries.front().roundMode = roundMode;
+      entries.front().args = args;
+      entries.front().hash = hash;
+      entries.front().result = result;
+      entries.front().steps = steps;
+      index.emplace(std::make_pair(hash, entries.begin()));
+      if (entries.size() > CAPACITY)
+       {
+         std::pair<std::unordered_multimap<size_t, std::list<Entry>::iterator>::iterator, std::unordered_multimap<size_t, std::list<Entry>::iterator>::iterator>
+            range = index.equal_range(entries.back().hash);
+         for (; range.first != range.second; ++range.first)
+          {
+            if (&*range.first->second == &entries.back())
+             {
+               index.erase(range.first);
+               break;
+             }
+          }
+         entries.pop_back();
+       }
+    }
+
+   void MemoCache::clear()
+    {
+      entries.clear();
+      index.clear();
+      verdicts.clear();
+    }
+
+   size_t MemoCache::size() const
+    {
+      return entries.size();
+    }
+
+ } // namespace Engine
+
+ } // namespace Backwards
@@ -0,0 +1,172 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Engine/Profiler.h"
+
+#include "Backwards/Engine/FunctionContext.h"
+
+#include "Backwards/Types/ValueType.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+   Profiler::Record::Record() : calls(0U), inclusive(0), exclusive(0), allocations(0U), active(0U)
+    {
+    }
+
+    // Values are only counted while there is a profiler to read the count.
+   Profiler::Profiler()
+    {
+      ++Types::ValueType::counting;
+    }
+
+   Profiler::~Profiler()
+    {
+      --Types::ValueType::counting;
+    }
+
+   std::string Profiler::functionName (const FunctionContext& function)
+    {
+      if (true == function.name.empty())
+       {
+         return "(anonymous)";
+       }
+      return function.name;
+    }
+
+   std::string Profiler::site (CallingContext&) const
+    {
+      return "";
+    }
+
+   void Profiler::enter (const FunctionContext& function, CallingContext& context)
+    {
+      const std::string name = functionName(function);
+
+      Active frame;
+      frame.function = &functions[name];
+      frame.site = &sites[site(context)][name];
+      frame.start = std::chrono::steady_clock::now();
+      frame.children = std::chrono::steady_clock::duration(0);
+      frame.created = Types::ValueType::created;
+
+      ++frame.function->calls;
+      ++frame.function->active;
+      ++frame.site->calls;
+      ++frame.site->active;
+      stack.push_back(frame);
+    }
+
+   static void account (Profiler::Record& record, std::chrono::steady_clock::duration inclusive, std::chrono::steady_clock::duration exclusive, size_t allocations)
+    {
+      --record.active;
+      if (0U == record.active)
+       {
+         record.inclusive += inclusive;
+         record.allocations += allocations;
+       }
+      record.exclusive += exclusive;
+    }
+
+   void Profiler::leave ()
+    {
+      if (true == stack.empty()) // We were cleared during the call.
+       {
+         return;
+       }
+
+      const Active& frame = stack.back();
+      const std::chrono::steady_clock::duration inclusive = std::chrono::steady_clock::now() - frame.start;
+      const size_t allocations = Types::ValueType::created - frame.created;
+
+      account(*frame.function, inclusive, inclusive - frame.children, allocations);
+      account(*frame.site, inclusive, inclusive - frame.children, allocations);
+
+      stack.pop_back();
+      if (false == stack.empty())
+       {
+         stack.back().children += inclusive;
+       }
+    }
+
+   void Profiler::clear ()
+    {
+      stack.clear();
+      functions.clear();
+      sites.clear();
+    }
+
+   static void printTable (std::ostream& out, const std::string& indent, const std::map<std::string, Profiler::Record>& records)
+    {
+      std::vector<std::pair<std::string, const Profiler::Record*> > sorted;
+      for (const std::pair<const std::string, Profiler::Record>& record : records)
+       {
+         sorted.emplace_back(std::make_pair(record.first, &record.second));
+       }
+      std::stable_sort(sorted.begin(), sorted.end(),
+         [](const std::pair<std::string, const Profiler::Record*>& lhs, const std::pair<std::string, const Profiler::Record*>& rhs)
+            { return lhs.second->exclusive > rhs.second->exclusive; });
+
+      for (const std::pair<std::string, const Profiler::Record*>& record : sorted)
+       {
+         out << indent << std::left << std::setw(24) << record.first << std::right <<
+            std::setw(10) << record.second->calls <<
+            std::setw(14) << std::chrono::duration_cast<std::chrono::microseconds>(record.second->inclusive).count() <<
+            std::setw(14) << std::chrono::duration_cast<std::chrono::microseconds>(record.second->exclusive).count() <<
+            std::setw(12) << record.second->allocations << std::endl;
+       }
+    }
+
+   void Profiler::report (std::ostream& out) const
+    {
+      out << std::left << std::setw(24) << "Function" << std::right << std::setw(10) << "Calls" <<
+         std::setw(14) << "Incl (us)" << std::setw(14) << "Excl (us)" << std::setw(12) << "Values" << std::endl;
+      printTable(out, "", functions);
+
+      for (const std::pair<const std::string, std::map<std::string, Record> >& site : sites)
+       {
+         if (false == site.first.empty())
+          {
+            out << std::endl << site.first << ":" << std::endl;
+            printTable(out, "   ", site.second);
+          }
+       }
+    }
+
+ } // namespace Engine
+
+ } // namespace Backwards
@@ -0,0 +1,190 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Engine/RoundingMode.h"
+
+#include "dm_double.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+namespace
+ {
+
+   class Gate final
+    {
+   private:
+      std::mutex lock;
+      std::condition_variable changed;
+      int installed;
+      size_t holders;
+      bool sweeping;
+
+   public:
+      Gate() : installed(0), holders(0U), sweeping(false) { }
+
+      void enter (int mode)
+       {
+         std::unique_lock<std::mutex> guard (lock);
+         changed.wait(guard, [this, mode]() { return (false == sweeping) && ((0U == holders) || (installed == mode)); });
+         if (0U == holders)
+          {
+             // Always set it: code outside of any hold may have set the library's mode itself.
+            (void) dm_fesetround(mode);
+            installed = mode;
+          }
+         ++holders;
+       }
+
+      void leave (void)
+       {
+         std::lock_guard<std::mutex> guard (lock);
+         if (0U == --holders)
+          {
+            changed.notify_all();
+          }
+       }
+
+      void beginSweep (void)
+       {
+         std::unique_lock<std::mutex> guard (lock);
+         changed.wait(guard, [this]() { return (false == sweeping) && (0U == holders); });
+         sweeping = true;
+       }
+
+      void endSweep (void)
+       {
+         std::lock_guard<std::mutex> guard (lock);
+         sweeping = false;
+         changed.notify_all();
+       }
+
+       // Never destroyed: a thread may still be finishing up when static objects go away.
+      static Gate& getInstance (void)
+       {
+         static Gate* gate = new Gate();
+         return *gate;
+       }
+    };
+
+   thread_local bool holding = false;
+   thread_local int held = 0;
+
+ } // namespace
+
+   RoundingMode::Hold::Hold(int mode) : wasHolding(holding), previous(held)
+    {
+      if ((true == holding) && (held == mode))
+       {
+         return;
+       }
+      if (true == holding)
+       {
+         Gate::getInstance().leave();
+         holding = false;
+       }
+      Gate::getInstance().enter(mode);
+      holding = true;
+      held = mode;
+    }
+
+   RoundingMode::Hold::~Hold()
+    {
+      if ((wasHolding == holding) && ((false == holding) || (previous == held)))
+       {
+         return;
+       }
+      if (true == holding)
+       {
+         Gate::getInstance().leave();
+         holding = false;
+       }
+      if (true == wasHolding)
+       {
+         Gate::getInstance().enter(previous);
+         holding = true;
+         held = previous;
+       }
+    }
+
+   RoundingMode::Sweep::Sweep() : wasHolding(holding), previous(held)
+    {
+      if (true == holding)
+       {
+         Gate::getInstance().leave();
+         holding = false;
+       }
+      Gate::getInstance().beginSweep();
+    }
+
+   RoundingMode::Sweep::~Sweep()
+    {
+      Gate::getInstance().endSweep();
+      if (true == wasHolding)
+       {
+         Gate::getInstance().enter(previous);
+         holding = true;
+         held = previous;
+       }
+    }
+
+   void RoundingMode::change (int mode)
+    {
+      if (false == holding)
+       {
+         Gate::getInstance().enter(mode);
+         Gate::getInstance().leave();
+       }
+      else if (held != mode)
+       {
+         Gate::getInstance().leave();
+         holding = false;
+         Gate::getInstance().enter(mode);
+         holding = true;
+         held = mode;
+       }
+    }
+
+   bool RoundingMode::evaluating (void)
+    {
+      return holding;
+    }
+
+ } // namespace Engine
+
+ } // namespace Backwards
@@ -0,0 +1,125 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Engine/Sampler.h"
+
+#include "Backwards/Engine/FunctionContext.h"
+#include "Backwards/Engine/Profiler.h"
+#include "Backwards/Engine/StackFrame.h"
+
+#include <algorithm>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+   const size_t Sampler::POLLS_PER_CHECK;
+
+   Sampler::Sampler(std::chrono::steady_clock::duration interval) :
+      interval(interval), next(std::chrono::steady_clock::now() + interval), countdown(POLLS_PER_CHECK)
+    {
+    }
+
+   void Sampler::clear ()
+    {
+      stacks.clear();
+    }
+
+   void Sampler::report (std::ostream& out) const
+    {
+      for (const std::pair<const std::string, size_t>& stack : stacks)
+       {
+         out << stack.first << " " << stack.second << std::endl;
+       }
+    }
+
+   void Sampler::outer (CallingContext&, std::vector<std::string>&) const
+    {
+    }
+
+   void Sampler::check (CallingContext& context)
+    {
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      if (now >= next)
+       {
+          // One sample for every interval that has passed, so a stack that polls seldom isn't undercounted.
+         size_t weight = 1U;
+         if (interval > std::chrono::steady_clock::duration(0))
+          {
+            weight += static_cast<size_t>((now - next) / interval);
+            next += interval * weight;
+          }
+         else
+          {
+            next = now;
+          }
+         sample(context, weight);
+       }
+    }
+
+   void Sampler::sample (CallingContext& context, size_t weight)
+    {
+      std::vector<std::string> frames;
+      outer(context, frames);
+
+      const size_t base = frames.size();
+      for (StackFrame* frame = context.currentFrame; nullptr != frame; frame = frame->prev)
+       {
+         std::string name = Profiler::functionName(*frame->function);
+         if (false == frame->callingToken.sourceFile().empty())
+          {
+            name += " [" + frame->callingToken.sourceFile() + ":" + std::to_string(frame->callingToken.lineNumber()) + "]";
+          }
+         frames.emplace_back(name);
+       }
+      std::reverse(frames.begin() + base, frames.end());
+
+      std::string folded;
+      for (const std::string& frame : frames)
+       {
+         if (false == folded.empty())
+          {
+            folded += ";";
+          }
+         folded += frame;
+       }
+      if (true == folded.empty())
+       {
+         folded = "(top level)";
+       }
+      stacks[folded] += weight;
+    }
+
+ } // namespace Engine
+
+ } // namespace Backwards
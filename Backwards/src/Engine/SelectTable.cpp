@@ -0,0 +1,227 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Engine/SelectTable.h"
+
+#include "Backwards/Engine/Expression.h"
+#include "Backwards/Engine/Statement.h"
+
+#include "Backwards/Types/StringValue.h"
+
+#include <algorithm>
+
+namespace Backwards
+ {
+
+namespace Engine
+ {
+
+   const size_t SelectTable::MINIMUM = 4U;
+
+   static const Types::ValueType* constantValue (const std::shared_ptr<Expression>& expr)
+    {
+      if ((nullptr != expr.get()) && (typeid(Constant) == typeid(*expr)))
+       {
+         return static_cast<const Constant&>(*expr).value.get();
+       }
+      return nullptr;
+    }
+
+   static bool pointLess (const std::shared_ptr<Types::ValueType>& point, const Types::ValueType& value)
+    {
+      return point->less(value);
+    }
+
+   static size_t indexOf (const std::vector<std::shared_ptr<Types::ValueType> >& points, const Types::ValueType& value)
+    {
+      return std::lower_bound(points.begin(), points.end(), value, pointLess) - points.begin();
+    }
+
+   std::shared_ptr<SelectTable> SelectTable::build (const std::vector<std::shared_ptr<CaseContainer> >& cases)
+    {
+      std::shared_ptr<SelectTable> result = std::make_shared<SelectTable>();
+      result->covered = 0U;
+
+       // Take cases while they are constants of one type that can be ordered. A case else matches anything, so it ends the table.
+      size_t constants = 0U;
+      bool equality = true;
+      for (const std::shared_ptr<CaseContainer>& arm : cases)
+       {
+         if (nullptr == arm->condition.get())
+          {
+            ++result->covered;
+            break;
+          }
+         const Types::ValueType* top = constantValue(arm->condition);
+         const Types::ValueType* bottom = (nullptr != arm->lower.get()) ? constantValue(arm->lower) : top;
+         if ((nullptr == top) || (nullptr == bottom) || (top->getType() != bottom->getType()) ||
+            ((Types::FLOAT != top->getType()) && (Types::STRING != top->getType())))
+          {
+            break;
+          }
+         if (0U == constants)
+          {
+            result->type = top->getType();
+          }
+         else if (result->type != top->getType())
+          {
+            break;
+          }
+         if ((false == top->equal(*top)) || (false == bottom->equal(*bottom)))
+          {
+            break;
+          }
+         equality &= (CaseContainer::AT == arm->type) && (nullptr == arm->lower.get());
+         ++constants;
+         ++result->covered;
+       }
+      if (constants < MINIMUM)
+       {
+         return std::shared_ptr<SelectTable>();
+       }
+
+      result->otherwise = result->covered;
+      if ((Types::STRING == result->type) && (true == equality))
+       {
+         for (size_t arm = 0U; arm < result->covered; ++arm)
+          {
+            if (nullptr == cases[arm]->condition.get())
+             {
+               result->otherwise = arm;
+             }
+            else
+             {
+               result->strings.emplace(static_cast<const Types::StringValue&>(*constantValue(cases[arm]->condition)).value, arm);
+             }
+          }
+         return result;
+       }
+
+      std::vector<std::shared_ptr<Types::ValueType> >& points = result->points;
+      for (size_t arm = 0U; arm < result->covered; ++arm)
+       {
+         if (nullptr != cases[arm]->condition.get())
+          {
+            points.emplace_back(static_cast<const Constant&>(*cases[arm]->condition).value);
+            if (nullptr != cases[arm]->lower.get())
+             {
+               points.emplace_back(static_cast<const Constant&>(*cases[arm]->lower).value);
+             }
+          }
+       }
+      std::sort(points.begin(), points.end(), [](const std::shared_ptr<Types::ValueType>& lhs, const std::shared_ptr<Types::ValueType>& rhs) { return lhs->less(*rhs); });
+      points.erase(std::unique(points.begin(), points.end(), [](const std::shared_ptr<Types::ValueType>& lhs, const std::shared_ptr<Types::ValueType>& rhs) { return lhs->equal(*rhs); }), points.end());
+
+       /*
+         Work out which case wins at each point and in each gap, going backwards so that earlier cases win.
+         Every case value is a point, so a case's comparisons come down to comparing positions:
+         gap g holds the values above points[g - 1] and below points[g].
+       */
+      const size_t n = points.size();
+      result->atPoint.assign(n, result->covered);
+      result->between.assign(n + 1U, result->covered);
+      for (size_t arm = result->covered; arm-- > 0U; )
+       {
+         const CaseContainer& container = *cases[arm];
+         if (nullptr == container.condition.get())
+          {
+            std::fill(result->atPoint.begin(), result->atPoint.end(), arm);
+            std::fill(result->between.begin(), result->between.end(), arm);
+            continue;
+          }
+         const size_t top = indexOf(points, *constantValue(container.condition));
+         if (nullptr != container.lower.get()) // Matches from lower up to condition.
+          {
+            const size_t bottom = indexOf(points, *constantValue(container.lower));
+            for (size_t k = bottom; k <= top; ++k)
+             {
+               result->atPoint[k] = arm;
+               if (k > bottom)
+                {
+                  result->between[k] = arm;
+                }
+             }
+          }
+         else
+          {
+            switch (container.type)
+             {
+            case CaseContainer::AT:
+               result->atPoint[top] = arm;
+               break;
+            case CaseContainer::ABOVE:
+               for (size_t k = top; k < n; ++k)
+                {
+                  result->atPoint[k] = arm;
+                  result->between[k + 1U] = arm;
+                }
+               break;
+            case CaseContainer::BELOW:
+               for (size_t k = 0U; k <= top; ++k)
+                {
+                  result->atPoint[k] = arm;
+                  result->between[k] = arm;
+                }
+               break;
+             }
+          }
+       }
+      return result;
+    }
+
+   bool SelectTable::find (const Types::ValueType& control, size_t& arm) const
+    {
+      if (type != control.getType())
+       {
+         arm = 0U;
+         return false;
+       }
+      if (true == points.empty())
+       {
+         std::unordered_map<std::string, size_t>::const_iterator found = strings.find(static_cast<const Types::StringValue&>(control).value);
+         arm = (strings.end() != found) ? found->second : otherwise;
+       }
+      else
+       {
+         if (false == control.equal(control))
+          {
+            arm = 0U;
+            return false;
+          }
+         const size_t k = indexOf(points, control);
+         arm = ((k < points.size()) && (true == points[k]->equal(control))) ? atPoint[k] : between[k];
+       }
+      return covered != arm;
+    }
+
+ } // namespace Engine
+
+ } // namespace Backwards
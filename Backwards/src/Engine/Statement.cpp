@@ -33,6 +33,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Engine/Expression.h"
 #include "Backwards/Engine/StdLib.h"
 #include "Backwards/Engine/StackFrame.h"
+#include "Backwards/Engine/Sampler.h"
+#include "Backwards/Engine/Budget.h"
+#include "Backwards/Engine/SelectTable.h"
 
 #include "Backwards/Types/ArrayValue.h"
 #include "Backwards/Types/DictionaryValue.h"
@@ -48,18 +51,24 @@ namespace Backwards
 namespace Engine
  {
 
-   FlowControl::FlowControl(const Input::Token& source, Type type, size_t target, const std::shared_ptr<Types::ValueType>& value) : source(source), type(type), target(target), value(value)
+   FlowControl::FlowControl(const Input::TokenHandle& source, Type type, size_t target, const std::shared_ptr<Types::ValueType>& value) : source(source), type(type), target(target), value(value)
+    {
+    }
+
+   FlowControl::FlowControl(const Input::TokenHandle& source, const std::shared_ptr<Types::ValueType>& value, const std::shared_ptr<FunctionContext>& tailFunction,
+      std::vector<std::shared_ptr<Types::ValueType> >&& tailArgs) :
+      source(source), type(RETURN), target(NO_TARGET), value(value), tailFunction(tailFunction), tailArgs(std::move(tailArgs))
     {
     }
 
    const size_t FlowControl::NO_TARGET = 0U;
 
-   Statement::Statement(const Input::Token& token) : token(token)
+   Statement::Statement(const Input::TokenHandle& token) : token(token)
     {
     }
 
 
-   NOP::NOP(const Input::Token& token) : Statement(token)
+   NOP::NOP(const Input::TokenHandle& token) : Statement(token)
     {
     }
 
@@ -69,7 +78,7 @@ namespace Engine
     }
 
 
-   Expr::Expr(const Input::Token& token, const std::shared_ptr<Expression>& expr) : Statement(token), expr(expr)
+   Expr::Expr(const Input::TokenHandle& token, const std::shared_ptr<Expression>& expr) : Statement(token), expr(expr)
     {
     }
 
@@ -80,7 +89,7 @@ namespace Engine
     }
 
 
-   StatementSeq::StatementSeq(const Input::Token& token, const std::vector<std::shared_ptr<Statement> >& statements) :
+   StatementSeq::StatementSeq(const Input::TokenHandle& token, const std::vector<std::shared_ptr<Statement> >& statements) :
       Statement(token), statements(statements)
     {
     }
@@ -100,7 +109,7 @@ namespace Engine
     }
 
 
-   RecAssignState::RecAssignState(const Input::Token& token, const std::shared_ptr<Expression>& index) :
+   RecAssignState::RecAssignState(const Input::TokenHandle& token, const std::shared_ptr<Expression>& index) :
       token(token), index(index)
     {
     }
@@ -186,7 +195,7 @@ namespace Engine
     }
 
 
-   Assignment::Assignment(const Input::Token& token, const std::shared_ptr<Getter>& getter, const std::shared_ptr<Setter>& setter,
+   Assignment::Assignment(const Input::TokenHandle& token, const std::shared_ptr<Getter>& getter, const std::shared_ptr<Setter>& setter,
       const std::shared_ptr<RecAssignState>& index, const std::shared_ptr<Expression>& rhs) :
       Statement(token), getter(getter), setter(setter), index(index), rhs(rhs)
     {
@@ -206,7 +215,7 @@ namespace Engine
     }
 
 
-   IfStatement::IfStatement(const Input::Token& token, const std::shared_ptr<Expression>& condition,
+   IfStatement::IfStatement(const Input::TokenHandle& token, const std::shared_ptr<Expression>& condition,
       const std::shared_ptr<Statement>& thenSeq, const std::shared_ptr<Statement>& elseSeq) :
       Statement(token), condition(condition), thenSeq(thenSeq), elseSeq(elseSeq)
     {
@@ -239,7 +248,7 @@ namespace Engine
     }
 
 
-   WhileStatement::WhileStatement(const Input::Token& token, const std::shared_ptr<Expression>& condition, const std::shared_ptr<Statement>& seq, size_t id) :
+   WhileStatement::WhileStatement(const Input::TokenHandle& token, const std::shared_ptr<Expression>& condition, const std::shared_ptr<Statement>& seq, size_t id) :
       Statement(token), condition(condition), seq(seq), id(id)
     {
     }
@@ -262,6 +271,14 @@ namespace Engine
        }
       while (true == conditional)
        {
+         if (nullptr != context.sampler)
+          {
+            context.sampler->poll(context);
+          }
+         if (nullptr != context.budget)
+          {
+            context.budget->step();
+          }
          std::shared_ptr<FlowControl> temp = seq->execute(context);
 
          if (nullptr != temp.get())
@@ -306,7 +323,7 @@ namespace Engine
     }
 
 
-   CaseContainer::CaseContainer(const Input::Token& token, bool breaking, CaseType type, const std::shared_ptr<Expression>& condition, const std::shared_ptr<Expression>& lower, const std::shared_ptr<Statement>& seq) :
+   CaseContainer::CaseContainer(const Input::TokenHandle& token, bool breaking, CaseType type, const std::shared_ptr<Expression>& condition, const std::shared_ptr<Expression>& lower, const std::shared_ptr<Statement>& seq) :
       token(token), breaking(breaking), type(type), condition(condition), lower(lower), seq(seq)
     {
     }
@@ -354,7 +371,7 @@ namespace Engine
       return result;
     }
 
-   SelectStatement::SelectStatement(const Input::Token& token, const std::shared_ptr<Expression>& control, const std::vector<std::shared_ptr<CaseContainer> >& cases) :
+   SelectStatement::SelectStatement(const Input::TokenHandle& token, const std::shared_ptr<Expression>& control, const std::vector<std::shared_ptr<CaseContainer> >& cases) :
       Statement(token), control(control), cases(cases)
     {
     }
@@ -363,30 +380,33 @@ namespace Engine
     {
       std::shared_ptr<Types::ValueType> controlVal = control->evaluate(context);
 
-      bool end = false;
-      for (std::vector<std::shared_ptr<CaseContainer> >::const_iterator iter = cases.begin();
-         (false == end) && (cases.end() != iter); ++iter)
+      size_t arm = 0U;
+      if ((nullptr == table.get()) || (false == table->find(*controlVal, arm)))
        {
-         if (true == (*iter)->evaluate(context, controlVal))
+         while ((cases.size() != arm) && (false == cases[arm]->evaluate(context, controlVal)))
           {
-            do
+            ++arm;
+          }
+       }
+
+      if (cases.size() != arm)
+       {
+         do
+          {
+            std::shared_ptr<FlowControl> temp = cases[arm]->seq->execute(context);
+            if (nullptr != temp.get())
              {
-               std::shared_ptr<FlowControl> temp = (*iter)->seq->execute(context);
-               if (nullptr != temp.get())
-                {
-                  return temp;
-                }
-               ++iter;
+               return temp;
              }
-            while ((cases.end() != iter) && (false == (*iter)->breaking));
-            end = true;
+            ++arm;
           }
+         while ((cases.size() != arm) && (false == cases[arm]->breaking));
        }
       return std::shared_ptr<FlowControl>();
     }
 
 
-   ForStatement::ForStatement(const Input::Token& token, const std::shared_ptr<Getter>& getter, const std::shared_ptr<Setter>& setter,
+   ForStatement::ForStatement(const Input::TokenHandle& token, const std::shared_ptr<Getter>& getter, const std::shared_ptr<Setter>& setter,
          const std::shared_ptr<Expression>& lower, bool to, const std::shared_ptr<Expression>& upper,
          const std::shared_ptr<Expression>& step, const std::shared_ptr<Statement>& seq, size_t id) :
       Statement(token), getter(getter), setter(setter), lower(lower), to(to), upper(upper), step(step), seq(seq), id(id)
@@ -419,35 +439,23 @@ namespace Engine
           }
          else
           {
-            STEP = std::make_shared<Types::FloatValue>(dm_double_fromdouble(-1.0));
+            STEP = Types::FloatValue::make(dm_double_fromdouble(-1.0));
           }
        }
       else
        {
          STEP = step->evaluate(context);
        }
-      std::shared_ptr<Expression> del = std::make_shared<Constant>(token, STEP);
 
       while (true)
        {
          setter->set(context, currentValue);
 
-         std::shared_ptr<Expression> lcv = std::make_shared<Constant>(token, currentValue);
-         std::shared_ptr<Expression> limit = std::make_shared<Constant>(token, UPPER);
-         std::shared_ptr<Expression> comparator;
-         if (true == to)
-          {
-            comparator = std::make_shared<LEQ>(token, lcv, limit);
-          }
-         else
-          {
-            comparator = std::make_shared<GEQ>(token, lcv, limit);
-          }
-
+          // Compare and step the values directly: building expressions to do it costs allocations every iteration.
          bool conditional = false;
          try
           {
-            conditional = comparator->evaluate(context)->logical();
+            conditional = (true == to) ? currentValue->leq(*UPPER) : currentValue->geq(*UPPER);
           }
          catch (const Types::TypedOperationException& e)
           {
@@ -464,6 +472,14 @@ namespace Engine
             break;
           }
 
+         if (nullptr != context.sampler)
+          {
+            context.sampler->poll(context);
+          }
+         if (nullptr != context.budget)
+          {
+            context.budget->step();
+          }
          std::shared_ptr<FlowControl> temp = seq->execute(context);
 
          if (nullptr != temp.get())
@@ -490,8 +506,19 @@ namespace Engine
              }
           }
 
-         Plus plus (token, lcv, del);
-         currentValue = plus.evaluate(context);
+         try
+          {
+            currentValue = currentValue->add(*STEP);
+          }
+         catch (const Types::TypedOperationException& e)
+          {
+            std::string msg = Expression::constructMessage(e, token);
+            if (nullptr != context.debugger)
+             {
+               context.debugger->EnterDebugger(msg, context);
+             }
+            throw Types::TypedOperationException(msg);
+          }
        }
       return std::shared_ptr<FlowControl>();
     }
@@ -502,6 +529,14 @@ namespace Engine
        {
          setter->set(context, iter);
 
+         if (nullptr != context.sampler)
+          {
+            context.sampler->poll(context);
+          }
+         if (nullptr != context.budget)
+          {
+            context.budget->step();
+          }
          std::shared_ptr<FlowControl> temp = seq->execute(context);
 
          if (nullptr != temp.get())
@@ -540,6 +575,14 @@ namespace Engine
          currIter->value.push_back(iter.second);
          setter->set(context, currIter);
 
+         if (nullptr != context.sampler)
+          {
+            context.sampler->poll(context);
+          }
+         if (nullptr != context.budget)
+          {
+            context.budget->step();
+          }
          std::shared_ptr<FlowControl> temp = seq->execute(context);
 
          if (nullptr != temp.get())
@@ -592,7 +635,22 @@ namespace Engine
     }
 
 
-   FlowControlStatement::FlowControlStatement(const Input::Token& token, FlowControl::Type type, size_t target, const std::shared_ptr<Expression>& value) :
+   InvariantLoop::InvariantLoop(const Input::TokenHandle& token, const std::vector<size_t>& locations, const std::shared_ptr<Statement>& loop) :
+      Statement(token), locations(locations), loop(loop)
+    {
+    }
+
+   std::shared_ptr<FlowControl> InvariantLoop::execute (CallingContext& context) const
+    {
+      for (size_t location : locations)
+       {
+         context.currentFrame->locals[location].reset();
+       }
+      return loop->execute(context);
+    }
+
+
+   FlowControlStatement::FlowControlStatement(const Input::TokenHandle& token, FlowControl::Type type, size_t target, const std::shared_ptr<Expression>& value) :
       Statement(token), type(type), target(target), value(value)
     {
     }
@@ -620,7 +678,37 @@ namespace Engine
     }
 
 
-   StandardConstantFunction::StandardConstantFunction(ConstantFunctionPointer function) : Statement(Input::Token()), function(function)
+   TailCall::TailCall(const Input::TokenHandle& token, const std::shared_ptr<FunctionCall>& call) : Statement(token), call(call)
+    {
+    }
+
+   std::shared_ptr<FlowControl> TailCall::execute (CallingContext& context) const
+    {
+       /* Do everything a FunctionCall does up to the call itself, then hand the call to our caller. */
+      try
+       {
+         std::shared_ptr<Types::ValueType> LOC = call->location->evaluate(context);
+         std::shared_ptr<FunctionContext> function = call->getFunction(context, LOC);
+         std::vector<std::shared_ptr<Types::ValueType> > ARGS (call->args.size());
+         for (size_t i = 0U; i < call->args.size(); ++i)
+          {
+            ARGS[i] = call->args[i]->evaluate(context);
+          }
+         return std::make_shared<FlowControl>(call->token, LOC, function, std::move(ARGS));
+       }
+      catch (const Types::TypedOperationException& e)
+       {
+         std::string msg = Expression::constructMessage(e, token);
+         if (nullptr != context.debugger)
+          {
+            context.debugger->EnterDebugger(msg, context);
+          }
+         throw Types::TypedOperationException(msg);
+       }
+    }
+
+
+   StandardConstantFunction::StandardConstantFunction(ConstantFunctionPointer function) : Statement(Input::TokenHandle()), function(function)
     {
     }
 
@@ -630,7 +718,7 @@ namespace Engine
     }
 
 
-   StandardConstantFunctionWithContext::StandardConstantFunctionWithContext(ConstantFunctionPointerWithContext function) : Statement(Input::Token()), function(function)
+   StandardConstantFunctionWithContext::StandardConstantFunctionWithContext(ConstantFunctionPointerWithContext function) : Statement(Input::TokenHandle()), function(function)
     {
     }
 
@@ -640,7 +728,7 @@ namespace Engine
     }
 
 
-   StandardUnaryFunction::StandardUnaryFunction(UnaryFunctionPointer function) : Statement(Input::Token()), function(function)
+   StandardUnaryFunction::StandardUnaryFunction(UnaryFunctionPointer function) : Statement(Input::TokenHandle()), function(function)
     {
     }
 
@@ -662,7 +750,7 @@ namespace Engine
     }
 
 
-   StandardUnaryFunctionWithContext::StandardUnaryFunctionWithContext(UnaryFunctionPointerWithContext function) : Statement(Input::Token()), function(function)
+   StandardUnaryFunctionWithContext::StandardUnaryFunctionWithContext(UnaryFunctionPointerWithContext function) : Statement(Input::TokenHandle()), function(function)
     {
     }
 
@@ -684,7 +772,7 @@ namespace Engine
     }
 
 
-   StandardBinaryFunction::StandardBinaryFunction(BinaryFunctionPointer function) : Statement(Input::Token()), function(function)
+   StandardBinaryFunction::StandardBinaryFunction(BinaryFunctionPointer function) : Statement(Input::TokenHandle()), function(function)
     {
     }
 
@@ -707,7 +795,7 @@ namespace Engine
     }
 
 
-   StandardTernaryFunction::StandardTernaryFunction(TernaryFunctionPointer function) : Statement(Input::Token()), function(function)
+   StandardTernaryFunction::StandardTernaryFunction(TernaryFunctionPointer function) : Statement(Input::TokenHandle()), function(function)
     {
     }
 
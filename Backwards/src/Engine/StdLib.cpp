@@ -40,6 +40,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Engine/CellRefEval.h"
 #include "Backwards/Engine/DebuggerHook.h"
 #include "Backwards/Engine/ProgrammingException.h"
+#include "Backwards/Engine/RoundingMode.h"
 
 #include "Backwards/Types/FloatValue.h"
 #include "Backwards/Types/StringValue.h"
@@ -330,7 +331,7 @@ namespace Engine
     {
       if (typeid(Types::StringValue) == typeid(*arg))
        {
-         return std::make_shared<Types::FloatValue>(dm_double_fromdouble(static_cast<const Types::StringValue&>(*arg).value.size()));
+         return Types::FloatValue::make(dm_double_fromdouble(static_cast<const Types::StringValue&>(*arg).value.size()));
        }
       else
        {
@@ -342,11 +343,11 @@ namespace Engine
     {
       if (typeid(Types::ArrayValue) == typeid(*arg))
        {
-         return std::make_shared<Types::FloatValue>(dm_double_fromdouble(static_cast<const Types::ArrayValue&>(*arg).value.size()));
+         return Types::FloatValue::make(dm_double_fromdouble(static_cast<const Types::ArrayValue&>(*arg).value.size()));
        }
       else if (typeid(Types::DictionaryValue) == typeid(*arg))
        {
-         return std::make_shared<Types::FloatValue>(dm_double_fromdouble(static_cast<const Types::DictionaryValue&>(*arg).value.size()));
+         return Types::FloatValue::make(dm_double_fromdouble(static_cast<const Types::DictionaryValue&>(*arg).value.size()));
        }
       else
        {
@@ -391,9 +392,7 @@ namespace Engine
                   (endIndex >= 0.0) && (endIndex <= stringLength) &&
                   (endIndex >= startIndex))
                 {
-                  std::shared_ptr<Types::StringValue> result = std::make_shared<Types::StringValue>();
-                  result->value = static_cast<const Types::StringValue&>(*first).value.substr(static_cast<size_t>(startIndex), static_cast<size_t>(endIndex - startIndex));
-                  return result;
+                  return std::make_shared<Types::StringValue>(static_cast<const Types::StringValue&>(*first).value.substr(static_cast<size_t>(startIndex), static_cast<size_t>(endIndex - startIndex)));
                 }
                else
                 {
@@ -523,7 +522,7 @@ namespace Engine
     { \
       if (typeid(Types::FloatValue) == typeid(*arg)) \
        { \
-         return std::make_shared<Types::FloatValue>(y(static_cast<const Types::FloatValue&>(*arg).value)); \
+         return Types::FloatValue::make(y(static_cast<const Types::FloatValue&>(*arg).value)); \
        } \
       else \
        { \
@@ -544,7 +543,7 @@ namespace Engine
       if (typeid(Types::FloatValue) == typeid(*arg))
        {
          dm_double x = static_cast<const Types::FloatValue&>(*arg).value;
-         return std::make_shared<Types::FloatValue>(dm_double_mul(x, x));
+         return Types::FloatValue::make(dm_double_mul(x, x));
        }
       else
        {
@@ -561,7 +560,7 @@ namespace Engine
          str >> val;
          if (!str.fail() && (str.get() == std::char_traits<char>::eof()))
           {
-            return std::make_shared<Types::FloatValue>(dm_double_fromstring(static_cast<const Types::StringValue&>(*arg).value.c_str()));
+            return Types::FloatValue::make(dm_double_fromstring(static_cast<const Types::StringValue&>(*arg).value.c_str()));
           }
          else
           {
@@ -581,7 +580,7 @@ namespace Engine
          const std::string& str (static_cast<const Types::StringValue&>(*arg).value);
          if (1U == str.size())
           {
-            return std::make_shared<Types::FloatValue>(dm_double_fromdouble(str[0]));
+            return Types::FloatValue::make(dm_double_fromdouble(str[0]));
           }
          else
           {
@@ -639,12 +638,13 @@ namespace Engine
       return ConstantsSingleton::getInstance().FLOAT_ZERO;
     }
 
-   STDLIB_CONSTANT_DECL(GetRoundMode)
+    // The rounding mode belongs to the context. The library only has the one, which RoundingMode shares out.
+   STDLIB_CONSTANT_DECL_WITH_CONTEXT(GetRoundMode)
     {
-      return std::make_shared<Types::FloatValue>(dm_double_fromdouble(static_cast<double>(dm_fegetround())));
+      return Types::FloatValue::make(dm_double_fromdouble(static_cast<double>(context.roundMode)));
     }
 
-   STDLIB_UNARY_DECL(SetRoundMode)
+   STDLIB_UNARY_DECL_WITH_CONTEXT(SetRoundMode)
     {
       if (typeid(Types::FloatValue) == typeid(*arg))
        {
@@ -652,7 +652,8 @@ namespace Engine
          if ((val >= static_cast<double>(DM_FE_TONEAREST)) &&
             (val <= static_cast<double>(DM_FE_FROMZERO)))
           {
-            (void) dm_fesetround(static_cast<int>(val));
+            context.roundMode = static_cast<int>(val);
+            RoundingMode::change(context.roundMode);
             return arg;
           }
          else
@@ -0,0 +1,168 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Input/StringPool.h"
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace Backwards
+ {
+
+namespace Input
+ {
+
+namespace
+ {
+
+   class Hash final
+    {
+   public:
+      size_t operator() (const std::string* text) const { return std::hash<std::string>()(*text); }
+    };
+
+   class Equal final
+    {
+   public:
+      bool operator() (const std::string* lhs, const std::string* rhs) const { return *lhs == *rhs; }
+    };
+
+   class Stripe final
+    {
+   public:
+      std::mutex lock;
+         // Keyed by the held string itself, so that each string is only stored once.
+      std::unordered_map<const std::string*, std::weak_ptr<const std::string>, Hash, Equal> strings;
+    };
+
+   const size_t STRIPES = 64U;
+
+    // Never destroyed: trees in static objects may outlive any static pool.
+   Stripe* getStripes (void)
+    {
+      static Stripe* stripes = new Stripe [STRIPES];
+      return stripes;
+    }
+
+   typedef std::unordered_map<std::string, std::shared_ptr<const std::string> > LocalStrings;
+
+    // This thread's strings, while it has a StringPool::Local.
+   thread_local LocalStrings* local = nullptr;
+
+    // When the last holder lets go, take the string out of its stripe.
+   class Release final
+    {
+   public:
+      Stripe* stripe;
+
+      void operator() (const std::string* text) const
+       {
+          {
+            std::lock_guard<std::mutex> guard (stripe->lock);
+            std::unordered_map<const std::string*, std::weak_ptr<const std::string>, Hash, Equal>::iterator found = stripe->strings.find(text);
+               // The entry may already be for a new copy of the string, made while this one was on its way out.
+            if ((stripe->strings.end() != found) && (text == found->first))
+             {
+               stripe->strings.erase(found);
+             }
+          }
+         delete text;
+       }
+    };
+
+    // Interns in the pool that every thread shares.
+   std::shared_ptr<const std::string> shared (const std::string& text)
+    {
+      Stripe& stripe = getStripes()[std::hash<std::string>()(text) % STRIPES];
+      std::lock_guard<std::mutex> guard (stripe.lock);
+      std::unordered_map<const std::string*, std::weak_ptr<const std::string>, Hash, Equal>::iterator found = stripe.strings.find(&text);
+      if (stripe.strings.end() != found)
+       {
+         std::shared_ptr<const std::string> result = found->second.lock();
+         if (nullptr != result.get())
+          {
+            return result;
+          }
+         stripe.strings.erase(found);
+       }
+      std::shared_ptr<const std::string> result (new std::string(text), Release { &stripe });
+      stripe.strings.insert(std::make_pair(result.get(), std::weak_ptr<const std::string>(result)));
+      return result;
+    }
+
+ } // namespace
+
+   std::shared_ptr<const std::string> StringPool::intern (const std::string& text)
+    {
+      if (nullptr == local)
+       {
+         return shared(text);
+       }
+      LocalStrings::const_iterator found = local->find(text);
+      if (local->end() == found)
+       {
+         found = local->insert(std::make_pair(text, shared(text))).first;
+       }
+      return found->second;
+    }
+
+   StringPool::Local::Local() : owner(nullptr == local)
+    {
+      if (true == owner)
+       {
+         local = new LocalStrings();
+       }
+    }
+
+   StringPool::Local::~Local()
+    {
+      if (true == owner)
+       {
+         delete local;
+         local = nullptr;
+       }
+    }
+
+   size_t StringPool::size (void)
+    {
+      size_t result = 0U;
+      for (size_t i = 0U; i < STRIPES; ++i)
+       {
+         std::lock_guard<std::mutex> guard (getStripes()[i].lock);
+         result += getStripes()[i].strings.size();
+       }
+      return result;
+    }
+
+ } // namespace Input
+
+ } // namespace Backwards
@@ -0,0 +1,78 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Input/TokenHandle.h"
+#include "Backwards/Input/StringPool.h"
+
+namespace Backwards
+ {
+
+namespace Input
+ {
+
+   static std::shared_ptr<const std::string> hold (const std::string& text)
+    {
+      if (true == text.empty())
+       {
+         return std::shared_ptr<const std::string>();
+       }
+      return StringPool::intern(text);
+    }
+
+   static const std::string& held (const std::shared_ptr<const std::string>& text)
+    {
+      static const std::string empty;
+      return (nullptr != text.get()) ? *text : empty;
+    }
+
+   TokenHandle::TokenHandle(const Token& token) : spelling(hold(token.text)), source(hold(token.sourceFile)),
+      line(static_cast<uint32_t>(token.lineNumber)), column(static_cast<uint32_t>(token.lineLocation)), kind(token.lexeme)
+    {
+    }
+
+   Token TokenHandle::token() const
+    {
+      return Token(kind, text(), sourceFile(), line, column);
+    }
+
+   const std::string& TokenHandle::text() const
+    {
+      return held(spelling);
+    }
+
+   const std::string& TokenHandle::sourceFile() const
+    {
+      return held(source);
+    }
+
+ } // namespace Input
+
+ } // namespace Backwards
@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Engine/Statement.h"
 #include "Backwards/Engine/StdLib.h"
 #include "Backwards/Engine/FunctionContext.h"
+#include "Backwards/Engine/Scope.h"
 
 #include <sstream>
 
@@ -42,18 +43,25 @@ namespace Backwards
 namespace Parser
  {
 
+    // For the library functions that take the context, but only read things that a call remembers along with its arguments.
+   static void markPure(const std::string& name, Engine::Scope& global)
+    {
+      const Types::FunctionValue& value = static_cast<const Types::FunctionValue&>(*global.vars[global.var[name]]);
+      static_cast<Engine::FunctionContext&>(*value.value).pure = true;
+    }
+
    void ContextBuilder::createGlobalScope(Engine::Scope& global)
     {
-    // 4
+    // 3
       addFunction("NaN", std::make_shared<Engine::StandardConstantFunction>(Engine::NaN), 0U, global);
       addFunction("NewArray", std::make_shared<Engine::StandardConstantFunction>(Engine::NewArray), 0U, global);
       addFunction("NewDictionary", std::make_shared<Engine::StandardConstantFunction>(Engine::NewDictionary), 0U, global);
-      addFunction("GetRoundMode", std::make_shared<Engine::StandardConstantFunction>(Engine::GetRoundMode), 0U, global);
 
-    // 1
+    // 2
       addFunction("EnterDebugger", std::make_shared<Engine::StandardConstantFunctionWithContext>(Engine::EnterDebugger), 0U, global);
+      addFunction("GetRoundMode", std::make_shared<Engine::StandardConstantFunctionWithContext>(Engine::GetRoundMode), 0U, global);
 
-    // 25
+    // 24
       addFunction("Sqr", std::make_shared<Engine::StandardUnaryFunction>(Engine::Sqr), 1U, global);
       addFunction("Abs", std::make_shared<Engine::StandardUnaryFunction>(Engine::Abs), 1U, global);
       addFunction("Round", std::make_shared<Engine::StandardUnaryFunction>(Engine::Round), 1U, global);
@@ -78,9 +86,8 @@ namespace Parser
       addFunction("PopFront", std::make_shared<Engine::StandardUnaryFunction>(Engine::PopFront), 1U, global);
       addFunction("PopBack", std::make_shared<Engine::StandardUnaryFunction>(Engine::PopBack), 1U, global);
       addFunction("GetKeys", std::make_shared<Engine::StandardUnaryFunction>(Engine::GetKeys), 1U, global);
-      addFunction("SetRoundMode", std::make_shared<Engine::StandardUnaryFunction>(Engine::SetRoundMode), 1U, global);
 
-    // 8
+    // 9
       addFunction("Error", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::Error), 1U, global);
       addFunction("Warn", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::Warn), 1U, global);
       addFunction("Info", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::Info), 1U, global);
@@ -89,6 +96,10 @@ namespace Parser
       addFunction("Eval", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::Eval), 1U, global);
       addFunction("EvalCell", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::EvalCell), 1U, global);
       addFunction("ExpandRange", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::ExpandRange), 1U, global);
+      addFunction("SetRoundMode", std::make_shared<Engine::StandardUnaryFunctionWithContext>(Engine::SetRoundMode), 1U, global);
+      markPure("GetRoundMode", global);
+      markPure("EvalCell", global);
+      markPure("ExpandRange", global);
 
     // 9
       addFunction("Min", std::make_shared<Engine::StandardBinaryFunction>(Engine::Min), 2U, global);
@@ -116,6 +127,9 @@ namespace Parser
       fun->nargs = nargs;
       fun->nlocals = 0;
       fun->function = function;
+       // Only the functions of their arguments alone. Anything else, like a plugin's function, may look at anything.
+      fun->pure = (typeid(Engine::StandardConstantFunction) == typeid(*function)) || (typeid(Engine::StandardUnaryFunction) == typeid(*function)) ||
+         (typeid(Engine::StandardBinaryFunction) == typeid(*function)) || (typeid(Engine::StandardTernaryFunction) == typeid(*function));
 
       global.names.emplace_back(name);
       global.var.emplace(std::make_pair(name, global.vars.size()));
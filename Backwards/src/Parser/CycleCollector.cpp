@@ -0,0 +1,232 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Parser/CycleCollector.h"
+#include "Backwards/Parser/TreeWalk.h"
+
+#include "Backwards/Engine/Expression.h"
+#include "Backwards/Engine/Statement.h"
+#include "Backwards/Engine/FunctionContext.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Backwards
+ {
+
+namespace Parser
+ {
+
+namespace
+ {
+
+   class Registry final
+    {
+   public:
+      std::mutex lock;
+      std::vector<std::weak_ptr<Engine::FunctionContext> > functions;
+
+      static Registry& getInstance()
+       {
+         static Registry instance;
+         return instance;
+       }
+    };
+
+    // A function, or a Function value held by a Constant in a function body.
+   class Node final
+    {
+   public:
+      long references;
+      long internal;
+      bool alive;
+      std::vector<const void*> out;
+
+      Node() : references(0), internal(0), alive(false) { }
+    };
+
+   class Graph final
+    {
+   public:
+      std::unordered_map<const void*, Node> nodes;
+      std::unordered_set<const Engine::Expression*> seen;
+
+      void expression (Node& from, Engine::Expression& expr)
+       {
+         if (false == seen.insert(&expr).second)
+          {
+            return; // Another reference to the same node: what it holds is only held once.
+          }
+         if (typeid(Engine::BuildFunction) == typeid(expr))
+          {
+            Engine::BuildFunction& build = static_cast<Engine::BuildFunction&>(expr);
+            if (nullptr != build.prototype.get())
+             {
+               from.out.push_back(build.prototype.get());
+             }
+          }
+         else if (typeid(Engine::Constant) == typeid(expr))
+          {
+            const std::shared_ptr<Types::ValueType>& value = static_cast<Engine::Constant&>(expr).value;
+            if ((nullptr != value.get()) && (typeid(Types::FunctionValue) == typeid(*value)))
+             {
+               from.out.push_back(value.get());
+               Node& node = nodes[value.get()];
+               if (0 == node.references)
+                {
+                  node.references = value.use_count();
+                  node.out.push_back(dynamic_cast<const Engine::FunctionContext*>(static_cast<const Types::FunctionValue&>(*value).value.get()));
+                }
+             }
+          }
+         forEachChild(expr, [this, &from](std::shared_ptr<Engine::Expression>& child) { expression(from, *child); });
+       }
+
+      void function (Node& from, std::shared_ptr<Engine::Statement>& body)
+       {
+         forEachStatement(body, [this, &from](std::shared_ptr<Engine::Statement>& stmt)
+          {
+            forEachExpression(*stmt, [this, &from](std::shared_ptr<Engine::Expression>& expr) { expression(from, *expr); });
+            if (typeid(Engine::TailCall) == typeid(*stmt))
+             {
+               expression(from, *static_cast<Engine::TailCall&>(*stmt).call);
+             }
+          });
+       }
+
+      void mark (Node& node)
+       {
+         node.alive = true;
+         for (const void* target : node.out)
+          {
+            std::unordered_map<const void*, Node>::iterator found = nodes.find(target);
+            if ((nodes.end() != found) && (false == found->second.alive))
+             {
+               mark(found->second);
+             }
+          }
+       }
+    };
+
+ } // namespace
+
+   void CycleCollector::track (const std::shared_ptr<Engine::FunctionContext>& function)
+    {
+      Registry& registry = Registry::getInstance();
+      std::lock_guard<std::mutex> guard (registry.lock);
+      registry.functions.emplace_back(function);
+    }
+
+   size_t CycleCollector::collect ()
+    {
+      std::vector<std::shared_ptr<Engine::Statement> > doomed;
+       {
+         Registry& registry = Registry::getInstance();
+         std::lock_guard<std::mutex> guard (registry.lock);
+
+         std::vector<std::shared_ptr<Engine::FunctionContext> > live;
+         std::vector<std::weak_ptr<Engine::FunctionContext> > stillTracked;
+         for (const std::weak_ptr<Engine::FunctionContext>& function : registry.functions)
+          {
+            std::shared_ptr<Engine::FunctionContext> temp = function.lock();
+            if (nullptr != temp.get())
+             {
+               live.emplace_back(std::move(temp));
+               stillTracked.emplace_back(function);
+             }
+          }
+         registry.functions.swap(stillTracked);
+
+         Graph graph;
+         for (std::shared_ptr<Engine::FunctionContext>& function : live)
+          {
+            Node& node = graph.nodes[function.get()];
+            node.references = function.use_count() - 1; // Don't count our own reference.
+          }
+         for (std::shared_ptr<Engine::FunctionContext>& function : live)
+          {
+            if (nullptr != function->function.get())
+             {
+               graph.function(graph.nodes[function.get()], function->function);
+             }
+          }
+
+         for (std::pair<const void* const, Node>& node : graph.nodes)
+          {
+            for (const void* target : node.second.out)
+             {
+               std::unordered_map<const void*, Node>::iterator found = graph.nodes.find(target);
+               if (graph.nodes.end() != found)
+                {
+                  ++found->second.internal;
+                }
+             }
+          }
+         for (std::pair<const void* const, Node>& node : graph.nodes)
+          {
+            if ((false == node.second.alive) && (node.second.references > node.second.internal))
+             {
+               graph.mark(node.second);
+             }
+          }
+
+         for (std::shared_ptr<Engine::FunctionContext>& function : live)
+          {
+            if (false == graph.nodes[function.get()].alive)
+             {
+               doomed.emplace_back(std::move(function->function));
+             }
+          }
+       }
+       // Freeing the bodies frees the functions they held, which may take a while: don't hold the lock for it.
+      return doomed.size();
+    }
+
+   size_t CycleCollector::tracked ()
+    {
+      Registry& registry = Registry::getInstance();
+      std::lock_guard<std::mutex> guard (registry.lock);
+      size_t result = 0U;
+      for (const std::weak_ptr<Engine::FunctionContext>& function : registry.functions)
+       {
+         if (false == function.expired())
+          {
+            ++result;
+          }
+       }
+      return result;
+    }
+
+ } // namespace Parser
+
+ } // namespace Backwards
@@ -140,7 +140,7 @@ namespace Engine
    static void outputFrame(std::ostream& out, StackFrame* frame)
    {
       out << "#" << frame->depth << ": >" << frame->function->name <<
-         "< from line " << frame->callingToken.lineNumber << " in " << frame->callingToken.sourceFile;
+         "< from line " << frame->callingToken.lineNumber() << " in " << frame->callingToken.sourceFile();
    }
 
    void DefaultDebugger::EnterDebugger(const std::string& exceptionMessage, CallingContext& context)
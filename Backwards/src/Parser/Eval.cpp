@@ -39,6 +39,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Backwards/Engine/Expression.h"
 #include "Backwards/Engine/CallingContext.h"
+#include "Backwards/Engine/EvalCache.h"
+#include "Backwards/Engine/RoundingMode.h"
+#include "Backwards/Engine/Scope.h"
 
 #include "Backwards/Types/FloatValue.h"
 #include "Backwards/Types/StringValue.h"
@@ -52,21 +55,97 @@ namespace Backwards
 namespace Engine
  {
 
+   const size_t EvalCache::CAPACITY = 64U;
+
+   std::shared_ptr<Expression> EvalCache::get (const std::string& text, const Scope* global, size_t globals, size_t scoped)
+    {
+      std::lock_guard<std::mutex> guard (lock);
+      std::map<std::string, std::list<Entry>::iterator>::iterator found = index.find(text);
+      if (index.end() == found)
+       {
+         return std::shared_ptr<Expression>();
+       }
+      std::list<Entry>::iterator entry = found->second;
+      if ((global != entry->global) || (globals != entry->globals) || (scoped != entry->scoped))
+       {
+         entries.erase(entry);
+         index.erase(found);
+         return std::shared_ptr<Expression>();
+       }
+      entries.splice(entries.begin(), entries, entry);
+      return entry->expr;
+    }
+
+   void EvalCache::put (const std::string& text, const Scope* global, size_t globals, size_t scoped, const std::shared_ptr<Expression>& expr)
+    {
+      std::lock_guard<std::mutex> guard (lock);
+      std::map<std::string, std::list<Entry>::iterator>::iterator found = index.find(text);
+      if (index.end() != found)
+       {
+         entries.erase(found->second);
+         index.erase(found);
+       }
+      entries.emplace_front();
+      entries.front().text = text;
+      entries.front().global = global;
+      entries.front().globals = globals;
+      entries.front().scoped = scoped;
+      entries.front().expr = expr;
+      index.emplace(std::make_pair(text, entries.begin()));
+      if (entries.size() > CAPACITY)
+       {
+         index.erase(entries.back().text);
+         entries.pop_back();
+       }
+    }
+
+   size_t EvalCache::size() const
+    {
+      std::lock_guard<std::mutex> guard (lock);
+      return entries.size();
+    }
+
    STDLIB_UNARY_DECL_WITH_CONTEXT(Eval)
     {
       if (typeid(Types::StringValue) == typeid(*arg))
        {
-         Input::StringInput string (static_cast<const Types::StringValue&>(*arg).value);
-         Input::Lexer lexer (string, "Eval Argument");
+         const std::string& text = static_cast<const Types::StringValue&>(*arg).value;
+         RoundingMode::Hold rounding (context.roundMode);
 
-         Parser::GetterSetter gs;
-         Parser::SymbolTable table (gs, *context.globalScope);
-         if (nullptr != context.topScope())
+          // Cache the parse in the innermost scope it was parsed against, so that it dies with that scope.
+          // A frozen scope is shared between threads, so it only gets the cache it was frozen with.
+         Scope* owner = (nullptr != context.topScope()) ? context.topScope() : context.globalScope;
+         if ((nullptr == owner->evalCache.get()) && (false == owner->frozen))
           {
-            table.pushScope(context.topScope());
+            owner->evalCache = std::make_shared<EvalCache>();
           }
+         EvalCache* cache = owner->evalCache.get();
+         const size_t scoped = (nullptr != context.topScope()) ? context.topScope()->var.size() : 0U;
 
-         std::shared_ptr<Expression> res = Parser::Parser::ParseFullExpression(lexer, table, *context.logger);
+         std::shared_ptr<Expression> res;
+         if (nullptr != cache)
+          {
+            res = cache->get(text, context.globalScope, context.globalScope->var.size(), scoped);
+          }
+         if (nullptr == res.get())
+          {
+            Input::StringInput string (text);
+            Input::Lexer lexer (string, "Eval Argument");
+
+            Parser::GetterSetter gs;
+            Parser::SymbolTable table (gs, *context.globalScope);
+            if (nullptr != context.topScope())
+             {
+               table.pushScope(context.topScope());
+             }
+
+            res = Parser::Parser::ParseFullExpression(lexer, table, *context.logger);
+
+            if ((nullptr != res.get()) && (nullptr != cache))
+             {
+               cache->put(text, context.globalScope, context.globalScope->var.size(), scoped, res);
+             }
+          }
 
          if (nullptr != res.get())
           {
@@ -0,0 +1,199 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Parser/LazyFunction.h"
+#include "Backwards/Parser/Parser.h"
+#include "Backwards/Parser/SymbolTable.h"
+
+#include "Backwards/Input/Lexer.h"
+#include "Backwards/Input/StringInput.h"
+
+#include "Backwards/Engine/CallingContext.h"
+#include "Backwards/Engine/FatalException.h"
+#include "Backwards/Engine/Logger.h"
+#include "Backwards/Engine/Scope.h"
+#include "Backwards/Engine/Statement.h"
+
+#include "Backwards/Types/FunctionValue.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace Backwards
+ {
+
+namespace Parser
+ {
+
+   class BodyLogger final : public Engine::Logger
+    {
+   public:
+      std::vector<std::string> logs;
+      void log (const std::string& message) { logs.emplace_back(message); }
+      std::string get () { return ""; }
+    };
+
+   LazySource::LazySource(const std::string& text, const std::string& sourceName, Engine::Scope& global) :
+      text(text), sourceName(sourceName), global(&global)
+    {
+      lines.push_back(0U);
+      for (size_t i = 0U; i < text.size(); ++i)
+       {
+         if ('\n' == text[i])
+          {
+            lines.push_back(i + 1U);
+          }
+       }
+    }
+
+   static const char* const BUILDERS [] = { "PushBack", "Insert" };
+
+   void LazySource::snapshot (void)
+    {
+      names = global->names;
+      builders.clear();
+      for (const char* builder : BUILDERS)
+       {
+         std::map<std::string, size_t>::const_iterator found = global->var.find(builder);
+         builders.emplace_back((global->var.end() != found) ? global->vars[found->second] : std::shared_ptr<Types::ValueType>());
+       }
+    }
+
+    // The Lexer counts lines and characters from one, and every character but a newline as one.
+   size_t LazySource::offset (size_t lineNumber, size_t lineLocation) const
+    {
+      if ((0U == lineNumber) || (lineNumber > lines.size()))
+       {
+         return text.size();
+       }
+      return std::min(lines[lineNumber - 1U] + lineLocation - 1U, text.size());
+    }
+
+   LazyFunction::LazyFunction(const std::shared_ptr<const LazySource>& source, const Input::Token& first, const Input::Token& last, const std::string& name) :
+      source(source), begin(source->offset(first.lineNumber, first.lineLocation)), end(source->offset(last.lineNumber, last.lineLocation) + last.text.size()),
+      lineNumber(first.lineNumber), lineLocation(first.lineLocation), name(name), nglobals(source->global->names.size()), done(false)
+    {
+    }
+
+   void LazyFunction::resolve (const std::shared_ptr<Engine::FunctionContext>& function, Engine::CallingContext& context)
+    {
+      if (true == done.load(std::memory_order_acquire))
+       {
+         return;
+       }
+      std::lock_guard<std::mutex> guard (lock);
+      if (true == done.load(std::memory_order_relaxed))
+       {
+         return;
+       }
+
+      if (true == error.empty())
+       {
+          // The globals as they were when the function was defined. They are only ever added to the end.
+          // They come from the snapshot: the live global scope may be changing under us.
+          // The table only reads the values of PushBack and Insert.
+         Engine::Scope view;
+         view.names.assign(source->names.begin(), source->names.begin() + std::min(nglobals, source->names.size()));
+         view.vars.resize(view.names.size());
+         for (size_t i = 0U; i < view.names.size(); ++i)
+          {
+            view.var.emplace(std::make_pair(view.names[i], i));
+          }
+         for (size_t i = 0U; i < source->builders.size(); ++i)
+          {
+            std::map<std::string, size_t>::const_iterator found = view.var.find(BUILDERS[i]);
+            if (view.var.end() != found)
+             {
+               view.vars[found->second] = source->builders[i];
+             }
+          }
+
+         BodyLogger logger;
+         GetterSetter gs;
+         SymbolTable table (gs, view);
+         table.injectContext(function);
+         table.activeFunctions.emplace(name, function);
+
+         Input::StringInput input (source->text.substr(begin, end - begin));
+         Input::Lexer lexer (input, source->sourceName, lineNumber, lineLocation);
+         if (nullptr != Parser::ParseFunctionBody(lexer, table, logger).get())
+          {
+            done.store(true, std::memory_order_release);
+            return;
+          }
+
+         std::stringstream str;
+         str << "Function >" << function->name << "< from file " << source->sourceName << " could not be parsed.";
+         for (const std::string& message : logger.logs)
+          {
+            str << std::endl << message;
+            if (nullptr != context.logger)
+             {
+               context.logger->log(message);
+             }
+          }
+         error = str.str();
+       }
+      throw Engine::FatalException(error);
+    }
+
+   size_t LazyFunction::check (const Engine::Scope& global, Engine::Logger& logger)
+    {
+      Engine::CallingContext context;
+      context.logger = &logger;
+
+      size_t failed = 0U;
+      for (const std::shared_ptr<Types::ValueType>& value : global.vars)
+       {
+         if ((nullptr == value.get()) || (Types::FUNCTION != value->getType()))
+          {
+            continue;
+          }
+         std::shared_ptr<Engine::FunctionContext> function =
+            std::dynamic_pointer_cast<Engine::FunctionContext>(static_cast<const Types::FunctionValue&>(*value).value);
+         if ((nullptr != function.get()) && (nullptr != function->deferred.get()))
+          {
+            try
+             {
+               function->deferred->resolve(function, context);
+             }
+            catch (const Engine::FatalException&)
+             {
+               ++failed;
+             }
+          }
+       }
+      return failed;
+    }
+
+ } // namespace Parser
+
+ } // namespace Backwards
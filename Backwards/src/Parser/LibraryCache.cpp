@@ -0,0 +1,1187 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Parser/LibraryCache.h"
+#include "Backwards/Parser/Parser.h"
+#include "Backwards/Parser/SymbolTable.h"
+#include "Backwards/Parser/CycleCollector.h"
+
+#include "Backwards/Input/Lexer.h"
+#include "Backwards/Input/StringInput.h"
+
+#include "Backwards/Engine/Expression.h"
+#include "Backwards/Engine/Statement.h"
+#include "Backwards/Engine/FunctionContext.h"
+#include "Backwards/Engine/StackFrame.h"
+#include "Backwards/Engine/Scope.h"
+#include "Backwards/Engine/ConstantsSingleton.h"
+#include "Backwards/Engine/SelectTable.h"
+
+#include "Backwards/Types/FloatValue.h"
+#include "Backwards/Types/StringValue.h"
+#include "Backwards/Types/FunctionValue.h"
+#include "Backwards/Types/NilValue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace Backwards
+ {
+
+namespace Parser
+ {
+
+    // Bump this whenever a node class gains, loses, or changes a field, or any of the tags or enumerations below
+    // (or Lexeme, FlowControl::Type, and CaseContainer::CaseType, which are written as numbers) change.
+   const unsigned int LibraryCache::VERSION = 2U;
+
+   static const char MAGIC [] = "BWLC";
+
+   class CacheException final : public std::exception
+    {
+   public:
+      const char * what() const throw() { return "Library cache can't hold this."; }
+    };
+
+   enum ExpressionTag
+    {
+      NO_EXPRESSION,
+      CONSTANT,
+      VARIABLE,
+      PLUS,
+      MINUS,
+      MULTIPLY,
+      DIVIDE,
+      SHORT_AND,
+      SHORT_OR,
+      EQUALS,
+      NOT_EQUAL,
+      GREATER,
+      LESS,
+      GEQ,
+      LEQ,
+      DEREF_VAR,
+      NOT,
+      NEGATE,
+      FUNCTION_CALL,
+      BUILD_FUNCTION,
+      TERNARY_OPERATION,
+      INVARIANT
+    };
+
+   enum StatementTag
+    {
+      NO_STATEMENT,
+      NOP,
+      EXPR,
+      STATEMENT_SEQ,
+      ASSIGNMENT,
+      IF_STATEMENT,
+      WHILE_STATEMENT,
+      SELECT_STATEMENT,
+      FOR_STATEMENT,
+      INVARIANT_LOOP,
+      FLOW_CONTROL_STATEMENT,
+      TAIL_CALL
+    };
+
+   enum ValueTag
+    {
+      FLOAT_VALUE,
+      STRING_VALUE,
+      NIL_VALUE,
+      FUNCTION_VALUE,
+      EMPTY_ARRAY,
+      EMPTY_DICTIONARY
+    };
+
+   enum VariableTag
+    {
+      GLOBAL,
+      SCOPE,
+      LOCAL,
+      ARG,
+      CAPTURE
+    };
+
+    /*
+      Writes a tree in pre-order. Tokens and functions are written as numbers into tables.
+      A function is numbered when it is first seen, and its body written after the tree that refers to it,
+      so that a function that refers to itself is only written once.
+    */
+   class CacheWriter final
+    {
+   public:
+      std::string out;
+      std::vector<Input::Token> tokens;
+      std::vector<std::shared_ptr<Engine::FunctionContext> > functions;
+
+      void number (uint64_t value)
+       {
+         while (value >= 0x80U)
+          {
+            out.push_back(static_cast<char>((value & 0x7FU) | 0x80U));
+            value >>= 7;
+          }
+         out.push_back(static_cast<char>(value));
+       }
+
+      void string (const std::string& value)
+       {
+         number(value.size());
+         out.append(value);
+       }
+
+      void token (const Input::TokenHandle& value)
+       {
+         if (Input::TokenHandle() == value)
+          {
+            number(0U);
+            return;
+          }
+            // Held strings are equal when they are the same string.
+         const TokenKey key (value.lexeme(), &value.text(), &value.sourceFile(), value.lineNumber(), value.lineLocation());
+         std::map<TokenKey, size_t>::const_iterator found = tokenIds.find(key);
+         if (tokenIds.end() == found)
+          {
+            found = tokenIds.insert(std::make_pair(key, tokens.size() + 1U)).first;
+            tokens.emplace_back(value.token());
+          }
+         number(found->second);
+       }
+
+      void function (const std::shared_ptr<Engine::FunctionContext>& value)
+       {
+         std::map<const Engine::FunctionContext*, size_t>::const_iterator found = functionIds.find(value.get());
+         if (functionIds.end() == found)
+          {
+            found = functionIds.insert(std::make_pair(value.get(), functions.size())).first;
+            functions.emplace_back(value);
+          }
+         number(found->second);
+       }
+
+      void names (const std::map<std::string, size_t>& value)
+       {
+         number(value.size());
+         for (const std::pair<const std::string, size_t>& name : value)
+          {
+            string(name.first);
+            number(name.second);
+          }
+       }
+
+      void names (const std::vector<std::string>& value)
+       {
+         number(value.size());
+         for (const std::string& name : value)
+          {
+            string(name);
+          }
+       }
+
+      void value (const std::shared_ptr<Types::ValueType>&);
+      void getter (const std::shared_ptr<Engine::Getter>&);
+      void setter (const std::shared_ptr<Engine::Setter>&);
+      void expression (const std::shared_ptr<Engine::Expression>&);
+      void statement (const std::shared_ptr<Engine::Statement>&);
+      void context (const Engine::FunctionContext&);
+
+   private:
+      typedef std::tuple<Input::Lexeme, const std::string*, const std::string*, size_t, size_t> TokenKey;
+      std::map<TokenKey, size_t> tokenIds;
+      std::map<const Engine::FunctionContext*, size_t> functionIds;
+    };
+
+   void CacheWriter::value (const std::shared_ptr<Types::ValueType>& value)
+    {
+      switch (value->getType())
+       {
+      case Types::FLOAT:
+         number(FLOAT_VALUE);
+         number(static_cast<const Types::FloatValue&>(*value).value);
+         break;
+      case Types::STRING:
+         number(STRING_VALUE);
+         string(static_cast<const Types::StringValue&>(*value).value);
+         break;
+      case Types::NIL:
+         number(NIL_VALUE);
+         break;
+      case Types::FUNCTION:
+       {
+         const Types::FunctionValue& fun = static_cast<const Types::FunctionValue&>(*value);
+         if (false == fun.captures.empty())
+          {
+            throw CacheException();
+          }
+         number(FUNCTION_VALUE);
+         function(std::static_pointer_cast<Engine::FunctionContext>(fun.value));
+       }
+         break;
+      case Types::ARRAY:
+         if (value != Engine::ConstantsSingleton::getInstance().EMPTY_ARRAY)
+          {
+            throw CacheException();
+          }
+         number(EMPTY_ARRAY);
+         break;
+      case Types::DICTIONARY:
+         if (value != Engine::ConstantsSingleton::getInstance().EMPTY_DICTIONARY)
+          {
+            throw CacheException();
+          }
+         number(EMPTY_DICTIONARY);
+         break;
+      default:
+         throw CacheException();
+       }
+    }
+
+   void CacheWriter::getter (const std::shared_ptr<Engine::Getter>& getter)
+    {
+      const Engine::Getter& it = *getter;
+      if (typeid(Engine::GlobalGetter) == typeid(it)) { number(GLOBAL); number(static_cast<const Engine::GlobalGetter&>(it).getLocation()); }
+      else if (typeid(Engine::ScopeGetter) == typeid(it)) { number(SCOPE); number(static_cast<const Engine::ScopeGetter&>(it).getLocation()); }
+      else if (typeid(Engine::LocalGetter) == typeid(it)) { number(LOCAL); number(static_cast<const Engine::LocalGetter&>(it).getLocation()); }
+      else if (typeid(Engine::ArgGetter) == typeid(it)) { number(ARG); number(static_cast<const Engine::ArgGetter&>(it).getLocation()); }
+      else if (typeid(Engine::CaptureGetter) == typeid(it)) { number(CAPTURE); number(static_cast<const Engine::CaptureGetter&>(it).getLocation()); }
+      else throw CacheException();
+    }
+
+   void CacheWriter::setter (const std::shared_ptr<Engine::Setter>& setter)
+    {
+      const Engine::Setter& it = *setter;
+      if (typeid(Engine::GlobalSetter) == typeid(it)) { number(GLOBAL); number(static_cast<const Engine::GlobalSetter&>(it).getLocation()); }
+      else if (typeid(Engine::ScopeSetter) == typeid(it)) { number(SCOPE); number(static_cast<const Engine::ScopeSetter&>(it).getLocation()); }
+      else if (typeid(Engine::LocalSetter) == typeid(it)) { number(LOCAL); number(static_cast<const Engine::LocalSetter&>(it).getLocation()); }
+      else if (typeid(Engine::ArgSetter) == typeid(it)) { number(ARG); number(static_cast<const Engine::ArgSetter&>(it).getLocation()); }
+      else if (typeid(Engine::CaptureSetter) == typeid(it)) { number(CAPTURE); number(static_cast<const Engine::CaptureSetter&>(it).getLocation()); }
+      else throw CacheException();
+    }
+
+#define BINARY(x,y) \
+   else if (typeid(Engine::x) == typeid(it)) \
+    { \
+      number(y); \
+      token(it.token); \
+      expression(static_cast<const Engine::x&>(it).lhs); \
+      expression(static_cast<const Engine::x&>(it).rhs); \
+    }
+
+#define UNARY(x,y) \
+   else if (typeid(Engine::x) == typeid(it)) \
+    { \
+      number(y); \
+      token(it.token); \
+      expression(static_cast<const Engine::x&>(it).arg); \
+    }
+
+   void CacheWriter::expression (const std::shared_ptr<Engine::Expression>& expr)
+    {
+      if (nullptr == expr.get())
+       {
+         number(NO_EXPRESSION);
+         return;
+       }
+      const Engine::Expression& it = *expr;
+      if (typeid(Engine::Constant) == typeid(it))
+       {
+         number(CONSTANT);
+         token(it.token);
+         value(static_cast<const Engine::Constant&>(it).value);
+       }
+      else if (typeid(Engine::Variable) == typeid(it))
+       {
+         number(VARIABLE);
+         token(it.token);
+         getter(static_cast<const Engine::Variable&>(it).getter);
+       }
+      BINARY(Plus, PLUS)
+      BINARY(Minus, MINUS)
+      BINARY(Multiply, MULTIPLY)
+      BINARY(Divide, DIVIDE)
+      BINARY(ShortAnd, SHORT_AND)
+      BINARY(ShortOr, SHORT_OR)
+      BINARY(Equals, EQUALS)
+      BINARY(NotEqual, NOT_EQUAL)
+      BINARY(Greater, GREATER)
+      BINARY(Less, LESS)
+      BINARY(GEQ, GEQ)
+      BINARY(LEQ, LEQ)
+      BINARY(DerefVar, DEREF_VAR)
+      UNARY(Not, NOT)
+      UNARY(Negate, NEGATE)
+      else if (typeid(Engine::FunctionCall) == typeid(it))
+       {
+         const Engine::FunctionCall& call = static_cast<const Engine::FunctionCall&>(it);
+         number(FUNCTION_CALL);
+         token(it.token);
+         expression(call.location);
+         number(call.args.size());
+         for (const std::shared_ptr<Engine::Expression>& arg : call.args)
+          {
+            expression(arg);
+          }
+       }
+      else if (typeid(Engine::BuildFunction) == typeid(it))
+       {
+         const Engine::BuildFunction& build = static_cast<const Engine::BuildFunction&>(it);
+         number(BUILD_FUNCTION);
+         token(it.token);
+         function(build.prototype);
+         number(build.captures.size());
+         for (const std::shared_ptr<Engine::Expression>& capture : build.captures)
+          {
+            expression(capture);
+          }
+       }
+      else if (typeid(Engine::TernaryOperation) == typeid(it))
+       {
+         const Engine::TernaryOperation& op = static_cast<const Engine::TernaryOperation&>(it);
+         number(TERNARY_OPERATION);
+         token(it.token);
+         expression(op.condition);
+         expression(op.thenCase);
+         expression(op.elseCase);
+       }
+      else if (typeid(Engine::Invariant) == typeid(it))
+       {
+         const Engine::Invariant& inv = static_cast<const Engine::Invariant&>(it);
+         number(INVARIANT);
+         token(it.token);
+         expression(inv.expr);
+         number(inv.location);
+       }
+      else
+       {
+         throw CacheException();
+       }
+    }
+
+#undef UNARY
+#undef BINARY
+
+   void CacheWriter::statement (const std::shared_ptr<Engine::Statement>& stmt)
+    {
+      if (nullptr == stmt.get())
+       {
+         number(NO_STATEMENT);
+         return;
+       }
+      const Engine::Statement& it = *stmt;
+      if (typeid(Engine::NOP) == typeid(it))
+       {
+         number(NOP);
+         token(it.token);
+       }
+      else if (typeid(Engine::Expr) == typeid(it))
+       {
+         number(EXPR);
+         token(it.token);
+         expression(static_cast<const Engine::Expr&>(it).expr);
+       }
+      else if (typeid(Engine::StatementSeq) == typeid(it))
+       {
+         const Engine::StatementSeq& seq = static_cast<const Engine::StatementSeq&>(it);
+         number(STATEMENT_SEQ);
+         token(it.token);
+         number(seq.statements.size());
+         for (const std::shared_ptr<Engine::Statement>& child : seq.statements)
+          {
+            statement(child);
+          }
+       }
+      else if (typeid(Engine::Assignment) == typeid(it))
+       {
+         const Engine::Assignment& assign = static_cast<const Engine::Assignment&>(it);
+         number(ASSIGNMENT);
+         token(it.token);
+         getter(assign.getter);
+         setter(assign.setter);
+         size_t indices = 0U;
+         for (std::shared_ptr<Engine::RecAssignState> index = assign.index; nullptr != index.get(); index = index->next)
+          {
+            ++indices;
+          }
+         number(indices);
+         for (std::shared_ptr<Engine::RecAssignState> index = assign.index; nullptr != index.get(); index = index->next)
+          {
+            token(index->token);
+            expression(index->index);
+          }
+         expression(assign.rhs);
+       }
+      else if (typeid(Engine::IfStatement) == typeid(it))
+       {
+         const Engine::IfStatement& branch = static_cast<const Engine::IfStatement&>(it);
+         number(IF_STATEMENT);
+         token(it.token);
+         expression(branch.condition);
+         statement(branch.thenSeq);
+         statement(branch.elseSeq);
+       }
+      else if (typeid(Engine::WhileStatement) == typeid(it))
+       {
+         const Engine::WhileStatement& loop = static_cast<const Engine::WhileStatement&>(it);
+         number(WHILE_STATEMENT);
+         token(it.token);
+         expression(loop.condition);
+         statement(loop.seq);
+         number(loop.id);
+       }
+      else if (typeid(Engine::SelectStatement) == typeid(it))
+       {
+         const Engine::SelectStatement& select = static_cast<const Engine::SelectStatement&>(it);
+         number(SELECT_STATEMENT);
+         token(it.token);
+         expression(select.control);
+         number(select.cases.size());
+         for (const std::shared_ptr<Engine::CaseContainer>& arm : select.cases)
+          {
+            token(arm->token);
+            number(arm->breaking ? 1U : 0U);
+            number(arm->type);
+            expression(arm->condition);
+            expression(arm->lower);
+            statement(arm->seq);
+          }
+         number((nullptr != select.table.get()) ? 1U : 0U);
+       }
+      else if (typeid(Engine::ForStatement) == typeid(it))
+       {
+         const Engine::ForStatement& loop = static_cast<const Engine::ForStatement&>(it);
+         number(FOR_STATEMENT);
+         token(it.token);
+         getter(loop.getter);
+         setter(loop.setter);
+         expression(loop.lower);
+         number(loop.to ? 1U : 0U);
+         expression(loop.upper);
+         expression(loop.step);
+         statement(loop.seq);
+         number(loop.id);
+       }
+      else if (typeid(Engine::InvariantLoop) == typeid(it))
+       {
+         const Engine::InvariantLoop& loop = static_cast<const Engine::InvariantLoop&>(it);
+         number(INVARIANT_LOOP);
+         token(it.token);
+         number(loop.locations.size());
+         for (size_t location : loop.locations)
+          {
+            number(location);
+          }
+         statement(loop.loop);
+       }
+      else if (typeid(Engine::FlowControlStatement) == typeid(it))
+       {
+         const Engine::FlowControlStatement& flow = static_cast<const Engine::FlowControlStatement&>(it);
+         number(FLOW_CONTROL_STATEMENT);
+         token(it.token);
+         number(flow.type);
+         number(flow.target);
+         expression(flow.value);
+       }
+      else if (typeid(Engine::TailCall) == typeid(it))
+       {
+         number(TAIL_CALL);
+         token(it.token);
+         expression(static_cast<const Engine::TailCall&>(it).call);
+       }
+      else
+       {
+         throw CacheException(); // Library functions are built by ContextBuilder, and never parsed.
+       }
+    }
+
+   void CacheWriter::context (const Engine::FunctionContext& fun)
+    {
+      if (nullptr != fun.deferred.get())
+       {
+         throw CacheException(); // There is no body to save yet.
+       }
+      string(fun.name);
+      number(fun.nargs);
+      number(fun.nlocals);
+      number(fun.ncaptures);
+      names(fun.args);
+      names(fun.locals);
+      names(fun.captures);
+      names(fun.argNames);
+      names(fun.localNames);
+      names(fun.captureNames);
+      number(fun.pure ? 1U : 0U);
+      number(fun.calls.size());
+      for (size_t call : fun.calls)
+       {
+         number(call);
+       }
+      statement(fun.function);
+    }
+
+    /*
+      Reads back what CacheWriter wrote. Every read is checked, and anything out of place
+      throws, so that a damaged or foreign file is only ever a miss.
+    */
+   class CacheReader final
+    {
+   public:
+      CacheReader(const std::string& in) : nglobals(0U), current(nullptr), in(in), at(0U) { }
+
+      std::vector<Input::TokenHandle> tokens;
+      std::vector<std::shared_ptr<Engine::FunctionContext> > functions;
+      size_t nglobals; // How many globals there will be once the library is loaded.
+      const Engine::FunctionContext* current; // The function whose body is being read, or NULL for the library's own statements.
+
+      uint64_t number ()
+       {
+         uint64_t result = 0U;
+         for (unsigned int shift = 0U; shift < 64U; shift += 7U)
+          {
+            if (at >= in.size())
+             {
+               throw CacheException();
+             }
+            unsigned char next = static_cast<unsigned char>(in[at++]);
+            result |= static_cast<uint64_t>(next & 0x7FU) << shift;
+            if (0U == (next & 0x80U))
+             {
+               return result;
+             }
+          }
+         throw CacheException();
+       }
+
+      size_t count ()
+       {
+         uint64_t result = number();
+         if (result > (in.size() - at))
+          {
+            throw CacheException(); // Every element takes at least a byte.
+          }
+         return static_cast<size_t>(result);
+       }
+
+      bool flag ()
+       {
+         return 0U != number();
+       }
+
+      std::string string ()
+       {
+         size_t length = count();
+         std::string result = in.substr(at, length);
+         at += length;
+         return result;
+       }
+
+      Input::TokenHandle token ()
+       {
+         uint64_t index = number();
+         if (0U == index)
+          {
+            return Input::TokenHandle();
+          }
+         if (index > tokens.size())
+          {
+            throw CacheException();
+          }
+         return tokens[index - 1U];
+       }
+
+      std::shared_ptr<Engine::FunctionContext> function ()
+       {
+         uint64_t index = number();
+         if (index >= functions.size())
+          {
+            throw CacheException();
+          }
+         return functions[index];
+       }
+
+      void names (std::map<std::string, size_t>& value)
+       {
+         for (size_t i = count(); i > 0U; --i)
+          {
+            std::string name = string();
+            value.emplace(std::make_pair(name, number()));
+          }
+       }
+
+      void names (std::vector<std::string>& value)
+       {
+         for (size_t i = count(); i > 0U; --i)
+          {
+            value.emplace_back(string());
+          }
+       }
+
+      bool done () const
+       {
+         return at == in.size();
+       }
+
+      std::string rest () const
+       {
+         return in.substr(at);
+       }
+
+       // Where a variable lives must be inside what its frame or the global scope will have.
+       // Scope variables are checked when they are used, as the scope's size is only known then.
+      size_t slot (uint64_t kind, uint64_t location) const
+       {
+         uint64_t limit;
+         switch (kind)
+          {
+         case GLOBAL: limit = nglobals; break;
+         case SCOPE: return static_cast<size_t>(location);
+         case LOCAL: limit = (nullptr != current) ? current->nlocals : 0U; break;
+         case ARG: limit = (nullptr != current) ? current->nargs : 0U; break;
+         case CAPTURE: limit = (nullptr != current) ? current->ncaptures : 0U; break;
+         default: throw CacheException();
+          }
+         if (location >= limit)
+          {
+            throw CacheException();
+          }
+         return static_cast<size_t>(location);
+       }
+
+      std::shared_ptr<Types::ValueType> value (const Input::TokenHandle&);
+      std::shared_ptr<Engine::Getter> getter ();
+      std::shared_ptr<Engine::Setter> setter ();
+      std::shared_ptr<Engine::Expression> expression ();
+      std::shared_ptr<Engine::Statement> statement ();
+      void context (Engine::FunctionContext&);
+
+   private:
+      const std::string& in;
+      size_t at;
+    };
+
+   std::shared_ptr<Types::ValueType> CacheReader::value (const Input::TokenHandle& source)
+    {
+      switch (number())
+       {
+      case FLOAT_VALUE:
+         return Types::FloatValue::make(number());
+      case STRING_VALUE:
+       {
+         std::string text = string();
+          // The parser interns the names of members.
+         if ((Input::IDENTIFIER == source.lexeme()) && (text == source.text()))
+          {
+            return Types::StringValue::intern(text);
+          }
+         return std::make_shared<Types::StringValue>(text);
+       }
+      case NIL_VALUE:
+         return Types::NilValue::make();
+      case FUNCTION_VALUE:
+         return std::make_shared<Types::FunctionValue>(function(), std::vector<std::shared_ptr<Types::ValueType> >());
+      case EMPTY_ARRAY:
+         return Engine::ConstantsSingleton::getInstance().EMPTY_ARRAY;
+      case EMPTY_DICTIONARY:
+         return Engine::ConstantsSingleton::getInstance().EMPTY_DICTIONARY;
+       }
+      throw CacheException();
+    }
+
+   std::shared_ptr<Engine::Getter> CacheReader::getter ()
+    {
+      uint64_t kind = number();
+      size_t location = slot(kind, number());
+      switch (kind)
+       {
+      case GLOBAL: return std::make_shared<Engine::GlobalGetter>(location);
+      case SCOPE: return std::make_shared<Engine::ScopeGetter>(location);
+      case LOCAL: return std::make_shared<Engine::LocalGetter>(location);
+      case ARG: return std::make_shared<Engine::ArgGetter>(location);
+      case CAPTURE: return std::make_shared<Engine::CaptureGetter>(location);
+       }
+      throw CacheException();
+    }
+
+   std::shared_ptr<Engine::Setter> CacheReader::setter ()
+    {
+      uint64_t kind = number();
+      size_t location = slot(kind, number());
+      switch (kind)
+       {
+      case GLOBAL: return std::make_shared<Engine::GlobalSetter>(location);
+      case SCOPE: return std::make_shared<Engine::ScopeSetter>(location);
+      case LOCAL: return std::make_shared<Engine::LocalSetter>(location);
+      case ARG: return std::make_shared<Engine::ArgSetter>(location);
+      case CAPTURE: return std::make_shared<Engine::CaptureSetter>(location);
+       }
+      throw CacheException();
+    }
+
+#define BINARY(x,y) \
+   case y: \
+    { \
+      std::shared_ptr<Engine::Expression> lhs = expression(); \
+      std::shared_ptr<Engine::Expression> rhs = expression(); \
+      return std::make_shared<Engine::x>(source, lhs, rhs); \
+    }
+
+#define UNARY(x,y) \
+   case y: \
+      return std::make_shared<Engine::x>(source, expression());
+
+   std::shared_ptr<Engine::Expression> CacheReader::expression ()
+    {
+      uint64_t tag = number();
+      if (NO_EXPRESSION == tag)
+       {
+         return std::shared_ptr<Engine::Expression>();
+       }
+      Input::TokenHandle source = token();
+      switch (tag)
+       {
+      case CONSTANT:
+         return std::make_shared<Engine::Constant>(source, value(source));
+      case VARIABLE:
+         return std::make_shared<Engine::Variable>(source, getter());
+      BINARY(Plus, PLUS)
+      BINARY(Minus, MINUS)
+      BINARY(Multiply, MULTIPLY)
+      BINARY(Divide, DIVIDE)
+      BINARY(ShortAnd, SHORT_AND)
+      BINARY(ShortOr, SHORT_OR)
+      BINARY(Equals, EQUALS)
+      BINARY(NotEqual, NOT_EQUAL)
+      BINARY(Greater, GREATER)
+      BINARY(Less, LESS)
+      BINARY(GEQ, GEQ)
+      BINARY(LEQ, LEQ)
+      BINARY(DerefVar, DEREF_VAR)
+      UNARY(Not, NOT)
+      UNARY(Negate, NEGATE)
+      case FUNCTION_CALL:
+       {
+         std::shared_ptr<Engine::Expression> location = expression();
+         std::vector<std::shared_ptr<Engine::Expression> > args;
+         for (size_t i = count(); i > 0U; --i)
+          {
+            args.emplace_back(expression());
+          }
+         return std::make_shared<Engine::FunctionCall>(source, location, args);
+       }
+      case BUILD_FUNCTION:
+       {
+         std::shared_ptr<Engine::FunctionContext> prototype = function();
+         std::vector<std::shared_ptr<Engine::Expression> > captures;
+         for (size_t i = count(); i > 0U; --i)
+          {
+            captures.emplace_back(expression());
+          }
+         return std::make_shared<Engine::BuildFunction>(source, prototype, captures);
+       }
+      case TERNARY_OPERATION:
+       {
+         std::shared_ptr<Engine::Expression> condition = expression();
+         std::shared_ptr<Engine::Expression> thenCase = expression();
+         std::shared_ptr<Engine::Expression> elseCase = expression();
+         return std::make_shared<Engine::TernaryOperation>(source, condition, thenCase, elseCase);
+       }
+      case INVARIANT:
+       {
+         std::shared_ptr<Engine::Expression> expr = expression();
+         return std::make_shared<Engine::Invariant>(source, expr, slot(LOCAL, number()));
+       }
+       }
+      throw CacheException();
+    }
+
+#undef UNARY
+#undef BINARY
+
+   std::shared_ptr<Engine::Statement> CacheReader::statement ()
+    {
+      uint64_t tag = number();
+      if (NO_STATEMENT == tag)
+       {
+         return std::shared_ptr<Engine::Statement>();
+       }
+      Input::TokenHandle source = token();
+      switch (tag)
+       {
+      case NOP:
+         if (Input::TokenHandle() == source)
+          {
+            return Engine::ConstantsSingleton::getInstance().ONE_TRUE_NOP; // The parser checks for this one.
+          }
+         return std::make_shared<Engine::NOP>(source);
+      case EXPR:
+         return std::make_shared<Engine::Expr>(source, expression());
+      case STATEMENT_SEQ:
+       {
+         std::vector<std::shared_ptr<Engine::Statement> > statements;
+         for (size_t i = count(); i > 0U; --i)
+          {
+            statements.emplace_back(statement());
+          }
+         return std::make_shared<Engine::StatementSeq>(source, statements);
+       }
+      case ASSIGNMENT:
+       {
+         std::shared_ptr<Engine::Getter> get = getter();
+         std::shared_ptr<Engine::Setter> set = setter();
+         std::shared_ptr<Engine::RecAssignState> index, last;
+         for (size_t i = count(); i > 0U; --i)
+          {
+            Input::TokenHandle indexToken = token();
+            std::shared_ptr<Engine::RecAssignState> next = std::make_shared<Engine::RecAssignState>(indexToken, expression());
+            if (nullptr == last.get())
+             {
+               index = next;
+             }
+            else
+             {
+               last->next = next;
+             }
+            last = next;
+          }
+         std::shared_ptr<Engine::Expression> rhs = expression();
+         return std::make_shared<Engine::Assignment>(source, get, set, index, rhs);
+       }
+      case IF_STATEMENT:
+       {
+         std::shared_ptr<Engine::Expression> condition = expression();
+         std::shared_ptr<Engine::Statement> thenSeq = statement();
+         std::shared_ptr<Engine::Statement> elseSeq = statement();
+         return std::make_shared<Engine::IfStatement>(source, condition, thenSeq, elseSeq);
+       }
+      case WHILE_STATEMENT:
+       {
+         std::shared_ptr<Engine::Expression> condition = expression();
+         std::shared_ptr<Engine::Statement> seq = statement();
+         return std::make_shared<Engine::WhileStatement>(source, condition, seq, static_cast<size_t>(number()));
+       }
+      case SELECT_STATEMENT:
+       {
+         std::shared_ptr<Engine::Expression> control = expression();
+         std::vector<std::shared_ptr<Engine::CaseContainer> > cases;
+         for (size_t i = count(); i > 0U; --i)
+          {
+            Input::TokenHandle caseToken = token();
+            bool breaking = flag();
+            uint64_t type = number();
+            if (type > Engine::CaseContainer::BELOW)
+             {
+               throw CacheException();
+             }
+            std::shared_ptr<Engine::Expression> condition = expression();
+            std::shared_ptr<Engine::Expression> lower = expression();
+            std::shared_ptr<Engine::Statement> seq = statement();
+            cases.emplace_back(std::make_shared<Engine::CaseContainer>(caseToken, breaking, static_cast<Engine::CaseContainer::CaseType>(type), condition, lower, seq));
+          }
+         std::shared_ptr<Engine::SelectStatement> select = std::make_shared<Engine::SelectStatement>(source, control, cases);
+         if (true == flag())
+          {
+            select->table = Engine::SelectTable::build(select->cases); // Cheaper to build again than to save.
+          }
+         return select;
+       }
+      case FOR_STATEMENT:
+       {
+         std::shared_ptr<Engine::Getter> get = getter();
+         std::shared_ptr<Engine::Setter> set = setter();
+         std::shared_ptr<Engine::Expression> lower = expression();
+         bool to = flag();
+         std::shared_ptr<Engine::Expression> upper = expression();
+         std::shared_ptr<Engine::Expression> step = expression();
+         std::shared_ptr<Engine::Statement> seq = statement();
+         return std::make_shared<Engine::ForStatement>(source, get, set, lower, to, upper, step, seq, static_cast<size_t>(number()));
+       }
+      case INVARIANT_LOOP:
+       {
+         std::vector<size_t> locations;
+         for (size_t i = count(); i > 0U; --i)
+          {
+            locations.push_back(slot(LOCAL, number()));
+          }
+         return std::make_shared<Engine::InvariantLoop>(source, locations, statement());
+       }
+      case FLOW_CONTROL_STATEMENT:
+       {
+         uint64_t type = number();
+         if (type > Engine::FlowControl::CONTINUE)
+          {
+            throw CacheException();
+          }
+         size_t target = static_cast<size_t>(number());
+         return std::make_shared<Engine::FlowControlStatement>(source, static_cast<Engine::FlowControl::Type>(type), target, expression());
+       }
+      case TAIL_CALL:
+       {
+         std::shared_ptr<Engine::Expression> call = expression();
+         if ((nullptr == call.get()) || (typeid(Engine::FunctionCall) != typeid(*call)))
+          {
+            throw CacheException();
+          }
+         return std::make_shared<Engine::TailCall>(source, std::static_pointer_cast<Engine::FunctionCall>(call));
+       }
+       }
+      throw CacheException();
+    }
+
+   void CacheReader::context (Engine::FunctionContext& fun)
+    {
+      fun.name = string();
+      fun.nargs = static_cast<size_t>(number());
+      fun.nlocals = static_cast<size_t>(number());
+      fun.ncaptures = static_cast<size_t>(number());
+      names(fun.args);
+      names(fun.locals);
+      names(fun.captures);
+      names(fun.argNames);
+      names(fun.localNames);
+      names(fun.captureNames);
+      fun.pure = flag();
+      for (size_t i = count(); i > 0U; --i)
+       {
+         fun.calls.push_back(slot(GLOBAL, number()));
+       }
+      current = &fun;
+      fun.function = statement();
+      current = nullptr;
+    }
+
+    // FNV-1a: it only needs to be the same from one run to the next.
+   static void hash (uint64_t& seed, const std::string& text)
+    {
+      for (unsigned char c : text)
+       {
+         seed ^= c;
+         seed *= 0x100000001B3ULL;
+       }
+      seed ^= 0xFFU; // Keep "ab" + "c" apart from "a" + "bc".
+      seed *= 0x100000001B3ULL;
+    }
+
+   std::string LibraryCache::key (const std::string& text, const std::string& sourceName, const Engine::Scope& global)
+    {
+      uint64_t seed = 0xCBF29CE484222325ULL;
+      hash(seed, std::to_string(VERSION));
+      hash(seed, sourceName);
+      hash(seed, text);
+      for (const std::string& name : global.names)
+       {
+         hash(seed, name);
+       }
+      char result [17];
+      std::snprintf(result, sizeof(result), "%016llx", static_cast<unsigned long long>(seed));
+      return result;
+    }
+
+   std::string LibraryCache::save (const std::string& key, const std::shared_ptr<Engine::Statement>& tree, const Engine::Scope& global, size_t firstGlobal)
+    {
+      CacheWriter body;
+      try
+       {
+         body.statement(tree);
+          // Writing a function may find more.
+         for (size_t i = 0U; i < body.functions.size(); ++i)
+          {
+            body.context(*body.functions[i]);
+          }
+       }
+      catch (const CacheException&)
+       {
+         return std::string();
+       }
+
+      CacheWriter head;
+      head.number(firstGlobal);
+      head.number(global.names.size() - firstGlobal);
+      for (size_t i = firstGlobal; i < global.names.size(); ++i)
+       {
+         head.string(global.names[i]);
+       }
+      head.number(body.tokens.size());
+      for (const Input::Token& token : body.tokens)
+       {
+         head.number(token.lexeme);
+         head.string(token.text);
+         head.string(token.sourceFile);
+         head.number(token.lineNumber);
+         head.number(token.lineLocation);
+       }
+      head.number(body.functions.size());
+
+       // A checksum of the rest, so that a file that was damaged on disk is a miss, and never read.
+      const std::string rest = head.out + body.out;
+      uint64_t checksum = 0xCBF29CE484222325ULL;
+      hash(checksum, rest);
+      CacheWriter result;
+      result.string(MAGIC);
+      result.number(VERSION);
+      result.string(key);
+      result.number(checksum);
+      return result.out + rest;
+    }
+
+   std::shared_ptr<Engine::Statement> LibraryCache::load (const std::string& key, const std::string& data, SymbolTable& table, Engine::Scope& global)
+    {
+      std::shared_ptr<Engine::Statement> result;
+      std::vector<std::string> added;
+      CacheReader in (data);
+      try
+       {
+         if ((MAGIC != in.string()) || (VERSION != in.number()) || (key != in.string()))
+          {
+            return result;
+          }
+         uint64_t checksum = 0xCBF29CE484222325ULL;
+         const uint64_t expected = in.number();
+         hash(checksum, in.rest());
+         if ((expected != checksum) || (global.names.size() != in.number()))
+          {
+            return result;
+          }
+         in.names(added);
+         for (const std::string& name : added)
+          {
+            if (global.var.end() != global.var.find(name))
+             {
+               return result;
+             }
+          }
+         in.nglobals = global.names.size() + added.size();
+         for (size_t i = in.count(); i > 0U; --i)
+          {
+            uint64_t lexeme = in.number();
+            if (lexeme > Input::NOT)
+             {
+               throw CacheException();
+             }
+            std::string text = in.string();
+            std::string sourceFile = in.string();
+            size_t lineNumber = static_cast<size_t>(in.number());
+            size_t lineLocation = static_cast<size_t>(in.number());
+            in.tokens.emplace_back(Input::Token(static_cast<Input::Lexeme>(lexeme), text, sourceFile, lineNumber, lineLocation));
+          }
+         for (size_t i = in.count(); i > 0U; --i)
+          {
+            in.functions.emplace_back(std::make_shared<Engine::FunctionContext>());
+          }
+         result = in.statement();
+         for (const std::shared_ptr<Engine::FunctionContext>& fun : in.functions)
+          {
+            in.context(*fun);
+          }
+         if (false == in.done())
+          {
+            return std::shared_ptr<Engine::Statement>();
+          }
+       }
+      catch (const CacheException&)
+       {
+         return std::shared_ptr<Engine::Statement>();
+       }
+
+      for (const std::shared_ptr<Engine::FunctionContext>& fun : in.functions)
+       {
+         CycleCollector::track(fun);
+       }
+      for (const std::string& name : added)
+       {
+         table.addVariable(name);
+       }
+      return result;
+    }
+
+   static std::string tempName (const std::string& fileName)
+    {
+      static std::atomic<unsigned int> counter (0U);
+      static const unsigned int process = std::random_device()() ^
+         static_cast<unsigned int>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+      std::stringstream str;
+      str << fileName << "." << std::hex << process << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << "." << counter++ << ".tmp";
+      return str.str();
+    }
+
+   std::shared_ptr<Engine::Statement> LibraryCache::ParseFunctions (const std::string& directory, const std::string& text, const std::string& sourceName,
+      SymbolTable& table, Engine::Scope& global, Engine::Logger& logger)
+    {
+      const std::string name = key(text, sourceName, global);
+      const std::string fileName = directory + "/" + name + ".bwc";
+
+      std::ifstream cached (fileName, std::ios::binary);
+      if (true == cached.good())
+       {
+         std::stringstream data;
+         data << cached.rdbuf();
+         std::shared_ptr<Engine::Statement> result = load(name, data.str(), table, global);
+         if (nullptr != result.get())
+          {
+            return result;
+          }
+       }
+
+      size_t firstGlobal = global.names.size();
+      Input::StringInput input (text);
+      Input::Lexer lexer (input, sourceName);
+      std::shared_ptr<Engine::Statement> result = Parser::ParseFunctions(lexer, table, logger);
+      if (nullptr != result.get())
+       {
+         std::string data = save(name, result, global, firstGlobal);
+         if (false == data.empty())
+          {
+             // Write it aside and move it into place, so that a program reading the cache never sees half a file.
+             // The name of the file aside is this writer's own, as other programs may be writing the same library.
+            const std::string temp = tempName(fileName);
+            std::ofstream out (temp, std::ios::binary | std::ios::trunc);
+            out.write(data.data(), data.size());
+            out.close();
+            if ((false == out.good()) || (0 != std::rename(temp.c_str(), fileName.c_str())))
+             {
+               (void) std::remove(temp.c_str());
+             }
+          }
+       }
+      return result;
+    }
+
+ } // namespace Parser
+
+ } // namespace Backwards
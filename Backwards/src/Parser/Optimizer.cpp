@@ -0,0 +1,467 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Parser/Optimizer.h"
+#include "Backwards/Parser/SymbolTable.h"
+#include "Backwards/Parser/TreeWalk.h"
+
+#include "Backwards/Engine/Expression.h"
+#include "Backwards/Engine/Statement.h"
+#include "Backwards/Engine/FunctionContext.h"
+#include "Backwards/Engine/RoundingMode.h"
+#include "Backwards/Engine/ConstantsSingleton.h"
+#include "Backwards/Engine/SelectTable.h"
+
+#include "Backwards/Types/FloatValue.h"
+#include "Backwards/Types/StringValue.h"
+#include "Backwards/Types/FunctionValue.h"
+
+namespace Backwards
+ {
+
+namespace Parser
+ {
+
+   static bool isConstant (const std::shared_ptr<Engine::Expression>& expr)
+    {
+      return typeid(Engine::Constant) == typeid(*expr);
+    }
+
+   static bool containsCall (Engine::Expression& expr)
+    {
+      bool result = typeid(Engine::FunctionCall) == typeid(expr);
+      forEachChild(expr, [&result](std::shared_ptr<Engine::Expression>& child) { result |= containsCall(*child); });
+      return result;
+    }
+
+   static bool sameValue (const std::shared_ptr<Types::ValueType>& lhs, const std::shared_ptr<Types::ValueType>& rhs)
+    {
+      if ((Types::FLOAT == lhs->getType()) && (Types::FLOAT == rhs->getType()))
+       {
+         return static_cast<const Types::FloatValue&>(*lhs).value == static_cast<const Types::FloatValue&>(*rhs).value;
+       }
+      if ((Types::STRING == lhs->getType()) && (Types::STRING == rhs->getType()))
+       {
+         return static_cast<const Types::StringValue&>(*lhs).value == static_cast<const Types::StringValue&>(*rhs).value;
+       }
+      return false;
+    }
+
+    // Evaluates an expression of constants, and returns a Constant if it can be folded.
+    // Comparisons, Not, and Negate don't round, so they are evaluated once and never touch the rounding mode.
+    // Arithmetic is evaluated in every rounding mode, and folded if they all agree. That takes the library's
+    // one mode away from everyone else for a moment, so it is only done when sweep is set.
+   static std::shared_ptr<Engine::Expression> evaluateConstant (const std::shared_ptr<Engine::Expression>& expr, bool sweep)
+    {
+      const bool rounds = (typeid(Engine::Plus) == typeid(*expr)) || (typeid(Engine::Minus) == typeid(*expr)) ||
+         (typeid(Engine::Multiply) == typeid(*expr)) || (typeid(Engine::Divide) == typeid(*expr));
+      if ((true == rounds) && (false == sweep))
+       {
+         return expr;
+       }
+
+      Engine::CallingContext context;
+      std::shared_ptr<Types::ValueType> result;
+      if (false == rounds)
+       {
+         try
+          {
+            result = expr->evaluate(context);
+          }
+         catch (const Types::TypedOperationException&)
+          {
+          }
+       }
+      else
+       {
+         Engine::RoundingMode::Sweep turn;
+         int mode = dm_fegetround();
+         try
+          {
+            for (int round = DM_FE_TONEAREST; round <= DM_FE_FROMZERO; ++round)
+             {
+               (void) dm_fesetround(round);
+               std::shared_ptr<Types::ValueType> temp = expr->evaluate(context);
+               if (nullptr == result.get())
+                {
+                  result = temp;
+                }
+               else if (false == sameValue(result, temp))
+                {
+                  result.reset();
+                  break;
+                }
+             }
+          }
+         catch (const Types::TypedOperationException&)
+          {
+            result.reset();
+          }
+         (void) dm_fesetround(mode);
+       }
+
+      if (nullptr == result.get())
+       {
+         return expr;
+       }
+      return std::make_shared<Engine::Constant>(expr->token, result);
+    }
+
+    // Returns 1 if the expression is a constant true, 0 if it is a constant false, and -1 if we can't tell.
+   static int constantCondition (const std::shared_ptr<Engine::Expression>& expr)
+    {
+      if (true == isConstant(expr))
+       {
+         try
+          {
+            return (true == static_cast<const Engine::Constant&>(*expr).value->logical()) ? 1 : 0;
+          }
+         catch (const Types::TypedOperationException&)
+          {
+          }
+       }
+      return -1;
+    }
+
+#define FOLDABLE(x) (typeid(Engine::x) == typeid(*expr))
+
+   std::shared_ptr<Engine::Expression> Optimizer::fold (const std::shared_ptr<Engine::Expression>& expr, bool sweep)
+    {
+      forEachChild(*expr, [sweep](std::shared_ptr<Engine::Expression>& child) { child = fold(child, sweep); });
+
+      if (FOLDABLE(Plus) || FOLDABLE(Minus) || FOLDABLE(Multiply) || FOLDABLE(Divide) ||
+         FOLDABLE(Equals) || FOLDABLE(NotEqual) || FOLDABLE(Greater) || FOLDABLE(Less) || FOLDABLE(GEQ) || FOLDABLE(LEQ) ||
+         FOLDABLE(Not) || FOLDABLE(Negate))
+       {
+         bool allConstant = true;
+         forEachChild(*expr, [&allConstant](std::shared_ptr<Engine::Expression>& child) { allConstant &= isConstant(child); });
+         if (true == allConstant)
+          {
+            return evaluateConstant(expr, sweep);
+          }
+       }
+      else if (FOLDABLE(ShortAnd) || FOLDABLE(ShortOr))
+       {
+          // Short-circuit: if the left side decides it, the right side is never evaluated.
+         std::shared_ptr<Engine::Expression> lhs = FOLDABLE(ShortAnd) ? static_cast<Engine::ShortAnd&>(*expr).lhs : static_cast<Engine::ShortOr&>(*expr).lhs;
+         std::shared_ptr<Engine::Expression> rhs = FOLDABLE(ShortAnd) ? static_cast<Engine::ShortAnd&>(*expr).rhs : static_cast<Engine::ShortOr&>(*expr).rhs;
+         int decides = FOLDABLE(ShortAnd) ? 0 : 1;
+         if (decides == constantCondition(lhs))
+          {
+            return std::make_shared<Engine::Constant>(expr->token, (1 == decides) ?
+               Engine::ConstantsSingleton::getInstance().FLOAT_ONE :
+               Engine::ConstantsSingleton::getInstance().FLOAT_ZERO);
+          }
+         if ((true == isConstant(lhs)) && (true == isConstant(rhs)))
+          {
+            return evaluateConstant(expr, sweep);
+          }
+       }
+      else if (FOLDABLE(TernaryOperation))
+       {
+         Engine::TernaryOperation& op = static_cast<Engine::TernaryOperation&>(*expr);
+         switch (constantCondition(op.condition))
+          {
+         case 1:
+            return op.thenCase;
+         case 0:
+            return op.elseCase;
+          }
+       }
+      return expr;
+    }
+
+#undef FOLDABLE
+
+
+   Optimizer::Optimizer(Engine::FunctionContext& function, const GetterSetter& gs, bool sweep) : function(function), gs(gs), sweep(sweep)
+    {
+    }
+
+   void Optimizer::optimize()
+    {
+      if (nullptr != function.function.get())
+       {
+         function.function = statement(function.function);
+         purity();
+
+          // Every return leaves the function, so a return of a call is always in tail position.
+         forEachStatement(function.function, [](std::shared_ptr<Engine::Statement>& stmt)
+          {
+            if (typeid(Engine::FlowControlStatement) == typeid(*stmt))
+             {
+               Engine::FlowControlStatement& ret = static_cast<Engine::FlowControlStatement&>(*stmt);
+               if ((Engine::FlowControl::RETURN == ret.type) && (nullptr != ret.value.get()) && (typeid(Engine::FunctionCall) == typeid(*ret.value)))
+                {
+                  stmt = std::make_shared<Engine::TailCall>(ret.token, std::static_pointer_cast<Engine::FunctionCall>(ret.value));
+                }
+             }
+          });
+       }
+    }
+
+   std::shared_ptr<Engine::Statement> Optimizer::statement (const std::shared_ptr<Engine::Statement>& stmt)
+    {
+      forEachChild(*stmt, [this](std::shared_ptr<Engine::Statement>& child) { child = statement(child); });
+      forEachExpression(*stmt, [this](std::shared_ptr<Engine::Expression>& expr) { expr = fold(expr, sweep); });
+
+      if (typeid(Engine::IfStatement) == typeid(*stmt))
+       {
+         Engine::IfStatement& branch = static_cast<Engine::IfStatement&>(*stmt);
+         switch (constantCondition(branch.condition))
+          {
+         case 1:
+            return branch.thenSeq;
+         case 0:
+            return branch.elseSeq;
+          }
+       }
+      else if (typeid(Engine::WhileStatement) == typeid(*stmt))
+       {
+         if (0 == constantCondition(static_cast<Engine::WhileStatement&>(*stmt).condition))
+          {
+            return Engine::ConstantsSingleton::getInstance().ONE_TRUE_NOP;
+          }
+         return hoist(stmt);
+       }
+      else if (typeid(Engine::ForStatement) == typeid(*stmt))
+       {
+         return hoist(stmt);
+       }
+      else if (typeid(Engine::SelectStatement) == typeid(*stmt))
+       {
+         Engine::SelectStatement& select = static_cast<Engine::SelectStatement&>(*stmt);
+         select.table = Engine::SelectTable::build(select.cases);
+       }
+      return stmt;
+    }
+
+   std::shared_ptr<Engine::Statement> Optimizer::hoist (const std::shared_ptr<Engine::Statement>& loop)
+    {
+      std::set<const Engine::Setter*> writes;
+      bool calls = false;
+      std::shared_ptr<Engine::Statement> body;
+
+      std::shared_ptr<Engine::Statement> temp = loop;
+      forEachStatement(temp, [&writes, &calls](std::shared_ptr<Engine::Statement>& stmt)
+       {
+         if (typeid(Engine::Assignment) == typeid(*stmt))
+          {
+            writes.insert(static_cast<Engine::Assignment&>(*stmt).setter.get());
+          }
+         else if (typeid(Engine::ForStatement) == typeid(*stmt))
+          {
+            writes.insert(static_cast<Engine::ForStatement&>(*stmt).setter.get());
+          }
+         forEachExpression(*stmt, [&calls](std::shared_ptr<Engine::Expression>& expr) { calls |= containsCall(*expr); });
+       });
+
+      std::vector<size_t> locations;
+      if (typeid(Engine::WhileStatement) == typeid(*loop))
+       {
+         lift(static_cast<Engine::WhileStatement&>(*loop).condition, writes, calls, locations);
+         body = static_cast<Engine::WhileStatement&>(*loop).seq;
+       }
+      else
+       {
+         body = static_cast<Engine::ForStatement&>(*loop).seq;
+       }
+      forEachStatement(body, [this, &writes, calls, &locations](std::shared_ptr<Engine::Statement>& stmt)
+       {
+         forEachExpression(*stmt, [this, &writes, calls, &locations](std::shared_ptr<Engine::Expression>& expr) { lift(expr, writes, calls, locations); });
+       });
+
+      if (true == locations.empty())
+       {
+         return loop;
+       }
+      return std::make_shared<Engine::InvariantLoop>(loop->token, locations, loop);
+    }
+
+   static size_t findGetter (const std::vector<std::shared_ptr<Engine::Getter> >& getters, const Engine::Getter* getter)
+    {
+      for (size_t i = 0U; i < getters.size(); ++i)
+       {
+         if (getters[i].get() == getter)
+          {
+            return i;
+          }
+       }
+      return getters.size();
+    }
+
+    /*
+      Something is invariant in a loop if it is a pure operation on constants and on
+      locals, arguments, and captures that the loop doesn't assign to.
+      Globals and scope variables can be changed by any function, so they are never invariant.
+      Arithmetic depends on the rounding mode, which a function call could change.
+    */
+   bool Optimizer::isInvariant (Engine::Expression& expr, const std::set<const Engine::Setter*>& writes, bool calls) const
+    {
+      if (typeid(Engine::Constant) == typeid(expr))
+       {
+         return true;
+       }
+      if (typeid(Engine::Variable) == typeid(expr))
+       {
+         const Engine::Getter* getter = static_cast<const Engine::Variable&>(expr).getter.get();
+         size_t location;
+         if (gs.localsGetters.size() != (location = findGetter(gs.localsGetters, getter)))
+          {
+            return writes.end() == writes.find(gs.localsSetters[location].get());
+          }
+         if (gs.argsGetters.size() != (location = findGetter(gs.argsGetters, getter)))
+          {
+            return writes.end() == writes.find(gs.argsSetters[location].get());
+          }
+         if (gs.capturesGetters.size() != (location = findGetter(gs.capturesGetters, getter)))
+          {
+            return writes.end() == writes.find(gs.capturesSetters[location].get());
+          }
+         return false;
+       }
+      if ((typeid(Engine::Plus) == typeid(expr)) || (typeid(Engine::Minus) == typeid(expr)) ||
+         (typeid(Engine::Multiply) == typeid(expr)) || (typeid(Engine::Divide) == typeid(expr)))
+       {
+         if (true == calls)
+          {
+            return false;
+          }
+       }
+      else if (!((typeid(Engine::Negate) == typeid(expr)) || (typeid(Engine::Not) == typeid(expr)) ||
+         (typeid(Engine::ShortAnd) == typeid(expr)) || (typeid(Engine::ShortOr) == typeid(expr)) ||
+         (typeid(Engine::Equals) == typeid(expr)) || (typeid(Engine::NotEqual) == typeid(expr)) ||
+         (typeid(Engine::Greater) == typeid(expr)) || (typeid(Engine::Less) == typeid(expr)) ||
+         (typeid(Engine::GEQ) == typeid(expr)) || (typeid(Engine::LEQ) == typeid(expr)) ||
+         (typeid(Engine::DerefVar) == typeid(expr)) || (typeid(Engine::TernaryOperation) == typeid(expr))))
+       {
+         return false;
+       }
+      bool result = true;
+      forEachChild(expr, [this, &result, &writes, calls](std::shared_ptr<Engine::Expression>& child)
+         { result &= isInvariant(*child, writes, calls); });
+      return result;
+    }
+
+   void Optimizer::lift (std::shared_ptr<Engine::Expression>& expr, const std::set<const Engine::Setter*>& writes, bool calls, std::vector<size_t>& locations)
+    {
+      if (typeid(Engine::Invariant) == typeid(*expr)) // Already hoisted out of an inner loop.
+       {
+         return;
+       }
+      if (true == isInvariant(*expr, writes, calls))
+       {
+         if ((typeid(Engine::Constant) != typeid(*expr)) && (typeid(Engine::Variable) != typeid(*expr)))
+          {
+            locations.push_back(function.nlocals);
+            expr = std::make_shared<Engine::Invariant>(expr->token, expr, function.nlocals);
+            ++function.nlocals;
+          }
+         return;
+       }
+      forEachChild(*expr, [this, &writes, calls, &locations](std::shared_ptr<Engine::Expression>& child) { lift(child, writes, calls, locations); });
+    }
+
+    /*
+      A function is pure if the only things it reads or writes are its own arguments, locals, and captures,
+      so that the same arguments always give the same answer.
+      The one thing it may take from the global scope is a function to call. That global may be
+      assigned another function later, so we only write down where it is, and the caller checks it.
+      A function may also call itself, which is a Constant, as it isn't a global yet.
+    */
+   bool Optimizer::isPure (Engine::Expression& expr)
+    {
+      if (typeid(Engine::Variable) == typeid(expr))
+       {
+         const Engine::Getter& getter = *static_cast<const Engine::Variable&>(expr).getter;
+         return (typeid(Engine::GlobalGetter) != typeid(getter)) && (typeid(Engine::ScopeGetter) != typeid(getter));
+       }
+      bool result = true;
+      if (typeid(Engine::FunctionCall) == typeid(expr))
+       {
+         Engine::FunctionCall& call = static_cast<Engine::FunctionCall&>(expr);
+         result = isPureCallee(*call.location);
+         for (std::shared_ptr<Engine::Expression>& arg : call.args)
+          {
+            result &= isPure(*arg);
+          }
+         return result;
+       }
+      forEachChild(expr, [this, &result](std::shared_ptr<Engine::Expression>& child) { result &= isPure(*child); });
+      return result;
+    }
+
+   bool Optimizer::isPureCallee (Engine::Expression& location)
+    {
+      if (typeid(Engine::Variable) == typeid(location))
+       {
+         size_t global = findGetter(gs.globalGetters, static_cast<const Engine::Variable&>(location).getter.get());
+         if (gs.globalGetters.size() != global)
+          {
+            function.calls.push_back(global);
+            return true;
+          }
+       }
+      else if (typeid(Engine::Constant) == typeid(location))
+       {
+         const std::shared_ptr<Types::ValueType>& value = static_cast<const Engine::Constant&>(location).value;
+         return (Types::FUNCTION == value->getType()) && (static_cast<const Types::FunctionValue&>(*value).value.get() == &function);
+       }
+      return false;
+    }
+
+   void Optimizer::purity ()
+    {
+      bool result = true;
+      function.calls.clear();
+      forEachStatement(function.function, [this, &result](std::shared_ptr<Engine::Statement>& stmt)
+       {
+         const Engine::Setter* setter = nullptr;
+         if (typeid(Engine::Assignment) == typeid(*stmt))
+          {
+            setter = static_cast<Engine::Assignment&>(*stmt).setter.get();
+          }
+         else if (typeid(Engine::ForStatement) == typeid(*stmt))
+          {
+            setter = static_cast<Engine::ForStatement&>(*stmt).setter.get();
+          }
+         if ((nullptr != setter) && ((typeid(Engine::GlobalSetter) == typeid(*setter)) || (typeid(Engine::ScopeSetter) == typeid(*setter))))
+          {
+            result = false;
+          }
+         forEachExpression(*stmt, [this, &result](std::shared_ptr<Engine::Expression>& expr) { result &= isPure(*expr); });
+       });
+      function.pure = result;
+    }
+
+ } // namespace Parser
+
+ } // namespace Backwards
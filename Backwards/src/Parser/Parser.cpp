@@ -30,11 +30,16 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "Backwards/Parser/Parser.h"
+#include "Backwards/Parser/Optimizer.h"
+#include "Backwards/Parser/LazyFunction.h"
+
+#include "Backwards/Input/StringInput.h"
 
 #include "Backwards/Engine/Expression.h"
 #include "Backwards/Engine/FunctionContext.h"
 #include "Backwards/Engine/Statement.h"
 #include "Backwards/Engine/Logger.h"
+#include "Backwards/Engine/RoundingMode.h"
 #include "Backwards/Parser/SymbolTable.h"
 
 #include "Backwards/Types/FloatValue.h"
@@ -288,7 +293,7 @@ namespace Parser
           {
             Input::Token memberToken = src.peekNextToken();
             expect(src, Input::IDENTIFIER, "Identifier");
-            rhs = std::make_shared<Engine::Constant>(memberToken, std::make_shared<Types::StringValue>(memberToken.text));
+            rhs = std::make_shared<Engine::Constant>(memberToken, Types::StringValue::intern(memberToken.text));
           }
          else
           {
@@ -431,11 +436,11 @@ namespace Parser
 
             if (true == captures.empty())
              {
-               ret = std::make_shared<Engine::Constant>(buildToken, std::make_shared<Types::FunctionValue>(std::vector<std::shared_ptr<Types::ValueType> >(), table.activeFunctions[buildToken.text]));
+               ret = std::make_shared<Engine::Constant>(buildToken, std::make_shared<Types::FunctionValue>(table.activeFunctions[buildToken.text].lock(), std::vector<std::shared_ptr<Types::ValueType> >()));
              }
             else
              {
-               ret = std::make_shared<Engine::BuildFunction>(buildToken, captures, table.activeFunctions[buildToken.text]);
+               ret = std::make_shared<Engine::BuildFunction>(buildToken, table.activeFunctions[buildToken.text].lock(), captures);
              }
           }
             break;
@@ -544,14 +549,27 @@ namespace Parser
                recoverStatement(src);
              }
 
-            std::shared_ptr<Engine::Statement> block = innerStatementSeq(src, table, logger);
+            std::shared_ptr<Engine::Statement> block;
+            if ((nullptr != table.lazySource.get()) && (false == badWrong))
+             {
+               deferBody(src, table);
+             }
+            else
+             {
+               block = innerStatementSeq(src, table, logger);
 
-            expect(src, Input::END, "end");
+               expect(src, Input::END, "end");
+             }
 
-            if ((nullptr != block.get()) && (false == badWrong))
+            if (((nullptr != block.get()) || (nullptr != table.getContext()->deferred.get())) && (false == badWrong))
              {
                table.getContext()->function = block;
                table.getContext()->nlocals = table.getContext()->locals.size();
+               if (nullptr != block.get())
+                {
+                   // A function made by Eval is parsed mid-evaluation: leave its arithmetic for run time.
+                  Optimizer(*table.getContext(), table.getGetterSetter(), false == Engine::RoundingMode::evaluating()).optimize();
+                }
                 // Nota bene : we are being very loosey-goosey with the functions.
                table.activeFunctions.erase(table.getContext()->name);
                if (true == captures.empty())
@@ -581,7 +599,7 @@ namespace Parser
        {
          Input::Token buildToken = src.getNextToken();
 
-         ret = std::make_shared<Engine::Constant>(buildToken, std::make_shared<Types::FloatValue>(dm_double_fromstring(buildToken.text.c_str())));
+         ret = std::make_shared<Engine::Constant>(buildToken, Types::FloatValue::make(dm_double_fromstring(buildToken.text.c_str())));
        }
          break;
       case Input::STRING:
@@ -742,6 +760,94 @@ namespace Parser
       return std::shared_ptr<Engine::Statement>();
     }
 
+   std::shared_ptr<Engine::Statement> Parser::ParseFunctionsLazily (const std::string& text, const std::string& sourceName,
+      SymbolTable& table, Engine::Scope& global, Engine::Logger& logger)
+    {
+      std::shared_ptr<LazySource> source = std::make_shared<LazySource>(text, sourceName, global);
+      Input::StringInput input (source->text);
+      Input::Lexer lexer (input, sourceName);
+      std::shared_ptr<Engine::Statement> result;
+      table.lazySource = source;
+      try
+       {
+         result = ParseFunctions(lexer, table, logger);
+       }
+      catch (...)
+       {
+         table.lazySource.reset();
+         throw;
+       }
+      table.lazySource.reset();
+       // No body can be parsed before this returns, so none misses the snapshot.
+      source->snapshot();
+      return result;
+    }
+
+   std::shared_ptr<Engine::Statement> Parser::ParseFunctionBody (Input::Lexer& src, SymbolTable& table, Engine::Logger& logger)
+    {
+      std::shared_ptr<Engine::Statement> block;
+      try
+       {
+         block = innerStatementSeq(src, table, logger);
+
+         expect(src, Input::END, "end");
+         expect(src, Input::END_OF_FILE, "End of Input");
+       }
+      catch (const ParserException& e)
+       {
+         logger.log(e.what());
+         block = std::shared_ptr<Engine::Statement>();
+       }
+      if (nullptr != block.get())
+       {
+         table.getContext()->function = block;
+         table.getContext()->nlocals = table.getContext()->locals.size();
+          // Lazy functions are parsed mid-recalc, while other threads evaluate: never sweep the rounding mode here.
+         Optimizer(*table.getContext(), table.getGetterSetter(), false).optimize();
+         block = table.getContext()->function;
+       }
+      return block;
+    }
+
+    /*
+      Skip to the "end" that closes the function body, keeping where the body is so that it can be parsed later.
+      Every construct that opens a block closes it with one "end", however many arms it has,
+      so it is enough to count them.
+    */
+   void Parser::deferBody (Input::Lexer& src, SymbolTable& table)
+    {
+      Input::Token first = src.peekNextToken();
+      size_t depth = 1U;
+      for (;;)
+       {
+         switch (src.peekNextToken().lexeme)
+          {
+         case Input::FUNCTION:
+         case Input::IF:
+         case Input::WHILE:
+         case Input::SELECT:
+         case Input::FOR:
+            ++depth;
+            break;
+         case Input::END:
+            --depth;
+            break;
+         case Input::END_OF_FILE:
+            expect(src, Input::END, "end");
+            break;
+         default:
+            break;
+          }
+         if (0U == depth)
+          {
+            break;
+          }
+         src.getNextToken();
+       }
+      Input::Token last = src.getNextToken();
+      table.getContext()->deferred = std::make_shared<LazyFunction>(table.lazySource, first, last, table.getContext()->name);
+    }
+
    std::shared_ptr<Engine::Statement> Parser::Parse (Input::Lexer& src, SymbolTable& table, Engine::Logger& logger)
     {
       return outerStatementSeq(src, table, logger); // Currently, outerStatementSeq will never throw an exception.
@@ -823,7 +929,7 @@ namespace Parser
                 {
                   Input::Token memberToken = src.peekNextToken();
                   expect(src, Input::IDENTIFIER, "Identifier");
-                  index = std::make_shared<Engine::Constant>(memberToken, std::make_shared<Types::StringValue>(memberToken.text));
+                  index = std::make_shared<Engine::Constant>(memberToken, Types::StringValue::intern(memberToken.text));
                 }
                else
                 {
@@ -847,6 +953,24 @@ namespace Parser
 
             std::shared_ptr<Engine::Expression> rhs = expression(src, table, logger);
 
+             // Give an anonymous function the name it is assigned to, for the debugger and profiler.
+            if (nullptr == base.get())
+             {
+               std::shared_ptr<Engine::FunctionContext> function;
+               if (typeid(Engine::BuildFunction) == typeid(*rhs))
+                {
+                  function = std::static_pointer_cast<Engine::BuildFunction>(rhs)->prototype;
+                }
+               else if ((typeid(Engine::Constant) == typeid(*rhs)) && (typeid(Types::FunctionValue) == typeid(*std::static_pointer_cast<Engine::Constant>(rhs)->value)))
+                {
+                  function = std::dynamic_pointer_cast<Engine::FunctionContext>(std::static_pointer_cast<Types::FunctionValue>(std::static_pointer_cast<Engine::Constant>(rhs)->value)->value);
+                }
+               if ((nullptr != function.get()) && (true == function->name.empty()))
+                {
+                  function->name = identToken.text;
+                }
+             }
+
             ret = std::make_shared<Engine::Assignment>(buildToken, table.getVariableGetter(identToken.text), table.getVariableSetter(identToken.text), base, rhs);
           }
             break;
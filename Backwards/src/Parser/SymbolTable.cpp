@@ -30,6 +30,7 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "Backwards/Parser/SymbolTable.h"
+#include "Backwards/Parser/CycleCollector.h"
 #include "Backwards/Engine/ProgrammingException.h"
 #include "Backwards/Engine/Scope.h"
 #include "Backwards/Engine/FunctionContext.h"
@@ -77,6 +78,7 @@ namespace Parser
    void SymbolTable::pushContext()
     {
       frames.emplace_back(std::make_shared<Engine::FunctionContext>());
+      CycleCollector::track(frames.back());
     }
 
    void SymbolTable::injectContext(const std::shared_ptr<Engine::FunctionContext>& context)
@@ -99,6 +101,11 @@ namespace Parser
        }
     }
 
+   const GetterSetter& SymbolTable::getGetterSetter() const
+    {
+      return gs;
+    }
+
    std::shared_ptr<Engine::FunctionContext> SymbolTable::getContext()
     {
       return frames.back();
@@ -112,6 +119,10 @@ namespace Parser
 
    void SymbolTable::addVariable(const std::string& name)
     {
+      if (true == ((false == scopes.empty()) ? scopes.back()->frozen : globalScope->frozen))
+       {
+         throw Engine::ProgrammingException("Cannot add variable " + name + " to a shared scope.");
+       }
       if (false == scopes.empty())
        {
          scopes.back()->var.emplace(std::make_pair(name, scopes.back()->var.size()));
@@ -0,0 +1,200 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Backwards/Parser/TreeWalk.h"
+
+#include "Backwards/Engine/Expression.h"
+#include "Backwards/Engine/Statement.h"
+
+namespace Backwards
+ {
+
+namespace Parser
+ {
+
+#define BINARY_CHILDREN(x) \
+      if (typeid(Engine::x) == typeid(expr)) \
+       { \
+         fn(static_cast<Engine::x&>(expr).lhs); \
+         fn(static_cast<Engine::x&>(expr).rhs); \
+       }
+
+#define UNARY_CHILDREN(x) \
+      if (typeid(Engine::x) == typeid(expr)) \
+       { \
+         fn(static_cast<Engine::x&>(expr).arg); \
+       }
+
+    // Calls fn on each expression directly below this one.
+   void forEachChild (Engine::Expression& expr, const ExpressionVisitor& fn)
+    {
+      BINARY_CHILDREN(Plus)
+      BINARY_CHILDREN(Minus)
+      BINARY_CHILDREN(Multiply)
+      BINARY_CHILDREN(Divide)
+      BINARY_CHILDREN(ShortAnd)
+      BINARY_CHILDREN(ShortOr)
+      BINARY_CHILDREN(Equals)
+      BINARY_CHILDREN(NotEqual)
+      BINARY_CHILDREN(Greater)
+      BINARY_CHILDREN(Less)
+      BINARY_CHILDREN(GEQ)
+      BINARY_CHILDREN(LEQ)
+      BINARY_CHILDREN(DerefVar)
+      UNARY_CHILDREN(Not)
+      UNARY_CHILDREN(Negate)
+      if (typeid(Engine::FunctionCall) == typeid(expr))
+       {
+         Engine::FunctionCall& call = static_cast<Engine::FunctionCall&>(expr);
+         fn(call.location);
+         for (std::shared_ptr<Engine::Expression>& arg : call.args)
+          {
+            fn(arg);
+          }
+       }
+      else if (typeid(Engine::BuildFunction) == typeid(expr))
+       {
+         for (std::shared_ptr<Engine::Expression>& capture : static_cast<Engine::BuildFunction&>(expr).captures)
+          {
+            fn(capture);
+          }
+       }
+      else if (typeid(Engine::TernaryOperation) == typeid(expr))
+       {
+         Engine::TernaryOperation& op = static_cast<Engine::TernaryOperation&>(expr);
+         fn(op.condition);
+         fn(op.thenCase);
+         fn(op.elseCase);
+       }
+      else if (typeid(Engine::Invariant) == typeid(expr))
+       {
+         fn(static_cast<Engine::Invariant&>(expr).expr);
+       }
+    }
+
+#undef BINARY_CHILDREN
+#undef UNARY_CHILDREN
+
+    // Calls fn on each expression held directly by this statement. Optional expressions that are absent are skipped.
+   void forEachExpression (Engine::Statement& stmt, const ExpressionVisitor& fn)
+    {
+      const ExpressionVisitor call = [&fn](std::shared_ptr<Engine::Expression>& expr) { if (nullptr != expr.get()) fn(expr); };
+
+      if (typeid(Engine::Expr) == typeid(stmt))
+       {
+         call(static_cast<Engine::Expr&>(stmt).expr);
+       }
+      else if (typeid(Engine::Assignment) == typeid(stmt))
+       {
+         Engine::Assignment& assign = static_cast<Engine::Assignment&>(stmt);
+         for (std::shared_ptr<Engine::RecAssignState> index = assign.index; nullptr != index.get(); index = index->next)
+          {
+            call(index->index);
+          }
+         call(assign.rhs);
+       }
+      else if (typeid(Engine::IfStatement) == typeid(stmt))
+       {
+         call(static_cast<Engine::IfStatement&>(stmt).condition);
+       }
+      else if (typeid(Engine::WhileStatement) == typeid(stmt))
+       {
+         call(static_cast<Engine::WhileStatement&>(stmt).condition);
+       }
+      else if (typeid(Engine::SelectStatement) == typeid(stmt))
+       {
+         Engine::SelectStatement& select = static_cast<Engine::SelectStatement&>(stmt);
+         call(select.control);
+         for (std::shared_ptr<Engine::CaseContainer>& container : select.cases)
+          {
+            call(container->condition);
+            call(container->lower);
+          }
+       }
+      else if (typeid(Engine::ForStatement) == typeid(stmt))
+       {
+         Engine::ForStatement& loop = static_cast<Engine::ForStatement&>(stmt);
+         call(loop.lower);
+         call(loop.upper);
+         call(loop.step);
+       }
+      else if (typeid(Engine::FlowControlStatement) == typeid(stmt))
+       {
+         call(static_cast<Engine::FlowControlStatement&>(stmt).value);
+       }
+    }
+
+    // Calls fn on each statement directly below this one.
+   void forEachChild (Engine::Statement& stmt, const StatementVisitor& fn)
+    {
+      if (typeid(Engine::StatementSeq) == typeid(stmt))
+       {
+         for (std::shared_ptr<Engine::Statement>& child : static_cast<Engine::StatementSeq&>(stmt).statements)
+          {
+            fn(child);
+          }
+       }
+      else if (typeid(Engine::IfStatement) == typeid(stmt))
+       {
+         fn(static_cast<Engine::IfStatement&>(stmt).thenSeq);
+         fn(static_cast<Engine::IfStatement&>(stmt).elseSeq);
+       }
+      else if (typeid(Engine::WhileStatement) == typeid(stmt))
+       {
+         fn(static_cast<Engine::WhileStatement&>(stmt).seq);
+       }
+      else if (typeid(Engine::SelectStatement) == typeid(stmt))
+       {
+         for (std::shared_ptr<Engine::CaseContainer>& container : static_cast<Engine::SelectStatement&>(stmt).cases)
+          {
+            fn(container->seq);
+          }
+       }
+      else if (typeid(Engine::ForStatement) == typeid(stmt))
+       {
+         fn(static_cast<Engine::ForStatement&>(stmt).seq);
+       }
+      else if (typeid(Engine::InvariantLoop) == typeid(stmt))
+       {
+         fn(static_cast<Engine::InvariantLoop&>(stmt).loop);
+       }
+    }
+
+    // Calls fn on this statement and every statement below it.
+   void forEachStatement (std::shared_ptr<Engine::Statement>& stmt, const StatementVisitor& fn)
+    {
+      fn(stmt);
+      forEachChild(*stmt, [&fn](std::shared_ptr<Engine::Statement>& child) { forEachStatement(child, fn); });
+    }
+
+ } // namespace Parser
+
+ } // namespace Backwards
@@ -46,6 +46,10 @@ namespace Backwards
 namespace Types
  {
 
+   ArrayValue::ArrayValue() : ValueType(ARRAY), value()
+    {
+    }
+
    const std::string& ArrayValue::getTypeName() const
     {
       static const std::string name ("Array");
@@ -46,11 +46,11 @@ namespace Backwards
 namespace Types
  {
 
-   CellRangeValue::CellRangeValue()
+   CellRangeValue::CellRangeValue() : ValueType(CELL_RANGE)
     {
     }
 
-   CellRangeValue::CellRangeValue(const std::shared_ptr<CellRangeHolder>& value) : value(value)
+   CellRangeValue::CellRangeValue(const std::shared_ptr<CellRangeHolder>& value) : ValueType(CELL_RANGE), value(value)
     {
     }
 
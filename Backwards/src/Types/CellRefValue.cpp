@@ -46,11 +46,11 @@ namespace Backwards
 namespace Types
  {
 
-   CellRefValue::CellRefValue()
+   CellRefValue::CellRefValue() : ValueType(CELL_REF)
     {
     }
 
-   CellRefValue::CellRefValue(const std::shared_ptr<CellRefHolder>& value) : value(value)
+   CellRefValue::CellRefValue(const std::shared_ptr<CellRefHolder>& value) : ValueType(CELL_REF), value(value)
     {
     }
 
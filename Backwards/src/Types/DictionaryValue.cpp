@@ -48,9 +48,17 @@ namespace Types
 
    bool ChristHowHorrifying::operator() (const std::shared_ptr<ValueType>& lhs, const std::shared_ptr<ValueType>& rhs) const
     {
+      if ((STRING == lhs->getType()) && (STRING == rhs->getType()))
+       {
+         return static_cast<const StringValue&>(*rhs).StringValue::sort(static_cast<const StringValue&>(*lhs));
+       }
       return lhs->sort(*rhs);
     }
 
+   DictionaryValue::DictionaryValue() : ValueType(DICTIONARY), value()
+    {
+    }
+
    const std::string& DictionaryValue::getTypeName() const
     {
       static const std::string name ("Dictionary");
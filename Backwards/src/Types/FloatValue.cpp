@@ -41,6 +41,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Types/CellRangeValue.h"
 
 #include <functional>
+#include <unordered_map>
 
 namespace Backwards
  {
@@ -48,12 +49,53 @@ namespace Backwards
 namespace Types
  {
 
-   FloatValue::FloatValue() : value(dm_double_fromdouble(0.0))
+namespace
+ {
+
+   class SmallIntegers final
+    {
+   public:
+      static const int SMALLEST = -128;
+      static const int LARGEST = 1023;
+
+      std::unordered_map<dm_double, std::shared_ptr<FloatValue> > values;
+
+      SmallIntegers()
+       {
+         values.reserve(LARGEST - SMALLEST + 1);
+         for (int i = SMALLEST; i <= LARGEST; ++i)
+          {
+            dm_double value = dm_double_fromdouble(i);
+            values.emplace(value, std::make_shared<FloatValue>(value));
+          }
+       }
+
+      static const SmallIntegers& getInstance()
+       {
+         static const SmallIntegers instance;
+         return instance;
+       }
+    };
+
+ } // namespace
+
+   FloatValue::FloatValue() : ValueType(FLOAT), value(dm_double_fromdouble(0.0))
+    {
+    }
+
+   FloatValue::FloatValue(dm_double value) : ValueType(FLOAT), value(value)
     {
     }
 
-   FloatValue::FloatValue(dm_double value) : value(value)
+   std::shared_ptr<FloatValue> FloatValue::make (dm_double value)
     {
+      const SmallIntegers& cache = SmallIntegers::getInstance();
+      std::unordered_map<dm_double, std::shared_ptr<FloatValue> >::const_iterator found = cache.values.find(value);
+      if (cache.values.end() != found)
+       {
+         return found->second;
+       }
+      return std::make_shared<FloatValue>(value);
     }
 
    const std::string& FloatValue::getTypeName() const
@@ -64,7 +106,7 @@ namespace Types
 
    std::shared_ptr<ValueType> FloatValue::neg () const
     {
-      return std::make_shared<FloatValue>(dm_double_neg(value));
+      return make(dm_double_neg(value));
     }
 
    bool FloatValue::logical () const
@@ -74,22 +116,22 @@ namespace Types
 
    std::shared_ptr<ValueType> FloatValue::add (const FloatValue& lhs) const
     {
-      return std::make_shared<FloatValue>(dm_double_add(lhs.value, value));
+      return make(dm_double_add(lhs.value, value));
     }
 
    std::shared_ptr<ValueType> FloatValue::sub (const FloatValue& lhs) const
     {
-      return std::make_shared<FloatValue>(dm_double_sub(lhs.value, value));
+      return make(dm_double_sub(lhs.value, value));
     }
 
    std::shared_ptr<ValueType> FloatValue::mul (const FloatValue& lhs) const
     {
-      return std::make_shared<FloatValue>(dm_double_mul(lhs.value, value));
+      return make(dm_double_mul(lhs.value, value));
     }
 
    std::shared_ptr<ValueType> FloatValue::div (const FloatValue& lhs) const
     {
-      return std::make_shared<FloatValue>(dm_double_div(lhs.value, value));
+      return make(dm_double_div(lhs.value, value));
     }
 
    bool FloatValue::greater (const FloatValue& lhs) const
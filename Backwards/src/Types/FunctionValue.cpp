@@ -48,15 +48,11 @@ namespace Backwards
 namespace Types
  {
 
-   FunctionValue::FunctionValue() : value(nullptr), captures()
+   FunctionValue::FunctionValue() : ValueType(FUNCTION), value(nullptr), captures()
     {
     }
 
-   FunctionValue::FunctionValue(const std::shared_ptr<FunctionObjectHolder>& value, const std::vector<std::shared_ptr<ValueType> >& captures) : value(value), captures(captures)
-    {
-    }
-
-   FunctionValue::FunctionValue(const std::vector<std::shared_ptr<ValueType> >& captures, const std::weak_ptr<FunctionObjectHolder>& value) : valueToo(value), captures(captures)
+   FunctionValue::FunctionValue(const std::shared_ptr<FunctionObjectHolder>& value, const std::vector<std::shared_ptr<ValueType> >& captures) : ValueType(FUNCTION), value(value), captures(captures)
     {
     }
 
@@ -46,10 +46,16 @@ namespace Backwards
 namespace Types
  {
 
-   NilValue::NilValue()
+   NilValue::NilValue() : ValueType(NIL)
     {
     }
 
+   std::shared_ptr<NilValue> NilValue::make()
+    {
+      static const std::shared_ptr<NilValue> instance = std::make_shared<NilValue>();
+      return instance;
+    }
+
    const std::string& NilValue::getTypeName() const
     {
       static const std::string name ("Nil");
@@ -41,6 +41,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Types/CellRangeValue.h"
 
 #include <functional>
+#include <map>
+#include <mutex>
 
 namespace Backwards
  {
@@ -48,14 +50,62 @@ namespace Backwards
 namespace Types
  {
 
-   StringValue::StringValue() : value()
+   StringHolder::StringHolder(const std::string& text) : text(text), hashCode(0U), hashed(false)
     {
     }
 
-   StringValue::StringValue(const std::string& value) : value(value)
+   StringHolder::StringHolder(std::string&& text) : text(std::move(text)), hashCode(0U), hashed(false)
     {
     }
 
+   size_t StringHolder::hash() const
+    {
+       // Two threads may both compute the hash, but they store the same value.
+      if (false == hashed.load(std::memory_order_acquire))
+       {
+         hashCode.store(std::hash<std::string>()(text), std::memory_order_relaxed);
+         hashed.store(true, std::memory_order_release);
+       }
+      return hashCode.load(std::memory_order_relaxed);
+    }
+
+   StringValue::StringValue() : ValueType(STRING), holder(intern("")->holder), value(holder->text)
+    {
+    }
+
+   StringValue::StringValue(const std::string& value) : ValueType(STRING), holder(std::make_shared<StringHolder>(value)), value(holder->text)
+    {
+    }
+
+   StringValue::StringValue(std::string&& value) : ValueType(STRING), holder(std::make_shared<StringHolder>(std::move(value))), value(holder->text)
+    {
+    }
+
+   StringValue::StringValue(const char* value) : ValueType(STRING), holder(std::make_shared<StringHolder>(std::string(value))), value(holder->text)
+    {
+    }
+
+   StringValue::StringValue(const std::shared_ptr<const StringHolder>& holder) : ValueType(STRING), holder(holder), value(this->holder->text)
+    {
+    }
+
+   StringValue::StringValue(const StringValue& src) : ValueType(STRING), holder(src.holder), value(holder->text)
+    {
+    }
+
+   std::shared_ptr<StringValue> StringValue::intern (const std::string& value)
+    {
+      static std::mutex lock;
+      static std::map<std::string, std::shared_ptr<StringValue> > table;
+      std::lock_guard<std::mutex> guard (lock);
+      std::map<std::string, std::shared_ptr<StringValue> >::iterator found = table.find(value);
+      if (table.end() == found)
+       {
+         found = table.insert(std::make_pair(value, std::make_shared<StringValue>(value))).first;
+       }
+      return found->second;
+    }
+
    const std::string& StringValue::getTypeName() const
     {
       static const std::string name ("String");
@@ -64,6 +114,14 @@ namespace Types
 
    std::shared_ptr<ValueType> StringValue::add (const StringValue& lhs) const
     {
+      if (true == value.empty())
+       {
+         return std::make_shared<StringValue>(lhs.holder);
+       }
+      if (true == lhs.value.empty())
+       {
+         return std::make_shared<StringValue>(holder);
+       }
       return std::make_shared<StringValue>(lhs.value + value);
     }
 
@@ -89,12 +147,12 @@ namespace Types
 
    bool StringValue::equal (const StringValue& lhs) const
     {
-      return lhs.value == value;
+      return (lhs.holder == holder) || (lhs.value == value);
     }
 
    bool StringValue::notEqual (const StringValue& lhs) const
     {
-      return lhs.value != value;
+      return (lhs.holder != holder) && (lhs.value != value);
     }
 
    IMPLEMENTVISITOR(StringValue)
@@ -106,7 +164,7 @@ namespace Types
 
    bool StringValue::sort (const StringValue& lhs) const
     {
-      return lhs.value < value;
+      return (lhs.holder != holder) && (lhs.value < value);
     }
 
    bool StringValue::sort (const ArrayValue&) const
@@ -141,7 +199,7 @@ namespace Types
 
    size_t StringValue::hash() const
     {
-      return std::hash<std::string>()(value);
+      return holder->hash();
     }
 
  } // namespace Types
@@ -46,6 +46,9 @@ namespace Backwards
 namespace Types
  {
 
+   thread_local size_t ValueType::created = 0U;
+   std::atomic<size_t> ValueType::counting (0U);
+
    std::shared_ptr<ValueType> ValueType::neg() const
     {
       throw TypedOperationException("Error negating " + getTypeName());
@@ -106,7 +109,7 @@ namespace Types
 
    bool ValueType::compare (const ValueType& rhs) const
     {
-      if (typeid(*this) != typeid(rhs))
+      if (getType() != rhs.getType())
        {
          return false;
        }
@@ -30,6 +30,7 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <ncurses.h>
+#include <fstream>
 
 #include "Forwards/Engine/CallingContext.h"
 #include "Forwards/Engine/Cell.h"
@@ -760,26 +761,44 @@ int ProcessInput(SharedData& data)
          data.context->theSheet->recalc(*data.context);
        }
       break;
+   case 'm':
+      data.m_col = data.c_col;
+      data.m_row = data.c_row;
+      break;
    case 'y':
-      if ('y' == getch())
+      c = getch();
+      if ('y' == c)
        {
          if ((nullptr != curCell) && (nullptr != curCell->value.get()))
           {
-            data.yankedType = curCell->type;
-            data.yanked = curCell->value;
+            data.yanked = data.context->theSheet->yankBlock(data.c_col, data.c_row, data.c_col, data.c_row);
           }
        }
+      else if ('m' == c)
+       {
+         data.yanked = data.context->theSheet->yankBlock(data.m_col, data.m_row, data.c_col, data.c_row);
+       }
       break;
    case 'p':
       if ('p' == getch())
        {
-         if (nullptr == curCell)
+         if (0U != data.yanked.cells.size())
           {
-            data.context->theSheet->initCellAt(data.c_col, data.c_row);
-            curCell = data.context->theSheet->getCellAt(data.c_col, data.c_row);
+            data.context->theSheet->pasteBlock(data.yanked, data.c_col, data.c_row, MAX_COL, MAX_ROW);
+            data.context->theSheet->recalc(*data.context);
           }
-         curCell->type = data.yankedType;
-         curCell->value = data.yanked;
+       }
+      break;
+   case 'f':
+      c = getch();
+      if ('d' == c)
+       {
+         data.context->theSheet->fillDown(data.m_col, data.m_row, data.c_col, data.c_row);
+         data.context->theSheet->recalc(*data.context);
+       }
+      else if ('r' == c)
+       {
+         data.context->theSheet->fillRight(data.m_col, data.m_row, data.c_col, data.c_row);
          data.context->theSheet->recalc(*data.context);
        }
       break;
@@ -810,6 +829,34 @@ int ProcessInput(SharedData& data)
    case 'W':
       data.saveRequested = true;
       break;
+   case 'P':
+      if (nullptr == data.profiler.get())
+       {
+         data.profiler = std::make_shared<Forwards::Engine::CellProfiler>();
+         data.context->profiler = data.profiler.get();
+       }
+      else
+       {
+         std::ofstream file (data.profileFileName);
+         data.profiler->report(file);
+         data.context->profiler = nullptr;
+         data.profiler.reset();
+       }
+      break;
+   case 'S':
+      if (nullptr == data.sampler.get())
+       {
+         data.sampler = std::make_shared<Forwards::Engine::CellSampler>(std::chrono::milliseconds(1));
+         data.context->sampler = data.sampler.get();
+       }
+      else
+       {
+         std::ofstream file (data.sampleFileName);
+         data.sampler->report(file);
+         data.context->sampler = nullptr;
+         data.sampler.reset();
+       }
+      break;
    case KEY_F(9):
    case KEY_SLEFT:
       decWidth(data.col_widths, data.c_col, data.def_col_width);
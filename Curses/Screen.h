@@ -49,12 +49,20 @@ public:
    size_t def_col_width;
    std::map<size_t, int> col_widths;
 
-   Forwards::Engine::CellType yankedType;
-   std::shared_ptr<Forwards::Engine::Expression> yanked;
+   size_t m_col;
+   size_t m_row;
+
+   Forwards::Engine::CellBlock yanked;
 
    Forwards::Engine::CallingContext* context;
 
    bool saveRequested;
+
+   std::shared_ptr<Forwards::Engine::CellProfiler> profiler;
+   std::string profileFileName;
+
+   std::shared_ptr<Forwards::Engine::CellSampler> sampler;
+   std::string sampleFileName;
  };
 
 void InitScreen(void);
@@ -29,9 +29,12 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
+#include <csignal>
 #include <iostream>
+#include <thread>
 
 #include "Backwards/Engine/Logger.h"
+#include "Backwards/Parser/CycleCollector.h"
 
 #include "Forwards/Engine/CallingContext.h"
 #include "Forwards/Engine/Cell.h"
@@ -49,6 +52,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Screen.h"
 
+static Forwards::Engine::CallingContext* running = nullptr;
+
+   // Ctrl-C stops a runaway recalculation instead of the program.
+static void cancelRecalc (int)
+ {
+   running->recalcBudget.cancelled = true;
+   running->cellBudget.cancelled = true;
+ }
+
 int main (int argc, char ** argv)
  {
    Forwards::Engine::CallingContext context;
@@ -61,7 +73,26 @@ int main (int argc, char ** argv)
    Forwards::Engine::GetterMap map;
    context.map = &map;
 
-   int file = LoadLibraries(argc, argv, context);
+      // Reading the sheet doesn't need the libraries, but parsing its formulas needs the names they define.
+   int file = FindSheetArgument(argc, argv);
+   std::thread reader;
+   if (file < argc)
+    {
+      reader = std::thread(LoadFile, std::string(argv[file]), &sheet);
+    }
+   (void) LoadLibraries(argc, argv, context);
+   if (true == reader.joinable())
+    {
+      reader.join();
+      sheet.parseAll(context, std::thread::hardware_concurrency());
+    }
+
+      // Deep enough for any sane library, well short of running out of stack.
+   context.cellBudget.maxDepth = 2000U;
+   context.cellBudget.maxTime = std::chrono::seconds(10);
+   context.recalcBudget.maxTime = std::chrono::seconds(60);
+   running = &context;
+   std::signal(SIGINT, cancelRecalc);
 
    std::string saveFileName = "untitled.html";
    if (file < argc)
@@ -75,7 +106,6 @@ int main (int argc, char ** argv)
          saveFileName = argv[file];
        }
 
-      LoadFile(argv[file], &sheet);
     }
 
    SharedData state;
@@ -92,12 +122,16 @@ int main (int argc, char ** argv)
 
    state.def_col_width = 9;
 
-   state.yankedType = Forwards::Engine::ERROR;
+   state.m_col = 0U;
+   state.m_row = 0U;
 
    state.context = &context;
 
    state.saveRequested = false;
 
+   state.profileFileName = saveFileName + ".profile";
+   state.sampleFileName = saveFileName + ".folded";
+
 
    if (0U != sheet.max_row) // We loaded saved data, so recalculate the sheet.
     {
@@ -109,6 +143,8 @@ int main (int argc, char ** argv)
    UpdateScreen(state);
    while (ProcessInput(state))
     {
+         // Nothing runs between keys, so free any functions that only refer to each other.
+      Backwards::Parser::CycleCollector::collect();
       UpdateScreen(state);
       if (true == state.saveRequested)
        {
@@ -38,6 +38,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Forwards/Engine/CellRangeExpand.h"
 #include "Forwards/Engine/CellRefEval.h"
+#include "Forwards/Engine/Plugin.h"
 
 #include "Forwards/Parser/Parser.h"
 
@@ -61,6 +62,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Parser/ContextBuilder.h"
 
 #include "Backwards/Types/CellRangeValue.h"
+#include "Backwards/Types/FloatValue.h"
 #include "Backwards/Types/CellRefValue.h"
 
 class StringLogger final : public Backwards::Engine::Logger
@@ -1410,6 +1412,146 @@ TEST(EngineTests, testFunctionsAndRanges)
    EXPECT_EQ("@ARG(6+9)", funTestParens->toString(0U, 0U, 5));
  }
 
+static std::shared_ptr<Forwards::Types::ValueType> SumSquares (Forwards::Engine::CallingContext& context, const std::vector<std::shared_ptr<Forwards::Engine::Expression> >& args)
+ {
+   dm_double result = dm_double_fromdouble(0.0);
+   for (const std::shared_ptr<Forwards::Engine::Expression>& arg : args)
+    {
+      std::shared_ptr<Forwards::Types::ValueType> range = arg->evaluate(context);
+      if (typeid(Forwards::Types::CellRangeValue) != typeid(*range.get()))
+       {
+         throw Backwards::Types::TypedOperationException("Not a range.");
+       }
+      const Forwards::Types::CellRangeValue& corners = static_cast<const Forwards::Types::CellRangeValue&>(*range.get());
+      for (size_t col = corners.col1; col <= corners.col2; ++col)
+       {
+         for (size_t row = corners.row1; row <= corners.row2; ++row)
+          {
+            std::shared_ptr<Forwards::Types::ValueType> cell = Forwards::Engine::CellValue(context, col, row);
+            if (typeid(Forwards::Types::FloatValue) == typeid(*cell.get()))
+             {
+               dm_double value = static_cast<const Forwards::Types::FloatValue&>(*cell.get()).value;
+               result = dm_double_add(result, dm_double_mul(value, value));
+             }
+          }
+       }
+    }
+   return std::make_shared<Forwards::Types::FloatValue>(result);
+ }
+
+static std::shared_ptr<Forwards::Types::ValueType> First (Forwards::Engine::CallingContext& context, const std::vector<std::shared_ptr<Forwards::Engine::Expression> >& args)
+ {
+   return args[0]->evaluate(context);
+ }
+
+static std::shared_ptr<Forwards::Types::ValueType> Never (Forwards::Engine::CallingContext&, const std::vector<std::shared_ptr<Forwards::Engine::Expression> >&)
+ {
+   throw Backwards::Types::TypedOperationException("Evaluated an argument that wasn't used.");
+ }
+
+TEST(EngineTests, testNativeFunctions)
+ {
+   std::shared_ptr<Forwards::Types::ValueType> res;
+   Forwards::Engine::CallingContext context;
+   StringLogger logger;
+   context.logger = &logger;
+
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+
+   shet.sheet.resize(2U);
+   shet.sheet[0].resize(2);
+   shet.sheet[1].resize(1);
+   shet.sheet[0][0] = std::make_unique<Forwards::Engine::Cell>();
+   shet.sheet[0][1] = std::make_unique<Forwards::Engine::Cell>();
+   shet.sheet[1][0] = std::make_unique<Forwards::Engine::Cell>();
+   shet.sheet[0][0]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue(1.0));
+   shet.sheet[0][1]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue(2.0));
+   shet.sheet[1][0]->value = std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::StringValue>("x"));
+
+   Forwards::Engine::CellFrame frame (shet.sheet[0][0].get(), 0U, 0U);
+   context.pushCell(&frame);
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+
+   Forwards::Engine::ScopeRegistry registry (table, global);
+   registry.addFunction("SUMSQ", &SumSquares);
+   registry.addFunction("FIRST", &First);
+   registry.addFunction("NEVER", &Never);
+   EXPECT_THROW(registry.addFunction("NULL", nullptr), Backwards::Engine::ProgrammingException);
+   EXPECT_THROW(registry.addFunction("FIRST", &Never), Backwards::Engine::ProgrammingException);
+
+      // Nothing is in the scope until the plugin has finished, and a registry that is never committed adds nothing.
+   EXPECT_EQ(0U, global.names.size());
+    {
+      Forwards::Engine::ScopeRegistry failed (table, global);
+      failed.addFunction("NEVER", &Never);
+    }
+   registry.commit();
+   EXPECT_THROW(registry.addFunction("FIRST", &Never), Backwards::Engine::ProgrammingException);
+
+   Forwards::Engine::GetterMap map;
+   for (const std::string& name : global.names)
+    {
+      map.insert(std::make_pair(name, table.getVariableGetter(name)));
+    }
+   ASSERT_EQ(3U, map.size());
+
+   std::vector<std::shared_ptr<Forwards::Engine::Expression> > args;
+   args.emplace_back(std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), std::make_shared<Forwards::Types::CellRangeValue>(0, 0, 1, 1)));
+   std::shared_ptr<Forwards::Engine::FunctionCall> sumsq = std::make_shared<Forwards::Engine::FunctionCall>(
+      Forwards::Input::Token(Forwards::Input::IDENTIFIER, "SUMSQ", 1U),
+      std::make_shared<Backwards::Engine::Variable>(Backwards::Input::Token(), map["SUMSQ"]),
+      args);
+
+   res = sumsq->evaluate(context);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*res.get()));
+   EXPECT_EQ(dm_double_fromdouble(5.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(res)->value);
+
+      // Going through the interpreter gives the same answer.
+   std::shared_ptr<Backwards::Types::ValueType> boxed = sumsq->call->evaluate(context);
+   ASSERT_TRUE(typeid(Backwards::Types::CellRefValue) == typeid(*boxed.get()));
+   boxed = std::dynamic_pointer_cast<Forwards::Engine::CellRefEval>(std::dynamic_pointer_cast<Backwards::Types::CellRefValue>(boxed)->value)->evaluate(context);
+   ASSERT_TRUE(typeid(Backwards::Types::FloatValue) == typeid(*boxed.get()));
+   EXPECT_EQ(dm_double_fromdouble(5.0), std::dynamic_pointer_cast<Backwards::Types::FloatValue>(boxed)->value);
+
+   args.clear();
+   args.emplace_back(std::make_shared<Forwards::Engine::Constant>(Forwards::Input::Token(), makeFloatValue(6.0)));
+   std::shared_ptr<Forwards::Engine::FunctionCall> sumsqBad = std::make_shared<Forwards::Engine::FunctionCall>(
+      Forwards::Input::Token(Forwards::Input::IDENTIFIER, "SUMSQ", 1U),
+      std::make_shared<Backwards::Engine::Variable>(Backwards::Input::Token(), map["SUMSQ"]),
+      args);
+   EXPECT_THROW(sumsqBad->evaluate(context), Backwards::Types::TypedOperationException);
+
+      // Called by a library with something other than references to cells, it is an error in the library's code.
+   std::vector<std::shared_ptr<Backwards::Engine::Expression> > libraryArgs;
+   libraryArgs.emplace_back(std::make_shared<Backwards::Engine::Constant>(Backwards::Input::TokenHandle(), std::make_shared<Backwards::Types::FloatValue>(dm_double_fromdouble(6.0))));
+   std::shared_ptr<Backwards::Engine::FunctionCall> fromLibrary = std::make_shared<Backwards::Engine::FunctionCall>(Backwards::Input::TokenHandle(),
+      std::make_shared<Backwards::Engine::Variable>(Backwards::Input::TokenHandle(), map["SUMSQ"]), libraryArgs);
+   EXPECT_THROW(fromLibrary->evaluate(context), Backwards::Types::TypedOperationException);
+
+      // Arguments that aren't used aren't evaluated.
+   args.emplace_back(std::make_shared<Forwards::Engine::FunctionCall>(
+      Forwards::Input::Token(Forwards::Input::IDENTIFIER, "NEVER", 1U),
+      std::make_shared<Backwards::Engine::Variable>(Backwards::Input::Token(), map["NEVER"]),
+      std::vector<std::shared_ptr<Forwards::Engine::Expression> >()));
+   std::shared_ptr<Forwards::Engine::FunctionCall> first = std::make_shared<Forwards::Engine::FunctionCall>(
+      Forwards::Input::Token(Forwards::Input::IDENTIFIER, "FIRST", 1U),
+      std::make_shared<Backwards::Engine::Variable>(Backwards::Input::Token(), map["FIRST"]),
+      args);
+
+   EXPECT_EQ("@FIRST(6;@NEVER)", first->toString(0U, 0U, 5));
+   res = first->evaluate(context);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*res.get()));
+   EXPECT_EQ(dm_double_fromdouble(6.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(res)->value);
+
+   res = Forwards::Engine::CellValue(context, 1U, 1U);
+   EXPECT_TRUE(typeid(Forwards::Types::NilValue) == typeid(*res.get()));
+ }
+
 TEST(EngineTests, testCellRangeExpand)
  {
    Backwards::Types::CellRangeValue defaulted (std::make_shared<Forwards::Engine::CellRangeExpand>());
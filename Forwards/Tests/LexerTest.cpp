@@ -163,3 +163,49 @@ TEST(LexerTests, testEverythingAndTheKitchenSink)
       EXPECT_EQ(iter->second, test.lexeme);
     }
  }
+
+TEST(LexerTests, testBuffer)
+ {
+   const std::string formula = " @sum($a$1:b2;1,5E3;.;12e+)&\"x\" <= 0001";
+
+   std::vector<std::pair<std::string, Forwards::Input::Lexeme> > tests;
+   tests.push_back(std::make_pair("SUM",                  Forwards::Input::IDENTIFIER));
+   tests.push_back(std::make_pair("(",                    Forwards::Input::OPEN_PARENS));
+   tests.push_back(std::make_pair("$A$1",                 Forwards::Input::CELL_REFERENCE));
+   tests.push_back(std::make_pair(":",                    Forwards::Input::RANGE));
+   tests.push_back(std::make_pair("B2",                   Forwards::Input::CELL_REFERENCE));
+   tests.push_back(std::make_pair(";",                    Forwards::Input::SEMICOLON));
+   tests.push_back(std::make_pair("1.5e3",                Forwards::Input::NUMBER));
+   tests.push_back(std::make_pair(";",                    Forwards::Input::SEMICOLON));
+   tests.push_back(std::make_pair(".",                    Forwards::Input::INVALID));
+   tests.push_back(std::make_pair(";",                    Forwards::Input::SEMICOLON));
+   tests.push_back(std::make_pair("12",                   Forwards::Input::NUMBER));
+   tests.push_back(std::make_pair("E",                    Forwards::Input::INVALID));
+   tests.push_back(std::make_pair("+",                    Forwards::Input::PLUS));
+   tests.push_back(std::make_pair(")",                    Forwards::Input::CLOSE_PARENS));
+   tests.push_back(std::make_pair("&",                    Forwards::Input::CAT));
+   tests.push_back(std::make_pair("\"",                   Forwards::Input::INVALID));
+   tests.push_back(std::make_pair("X",                    Forwards::Input::INVALID));
+   tests.push_back(std::make_pair("\"",                   Forwards::Input::INVALID));
+   tests.push_back(std::make_pair("<=",                   Forwards::Input::LESS_THAN_OR_EQUAL_TO));
+   tests.push_back(std::make_pair("0001",                 Forwards::Input::NUMBER));
+   tests.push_back(std::make_pair("END-OF-INPUT",         Forwards::Input::END_OF_FILE));
+
+      // Scanning the string in place, and reading it through a GenericInput, see the same tokens at the same places.
+   Backwards::Input::StringInput input (formula);
+   Forwards::Input::Lexer fromInput (input, 5U);
+   Forwards::Input::Lexer fromString (formula, 5U);
+   for (std::vector<std::pair<std::string, Forwards::Input::Lexeme> >::const_iterator iter = tests.begin();
+      iter != tests.end(); ++iter)
+    {
+      Forwards::Input::Token left = fromInput.getNextToken();
+      Forwards::Input::Token right = fromString.getNextToken();
+      EXPECT_EQ(iter->second, left.lexeme);
+      EXPECT_EQ(iter->first, left.text);
+      EXPECT_EQ(left.lexeme, right.lexeme);
+      EXPECT_EQ(left.text, right.text);
+      EXPECT_EQ(left.location, right.location);
+    }
+   EXPECT_EQ(6U, Forwards::Input::Lexer(formula, 5U).peekNextToken().location);
+   EXPECT_EQ(5U + formula.size(), fromString.peekNextToken().location);
+ }
@@ -44,7 +44,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Forwards/Types/CellRefValue.h"
 #include "Forwards/Types/CellRangeValue.h"
 
+#include "Backwards/Engine/Budget.h"
 #include "Backwards/Engine/FatalException.h"
+#include "Backwards/Engine/FunctionContext.h"
 #include "Backwards/Engine/Logger.h"
 #include "Backwards/Engine/ProgrammingException.h"
 #include "Backwards/Engine/Statement.h"
@@ -56,6 +58,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Parser/SymbolTable.h"
 #include "Backwards/Parser/Parser.h"
 #include "Backwards/Parser/ContextBuilder.h"
+#include "Backwards/Parser/CycleCollector.h"
+
+#include "Backwards/Types/FunctionValue.h"
+
+#include <thread>
 
 TEST(EngineTests, testSpreadSheet_EasyCases)
  {
@@ -327,6 +334,38 @@ TEST(EngineTests, testSpreadSheet_Recalc_BTRL) // B2 is evaluated first. It call
    EXPECT_EQ(dm_double_fromdouble(3.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(cell->previousValue)->value);
  }
 
+TEST(EngineTests, testSpreadSheet_Recalc_LongChain) // Bottom-up, every cell needs the whole column above it.
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+
+   shet.top_down = false;
+
+   const size_t ROWS = 300000U;
+   shet.initCellAt(0U, ROWS - 1U);
+   for (size_t row = 0U; row < ROWS; ++row)
+    {
+      shet.initCellAt(0U, row);
+      Forwards::Engine::Cell* cell = shet.getCellAt(0U, row);
+      cell->type = Forwards::Engine::VALUE;
+      cell->currentInput = (0U == row) ? "1" : ("A" + std::to_string(row) + " + 1");
+    }
+   shet.initCellAt(1U, 0U);
+   Forwards::Engine::Cell* cell = shet.getCellAt(1U, 0U);
+   cell->type = Forwards::Engine::VALUE;
+   cell->currentInput = "A" + std::to_string(ROWS) + " - A1";
+
+   shet.recalc(context);
+
+   cell = shet.getCellAt(0U, ROWS - 1U);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*cell->previousValue.get()));
+   EXPECT_EQ(dm_double_fromdouble(static_cast<double>(ROWS)), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(cell->previousValue)->value);
+   cell = shet.getCellAt(1U, 0U);
+   ASSERT_TRUE(typeid(Forwards::Types::FloatValue) == typeid(*cell->previousValue.get()));
+   EXPECT_EQ(dm_double_fromdouble(static_cast<double>(ROWS - 1U)), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(cell->previousValue)->value);
+ }
+
 TEST(EngineTests, testSpreadSheet_Recalc_NoHang)
  {
    std::cerr << "WARNING: this unit test will hang on failure." << std::endl;
@@ -514,3 +553,541 @@ TEST(EngineTests, testSpreadSheet_Recalc_NoHang)
        }
     }
  }
+
+TEST(EngineTests, testSpreadSheet_Budgets)
+ {
+   std::shared_ptr<Forwards::Types::ValueType> res;
+   Forwards::Engine::CallingContext context;
+   Forwards::Parser::StringLogger logger;
+   context.logger = &logger;
+
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+   Backwards::Input::StringInput lib ("set FOREVER to function (x) is set y to 0 while 1 do set y to y + 1 end return y end "
+      "set D to 0 set D to function (x) is if x = 0 then return 0 end return 1 + D(x - 1) end "
+      "set DEEP to function (x) is return D(EvalCell(x[0])) end");
+   Backwards::Input::Lexer lexer (lib, "Library");
+   std::shared_ptr<Backwards::Engine::Statement> stdLib = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, stdLib.get());
+   stdLib->execute(context);
+   map.insert(std::make_pair("FOREVER", table.getVariableGetter("FOREVER")));
+   map.insert(std::make_pair("DEEP", table.getVariableGetter("DEEP")));
+
+   context.cellBudget.maxSteps = 1000U;
+   context.cellBudget.maxDepth = 50U;
+
+   shet.initCellAt(0U, 0U);
+   Forwards::Engine::Cell* cell = shet.getCellAt(0U, 0U);
+   cell->type = Forwards::Engine::VALUE;
+   cell->currentInput = "@FOREVER(1)";
+   EXPECT_EQ("Execution budget exceeded: ran for more than 1000 function calls and loop iterations.", shet.computeCell(context, res, 0U, 0U, false));
+   EXPECT_EQ(nullptr, res.get());
+   EXPECT_EQ(nullptr, context.budget);
+
+   cell->value.reset();
+   cell->currentInput = "@DEEP(40)";
+   EXPECT_EQ("", shet.computeCell(context, res, 0U, 0U, false));
+   cell->value.reset();
+   cell->currentInput = "@DEEP(60)";
+   ++context.generation;
+   EXPECT_EQ("Execution budget exceeded: function calls nested more than 50 deep.", shet.computeCell(context, res, 0U, 0U, false));
+
+      // Each cell gets its own steps, but the recalc as a whole can run out.
+   context.cellBudget.maxSteps = 0U;
+   context.recalcBudget.maxSteps = 60U;
+   shet.initCellAt(0U, 1U);
+   cell->value.reset();
+   cell->currentInput = "@DEEP(40)";
+   cell = shet.getCellAt(0U, 1U);
+   cell->type = Forwards::Engine::VALUE;
+   cell->currentInput = "@DEEP(40)";
+   shet.recalc(context);
+   EXPECT_NE(nullptr, shet.getCellAt(0U, 0U)->previousValue.get());
+   EXPECT_EQ(shet.getCellAt(0U, 0U)->previousGeneration + 1U, context.generation);
+   EXPECT_NE(shet.getCellAt(0U, 1U)->previousGeneration + 1U, context.generation);
+   EXPECT_EQ(41U + 20U, context.recalcBudget.steps());
+
+      // A cancelled budget stops at its next check.
+   Backwards::Engine::Budget budget;
+   budget.start(nullptr);
+   budget.cancelled = true;
+   context.budget = &budget;
+   cell->value.reset();
+   cell->currentInput = "@FOREVER(1)";
+   EXPECT_EQ("Execution cancelled.", shet.computeCell(context, res, 0U, 1U, false));
+   context.budget = nullptr;
+ }
+
+TEST(EngineTests, testSpreadSheet_Memo)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Parser::StringLogger logger;
+   context.logger = &logger;
+
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+   Backwards::Input::StringInput lib ("set TWICE to function (x) is return EvalCell(x[0]) * 2 end");
+   Backwards::Input::Lexer lexer (lib, "Library");
+   std::shared_ptr<Backwards::Engine::Statement> stdLib = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, stdLib.get());
+   stdLib->execute(context);
+   map.insert(std::make_pair("TWICE", table.getVariableGetter("TWICE")));
+
+      // B1 and C1 make the same call. B2 and C2 both refer to the cell on their left, which are different cells.
+   const char* inputs [3][2] = { { "3", "4" }, { "@TWICE($A$1)", "@TWICE(A2)" }, { "@TWICE($A$1)", "@TWICE(B2)" } };
+   for (size_t col = 0U; col < 3U; ++col)
+    {
+      for (size_t row = 0U; row < 2U; ++row)
+       {
+         shet.initCellAt(col, row);
+         shet.getCellAt(col, row)->type = Forwards::Engine::VALUE;
+         shet.getCellAt(col, row)->currentInput = inputs[col][row];
+       }
+    }
+
+      // D1 refers to A1 as well, and D2 and E1 both work out to 3.
+   const char* more [3] = { "@TWICE(A$1)", "@TWICE(1+2)", "@TWICE(2+1)" };
+   for (size_t i = 0U; i < 3U; ++i)
+    {
+      shet.initCellAt(3U + i / 2U, i % 2U);
+      shet.getCellAt(3U + i / 2U, i % 2U)->type = Forwards::Engine::VALUE;
+      shet.getCellAt(3U + i / 2U, i % 2U)->currentInput = more[i];
+    }
+
+   Forwards::Engine::CellProfiler profiler;
+   context.profiler = &profiler;
+   shet.recalc(context);
+   context.profiler = nullptr;
+   EXPECT_EQ(4U, profiler.functions["TWICE"].calls); // B1, B2, C2, and D2.
+   EXPECT_EQ(dm_double_fromdouble(6.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(3U, 0U)->previousValue)->value);
+   EXPECT_EQ(dm_double_fromdouble(6.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(3U, 1U)->previousValue)->value);
+   EXPECT_EQ(dm_double_fromdouble(6.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(4U, 0U)->previousValue)->value);
+   EXPECT_EQ(dm_double_fromdouble(6.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(1U, 0U)->previousValue)->value);
+   EXPECT_EQ(dm_double_fromdouble(8.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(1U, 1U)->previousValue)->value);
+   EXPECT_EQ(dm_double_fromdouble(6.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(2U, 0U)->previousValue)->value);
+   EXPECT_EQ(dm_double_fromdouble(16.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(2U, 1U)->previousValue)->value);
+   EXPECT_EQ(nullptr, context.memo);
+   EXPECT_EQ(0U, context.memoCache.size());
+
+      // Nothing is remembered from one recalc to the next.
+   shet.getCellAt(0U, 0U)->currentInput = "5";
+   shet.getCellAt(0U, 0U)->value.reset();
+   shet.recalc(context);
+   EXPECT_EQ(dm_double_fromdouble(10.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(1U, 0U)->previousValue)->value);
+   EXPECT_EQ(dm_double_fromdouble(10.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(2U, 0U)->previousValue)->value);
+ }
+
+TEST(EngineTests, testSpreadSheet_Templates)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Parser::StringLogger logger;
+   context.logger = &logger;
+
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+      // Column B doubles column A, and column C adds A1 to it: the same formula in every row, relative to the row.
+   for (size_t row = 0U; row < 200U; ++row)
+    {
+      const std::string name = std::to_string(row + 1U);
+      shet.initCellAt(0U, row);
+      shet.getCellAt(0U, row)->type = Forwards::Engine::VALUE;
+      shet.getCellAt(0U, row)->currentInput = name;
+      shet.initCellAt(1U, row);
+      shet.getCellAt(1U, row)->type = Forwards::Engine::VALUE;
+      shet.getCellAt(1U, row)->currentInput = "A" + name + "*2";
+      shet.initCellAt(2U, row);
+      shet.getCellAt(2U, row)->type = Forwards::Engine::VALUE;
+      shet.getCellAt(2U, row)->currentInput = "$A$1+A" + name;
+    }
+
+   shet.recalc(context);
+   for (size_t row = 0U; row < 200U; ++row)
+    {
+      EXPECT_EQ(dm_double_fromdouble(2.0 * (row + 1U)), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(1U, row)->previousValue)->value);
+      EXPECT_EQ(dm_double_fromdouble(row + 2.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(2U, row)->previousValue)->value);
+    }
+
+      // Rows with as many digits share a tree. Where the digits grow, the tokens move, and so do the locations in error messages.
+   EXPECT_EQ(shet.getCellAt(1U, 0U)->value.get(), shet.getCellAt(1U, 8U)->value.get());
+   EXPECT_NE(shet.getCellAt(1U, 8U)->value.get(), shet.getCellAt(1U, 9U)->value.get());
+   EXPECT_EQ(shet.getCellAt(1U, 9U)->value.get(), shet.getCellAt(1U, 98U)->value.get());
+   EXPECT_EQ(shet.getCellAt(1U, 99U)->value.get(), shet.getCellAt(1U, 199U)->value.get());
+   EXPECT_EQ(shet.getCellAt(2U, 99U)->value.get(), shet.getCellAt(2U, 199U)->value.get());
+   EXPECT_NE(shet.getCellAt(1U, 199U)->value.get(), shet.getCellAt(2U, 199U)->value.get());
+   EXPECT_EQ("A150*2", shet.getCellAt(1U, 149U)->value->toString(1U, 149U));
+   EXPECT_EQ("$A$1+A150", shet.getCellAt(2U, 149U)->value->toString(2U, 149U));
+
+      // A formula that refers to a different cell gets its own tree, and leaves the others alone.
+   shet.getCellAt(1U, 150U)->currentInput = "A152*2";
+   shet.getCellAt(1U, 150U)->value.reset();
+   shet.recalc(context);
+   EXPECT_NE(shet.getCellAt(1U, 149U)->value.get(), shet.getCellAt(1U, 150U)->value.get());
+   EXPECT_EQ(shet.getCellAt(1U, 149U)->value.get(), shet.getCellAt(1U, 151U)->value.get());
+   EXPECT_EQ(dm_double_fromdouble(304.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(1U, 150U)->previousValue)->value);
+   EXPECT_EQ(dm_double_fromdouble(300.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(1U, 149U)->previousValue)->value);
+ }
+
+TEST(EngineTests, testSpreadSheet_Blocks)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Parser::StringLogger logger;
+   context.logger = &logger;
+
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+   for (size_t row = 0U; row < 10U; ++row)
+    {
+      shet.initCellAt(0U, row);
+      shet.getCellAt(0U, row)->type = Forwards::Engine::VALUE;
+      shet.getCellAt(0U, row)->currentInput = std::to_string(row + 1U);
+    }
+   shet.initCellAt(1U, 0U);
+   shet.getCellAt(1U, 0U)->type = Forwards::Engine::VALUE;
+   shet.getCellAt(1U, 0U)->currentInput = "A1*$A$2";
+   shet.initCellAt(2U, 0U);
+   shet.getCellAt(2U, 0U)->type = Forwards::Engine::LABEL;
+   shet.getCellAt(2U, 0U)->currentInput = "Hi";
+   shet.recalc(context);
+
+      // Fill B1:C1 down to row 10. Every cell gets the tree from the top of its column.
+   shet.fillDown(2U, 9U, 1U, 0U);
+   shet.recalc(context);
+   for (size_t row = 0U; row < 10U; ++row)
+    {
+      EXPECT_EQ(shet.getCellAt(1U, 0U)->value.get(), shet.getCellAt(1U, row)->value.get());
+      EXPECT_EQ(dm_double_fromdouble(2.0 * (row + 1U)), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(1U, row)->previousValue)->value);
+      EXPECT_EQ("Hi", std::dynamic_pointer_cast<Forwards::Types::StringValue>(shet.getCellAt(2U, row)->previousValue)->value);
+    }
+   EXPECT_EQ("A7*$A$2", shet.getCellAt(1U, 6U)->value->toString(1U, 6U));
+
+      // Fill A1:A3 right to D. D was empty.
+   shet.fillRight(0U, 0U, 3U, 2U);
+   shet.recalc(context);
+   EXPECT_EQ(dm_double_fromdouble(3.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(3U, 2U)->previousValue)->value);
+   EXPECT_EQ(shet.getCellAt(0U, 1U)->value.get(), shet.getCellAt(2U, 1U)->value.get());
+   EXPECT_EQ(dm_double_fromdouble(20.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(1U, 9U)->previousValue)->value);
+
+      // Copy A9:E10, where E is empty, and paste it at A1. The empty column clears what it lands on.
+   shet.initCellAt(4U, 0U);
+   shet.getCellAt(4U, 0U)->type = Forwards::Engine::LABEL;
+   shet.getCellAt(4U, 0U)->currentInput = "Gone";
+   Forwards::Engine::CellBlock block = shet.yankBlock(4U, 9U, 0U, 8U);
+   EXPECT_EQ(5U, block.cols);
+   EXPECT_EQ(2U, block.rows);
+   EXPECT_EQ(nullptr, block.cells[8U].get());
+   EXPECT_EQ(nullptr, block.cells[9U].get());
+   shet.pasteBlock(block, 0U, 0U, 18277U, 999999998U);
+   shet.recalc(context);
+   EXPECT_EQ(nullptr, shet.getCellAt(4U, 0U));
+   EXPECT_EQ(dm_double_fromdouble(9.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 0U)->previousValue)->value);
+   EXPECT_EQ(dm_double_fromdouble(10.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(0U, 1U)->previousValue)->value);
+   EXPECT_EQ(dm_double_fromdouble(90.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(1U, 0U)->previousValue)->value);
+   EXPECT_EQ("A1*$A$2", shet.getCellAt(1U, 0U)->value->toString(1U, 0U));
+
+      // Pasting stops at the edge of the sheet.
+   Forwards::Engine::Expression* formula = shet.getCellAt(1U, 1U)->value.get();
+   shet.pasteBlock(block, 1U, 0U, 2U, 0U);
+   EXPECT_EQ(shet.getCellAt(0U, 0U)->value.get(), shet.getCellAt(1U, 0U)->value.get());
+   EXPECT_EQ(formula, shet.getCellAt(2U, 0U)->value.get());
+   EXPECT_EQ(formula, shet.getCellAt(1U, 1U)->value.get());
+   EXPECT_EQ(nullptr, shet.getCellAt(3U, 0U));
+
+      // A formula that doesn't parse is copied as typed, and doesn't clear the cells it is pasted over.
+   shet.initCellAt(5U, 0U);
+   shet.getCellAt(5U, 0U)->type = Forwards::Engine::VALUE;
+   shet.getCellAt(5U, 0U)->currentInput = "1+";
+   shet.initCellAt(6U, 0U);
+   shet.getCellAt(6U, 0U)->type = Forwards::Engine::VALUE;
+   shet.getCellAt(6U, 0U)->currentInput = "5";
+   shet.recalc(context);
+   ASSERT_EQ(nullptr, shet.getCellAt(5U, 0U)->value.get());
+   shet.fillRight(5U, 0U, 6U, 0U);
+   shet.pasteBlock(shet.yankBlock(5U, 0U, 5U, 0U), 5U, 2U, 18277U, 999999998U);
+   shet.recalc(context);
+   for (const Forwards::Engine::Cell* cell : { shet.getCellAt(6U, 0U), shet.getCellAt(5U, 2U) })
+    {
+      ASSERT_NE(nullptr, cell);
+      EXPECT_EQ(Forwards::Engine::VALUE, cell->type);
+      EXPECT_EQ("1+", cell->currentInput);
+      EXPECT_EQ(nullptr, cell->value.get());
+    }
+ }
+
+TEST(EngineTests, testSpreadSheet_ParseAll)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Parser::StringLogger logger;
+   context.logger = &logger;
+
+   Forwards::Engine::SpreadSheet shet;
+   context.theSheet = &shet;
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global); // Create the global scope before the table.
+   Backwards::Parser::GetterSetter gs;
+   Backwards::Parser::SymbolTable table (gs, global);
+
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+   Backwards::Input::StringInput lib ("set TWICE to function (x) is return EvalCell(x[0]) * 2 end");
+   Backwards::Input::Lexer lexer (lib, "Library");
+   std::shared_ptr<Backwards::Engine::Statement> stdLib = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+   ASSERT_NE(nullptr, stdLib.get());
+   stdLib->execute(context);
+   map.insert(std::make_pair("TWICE", table.getVariableGetter("TWICE")));
+
+      // As a sheet is after loading: nothing parsed yet.
+   for (size_t row = 0U; row < 500U; ++row)
+    {
+      const std::string name = std::to_string(row + 1U);
+      shet.initCellAt(0U, row);
+      shet.getCellAt(0U, row)->type = Forwards::Engine::VALUE;
+      shet.getCellAt(0U, row)->currentInput = name;
+      shet.initCellAt(1U, row);
+      shet.getCellAt(1U, row)->type = Forwards::Engine::VALUE;
+      shet.getCellAt(1U, row)->currentInput = "@TWICE(A" + name + ")+$A$1";
+      shet.initCellAt(2U, row);
+      shet.getCellAt(2U, row)->type = Forwards::Engine::LABEL;
+      shet.getCellAt(2U, row)->currentInput = "Label " + name;
+    }
+   shet.initCellAt(3U, 0U);
+   shet.getCellAt(3U, 0U)->type = Forwards::Engine::VALUE;
+   shet.getCellAt(3U, 0U)->currentInput = "@THRICE(A1)";
+   shet.initCellAt(3U, 1U);
+   shet.getCellAt(3U, 1U)->type = Forwards::Engine::VALUE;
+   shet.getCellAt(3U, 1U)->currentInput = "1+";
+
+   shet.parseAll(context, 4U);
+
+      // Formulas are parsed, and share trees as they would if recalc had parsed them. Labels are left to recalc.
+   EXPECT_EQ("", shet.getCellAt(1U, 250U)->currentInput);
+   EXPECT_EQ("@TWICE(A251)+$A$1", shet.getCellAt(1U, 250U)->value->toString(1U, 250U));
+   EXPECT_EQ(shet.getCellAt(1U, 100U)->value.get(), shet.getCellAt(1U, 499U)->value.get());
+   EXPECT_NE(shet.getCellAt(1U, 98U)->value.get(), shet.getCellAt(1U, 99U)->value.get());
+   EXPECT_EQ(nullptr, shet.getCellAt(2U, 0U)->value.get());
+
+      // Bad formulas are left alone, for recalc to report.
+   EXPECT_EQ(nullptr, shet.getCellAt(3U, 0U)->value.get());
+   EXPECT_EQ("@THRICE(A1)", shet.getCellAt(3U, 0U)->currentInput);
+   EXPECT_EQ(nullptr, shet.getCellAt(3U, 1U)->value.get());
+   EXPECT_EQ("1+", shet.getCellAt(3U, 1U)->currentInput);
+
+   shet.recalc(context);
+   for (size_t row = 0U; row < 500U; ++row)
+    {
+      EXPECT_EQ(dm_double_fromdouble(2.0 * (row + 1U) + 1.0), std::dynamic_pointer_cast<Forwards::Types::FloatValue>(shet.getCellAt(1U, row)->previousValue)->value);
+    }
+   EXPECT_EQ("Label 7", std::dynamic_pointer_cast<Forwards::Types::StringValue>(shet.getCellAt(2U, 6U)->previousValue)->value);
+   EXPECT_EQ(nullptr, shet.getCellAt(3U, 0U)->previousValue.get());
+
+      // Running it again finds nothing to do, and a single thread gives the same trees.
+   const Forwards::Engine::Expression* before = shet.getCellAt(1U, 3U)->value.get();
+   shet.parseAll(context, 1U);
+   EXPECT_EQ(before, shet.getCellAt(1U, 3U)->value.get());
+ }
+
+TEST(EngineTests, testSpreadSheet_ParseAllMatchesRecalc)
+ {
+   Forwards::Engine::CallingContext context;
+   Forwards::Parser::StringLogger logger;
+   context.logger = &logger;
+
+   Backwards::Engine::Scope global;
+   context.globalScope = &global;
+   Backwards::Parser::ContextBuilder::createGlobalScope(global);
+
+   Forwards::Engine::GetterMap map;
+   context.map = &map;
+
+      // Good formulas, and every kind of bad one, mixed through the sheet.
+   const char* formulas [] = { "A1+B1", "1+", "@NOPE(A1)", "(A1", "@SUM(A1:A3)*2", "2*", "\"x", "C1-1", "@IF(A1>1;2;3)" };
+   Forwards::Engine::SpreadSheet parallel;
+   Forwards::Engine::SpreadSheet serial;
+   for (Forwards::Engine::SpreadSheet* shet : { &parallel, &serial })
+    {
+      for (size_t row = 0U; row < 300U; ++row)
+       {
+         shet->initCellAt(0U, row);
+         shet->getCellAt(0U, row)->type = Forwards::Engine::VALUE;
+         shet->getCellAt(0U, row)->currentInput = std::to_string(row);
+         for (size_t col = 1U; col < 4U; ++col)
+          {
+            shet->initCellAt(col, row);
+            shet->getCellAt(col, row)->type = Forwards::Engine::VALUE;
+            shet->getCellAt(col, row)->currentInput = formulas[(row * 3U + col) % (sizeof(formulas) / sizeof(formulas[0]))];
+          }
+       }
+    }
+
+   context.theSheet = &parallel;
+   parallel.parseAll(context, 8U);
+   parallel.recalc(context);
+   context.theSheet = &serial;
+   serial.recalc(context);
+
+   size_t failed = 0U;
+   for (size_t col = 0U; col < 4U; ++col)
+    {
+      for (size_t row = 0U; row < 300U; ++row)
+       {
+         const Forwards::Engine::Cell& lhs = *parallel.getCellAt(col, row);
+         const Forwards::Engine::Cell& rhs = *serial.getCellAt(col, row);
+         EXPECT_EQ(rhs.currentInput, lhs.currentInput);
+         ASSERT_EQ(nullptr == rhs.value.get(), nullptr == lhs.value.get());
+         failed += (nullptr == rhs.value.get()) ? 1U : 0U;
+         if (nullptr != rhs.value.get())
+          {
+            EXPECT_EQ(rhs.value->toString(col, row), lhs.value->toString(col, row));
+          }
+         ASSERT_EQ(nullptr == rhs.previousValue.get(), nullptr == lhs.previousValue.get());
+         if (nullptr != rhs.previousValue.get())
+          {
+            EXPECT_EQ(rhs.previousValue->toString(col, row), lhs.previousValue->toString(col, row));
+          }
+       }
+    }
+   EXPECT_LT(0U, failed);
+   EXPECT_GT(1200U, failed);
+   EXPECT_EQ("1+", parallel.getCellAt(1U, 0U)->currentInput);
+ }
+
+TEST(EngineTests, testSpreadSheet_TwoAtOnce)
+ {
+   const char* fact = "set F to function fact (n) is if n < 2 then return 1 end return n * fact(n - 1) end "
+      "set FACT to function (x) is return F(EvalCell(x[0])) end";
+
+   (void) Backwards::Parser::CycleCollector::collect(); // Whatever the other tests left behind.
+
+      // A function that calls itself, which nothing else refers to any more.
+   std::weak_ptr<Backwards::Engine::FunctionContext> orphan;
+    {
+      Backwards::Engine::CallingContext context;
+      Forwards::Parser::StringLogger logger;
+      context.logger = &logger;
+      Backwards::Engine::Scope global;
+      context.globalScope = &global;
+      Backwards::Parser::ContextBuilder::createGlobalScope(global);
+      Backwards::Parser::GetterSetter gs;
+      Backwards::Parser::SymbolTable table (gs, global);
+      Backwards::Input::StringInput lib (fact);
+      Backwards::Input::Lexer lexer (lib, "Library");
+      std::shared_ptr<Backwards::Engine::Statement> stdLib = Backwards::Parser::Parser::ParseFunctions(lexer, table, logger);
+      ASSERT_NE(nullptr, stdLib.get());
+      stdLib->execute(context);
+      orphan = std::dynamic_pointer_cast<Backwards::Engine::FunctionContext>(
+         std::static_pointer_cast<Backwards::Types::FunctionValue>(global.vars[global.var.find("F")->second])->value);
+    }
+   EXPECT_FALSE(orphan.expired());
+
+   class Sheet final
+    {
+   public:
+      Forwards::Engine::CallingContext context;
+      Forwards::Parser::StringLogger logger;
+      Forwards::Engine::SpreadSheet shet;
+      Backwards::Engine::Scope global;
+      Backwards::Parser::GetterSetter gs;
+      std::shared_ptr<Backwards::Parser::SymbolTable> table;
+      Forwards::Engine::GetterMap map;
+      size_t wrong;
+    };
+   Sheet sheets [2];
+   for (Sheet& sheet : sheets)
+    {
+      sheet.context.logger = &sheet.logger;
+      sheet.context.theSheet = &sheet.shet;
+      sheet.context.globalScope = &sheet.global;
+      Backwards::Parser::ContextBuilder::createGlobalScope(sheet.global);
+      sheet.table = std::make_shared<Backwards::Parser::SymbolTable>(sheet.gs, sheet.global);
+      sheet.context.map = &sheet.map;
+      Backwards::Input::StringInput lib (fact);
+      Backwards::Input::Lexer lexer (lib, "Library");
+      std::shared_ptr<Backwards::Engine::Statement> stdLib = Backwards::Parser::Parser::ParseFunctions(lexer, *sheet.table, sheet.logger);
+      ASSERT_NE(nullptr, stdLib.get());
+      stdLib->execute(sheet.context);
+      sheet.map.insert(std::make_pair("FACT", sheet.table->getVariableGetter("FACT")));
+      sheet.wrong = 0U;
+
+      for (size_t row = 0U; row < 100U; ++row)
+       {
+         sheet.shet.initCellAt(0U, row);
+         sheet.shet.getCellAt(0U, row)->type = Forwards::Engine::VALUE;
+         sheet.shet.getCellAt(0U, row)->currentInput = std::to_string(row % 10U);
+         sheet.shet.initCellAt(1U, row);
+         sheet.shet.getCellAt(1U, row)->type = Forwards::Engine::VALUE;
+         sheet.shet.getCellAt(1U, row)->currentInput = "@FACT(A" + std::to_string(row + 1U) + ")";
+       }
+    }
+
+      // Each recalculates its own sheet, over and over. Neither may free functions out from under the other.
+   const size_t factorials [10] = { 1U, 1U, 2U, 6U, 24U, 120U, 720U, 5040U, 40320U, 362880U };
+   std::thread threads [2];
+   for (size_t i = 0U; i < 2U; ++i)
+    {
+      threads[i] = std::thread([&sheets, &factorials, i] ()
+       {
+         Sheet& sheet = sheets[i];
+         for (size_t pass = 0U; pass < 20U; ++pass)
+          {
+            sheet.shet.recalc(sheet.context);
+            for (size_t row = 0U; row < 100U; ++row)
+             {
+               std::shared_ptr<Forwards::Types::FloatValue> value = std::dynamic_pointer_cast<Forwards::Types::FloatValue>(sheet.shet.getCellAt(1U, row)->previousValue);
+               if ((nullptr == value.get()) || (dm_double_fromdouble(static_cast<double>(factorials[row % 10U])) != value->value))
+                {
+                  ++sheet.wrong;
+                }
+             }
+          }
+       });
+    }
+   for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+   EXPECT_EQ(0U, sheets[0].wrong);
+   EXPECT_EQ(0U, sheets[1].wrong);
+   EXPECT_EQ(0U, sheets[0].logger.logs.size());
+   EXPECT_EQ(0U, sheets[1].logger.logs.size());
+
+      // Recalculating collected nothing: that is left to whoever knows that nothing else is running.
+   EXPECT_FALSE(orphan.expired());
+   EXPECT_LT(0U, Backwards::Parser::CycleCollector::collect());
+   EXPECT_TRUE(orphan.expired());
+ }
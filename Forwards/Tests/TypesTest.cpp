@@ -150,3 +150,32 @@ TEST(TypesTests, testCellRange)
    EXPECT_EQ(Forwards::Types::CELL_RANGE, low.getType());
    EXPECT_EQ(Forwards::Types::CELL_RANGE, med.getType());
  }
+
+TEST(TypesTests, testSharedWithBackwards)
+ {
+   Forwards::Types::FloatValue made (dm_double_fromdouble(2.5));
+   std::shared_ptr<Backwards::Types::FloatValue> first = made.shared();
+   EXPECT_EQ(dm_double_fromdouble(2.5), first->value);
+   EXPECT_EQ(first.get(), made.shared().get());
+
+   std::shared_ptr<Backwards::Types::FloatValue> back = std::make_shared<Backwards::Types::FloatValue>(dm_double_fromdouble(7.5));
+   Forwards::Types::FloatValue wrapped (back);
+   EXPECT_EQ(dm_double_fromdouble(7.5), wrapped.value);
+   EXPECT_EQ(back.get(), wrapped.shared().get());
+
+   Forwards::Types::StringValue text ("Hello");
+   std::shared_ptr<Backwards::Types::StringValue> shared = text.shared();
+   EXPECT_EQ(text.holder.get(), shared->holder.get());
+   EXPECT_EQ(shared.get(), text.shared().get());
+
+   Forwards::Types::StringValue copied (text);
+   EXPECT_EQ(shared.get(), copied.shared().get());
+
+   std::shared_ptr<Backwards::Types::StringValue> backText = std::make_shared<Backwards::Types::StringValue>("World");
+   Forwards::Types::StringValue wrappedText (backText);
+   EXPECT_EQ("World", wrappedText.value);
+   EXPECT_EQ(backText.get(), wrappedText.shared().get());
+
+   EXPECT_EQ(Forwards::Types::NilValue::make().get(), Forwards::Types::NilValue::make().get());
+   EXPECT_EQ(Backwards::Types::NilValue::make().get(), Forwards::Types::NilValue::make()->shared().get());
+ }
@@ -33,6 +33,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define FORWARDS_ENGINE_CALLINGCONTEXT_H
 
 #include "Backwards/Engine/CallingContext.h"
+#include "Backwards/Engine/Budget.h"
+#include "Backwards/Engine/MemoCache.h"
+#include "Backwards/Engine/Profiler.h"
+#include "Backwards/Engine/Sampler.h"
 
 #include <vector>
 
@@ -66,9 +70,18 @@ namespace Engine
       SpreadSheet* theSheet;
       GetterMap* map;
 
+         // Limits on a whole recalc, and on each cell. Set recalcBudget.cancelled to stop a recalc.
+         // A call answered by memoCache is charged the steps it first took, so a cell runs out whether or not another cell made the call before it.
+      Backwards::Engine::Budget recalcBudget;
+      Backwards::Engine::Budget cellBudget;
+
+         // The calls to pure functions remembered during a recalc.
+      Backwards::Engine::MemoCache memoCache;
+
       CellFrame* topCell();
       void pushCell(CellFrame* cell);
       void popCell();
+      const std::vector<CellFrame*>& allCells() const;
 
       virtual std::shared_ptr<Backwards::Engine::CallingContext> duplicate(); // This function exists for the debugger.
 
@@ -79,6 +92,21 @@ namespace Engine
       virtual void duplicate(std::shared_ptr<CallingContext>);
     };
 
+    // A Profiler that attributes each call to the cell whose evaluation made it.
+   class CellProfiler final : public Backwards::Engine::Profiler
+    {
+   public:
+      std::string site (Backwards::Engine::CallingContext&) const;
+    };
+
+    // A Sampler that puts the cells being evaluated at the root of each stack.
+   class CellSampler final : public Backwards::Engine::Sampler
+    {
+   public:
+      explicit CellSampler(std::chrono::steady_clock::duration interval);
+      void outer (Backwards::Engine::CallingContext&, std::vector<std::string>&) const;
+    };
+
  } // namespace Engine
 
  } // namespace Forwards
@@ -56,6 +56,7 @@ namespace Engine
       virtual bool notEqual (const Backwards::Types::CellRefValue& lhs) const;
       virtual bool sort (const Backwards::Types::CellRefValue& lhs) const;
       virtual size_t hash() const;
+      virtual std::shared_ptr<Backwards::Types::ValueType> key (Backwards::Engine::CallingContext&) const;
     };
 
  } // namespace Engine
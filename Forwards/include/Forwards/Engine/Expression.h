@@ -33,7 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define FORWARDS_ENGINE_EXPRESSION_H
 
 #include "Forwards/Engine/CallingContext.h"
-#include "Forwards/Input/Token.h"
+#include "Forwards/Input/TokenHandle.h"
 #include "Forwards/Types/ValueType.h"
 #include "Backwards/Types/ValueType.h"
 #include "Backwards/Engine/Expression.h"
@@ -55,9 +55,9 @@ namespace Engine
    class Expression
     {
    public:
-      Input::Token token;
+      Input::TokenHandle token;
 
-      Expression(const Input::Token&);
+      Expression(const Input::TokenHandle&);
       virtual ~Expression() = default;
 
        /* CallingContext can't be const, because if we propagate it
@@ -65,7 +65,7 @@ namespace Engine
       virtual std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const = 0;
       virtual std::string toString(size_t, size_t, int level = 0) const = 0;
 
-      static std::string constructMessage(const std::string&, const Input::Token&);
+      static std::string constructMessage(const std::string&, const Input::TokenHandle&);
       std::string constructMessage(const std::string&) const;
 
       static std::shared_ptr<Types::FloatValue> FLOAT_ONE();
@@ -77,12 +77,12 @@ namespace Engine
    public:
       std::shared_ptr<Types::ValueType> value;
 
-      Constant(const Input::Token&, const std::shared_ptr<Types::ValueType>&);
+      Constant(const Input::TokenHandle&, const std::shared_ptr<Types::ValueType>&);
 
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const;
       std::string toString(size_t, size_t, int) const;
 
-      static std::shared_ptr<Types::ValueType> finalConst(std::shared_ptr<Types::CellRefValue>, CallingContext&, const Input::Token&);
+      static std::shared_ptr<Types::ValueType> finalConst(std::shared_ptr<Types::CellRefValue>, CallingContext&, const Input::TokenHandle&);
     };
 
 #define FFBinaryOperation(x) \
@@ -90,7 +90,7 @@ namespace Engine
     { \
    public: \
       std::shared_ptr<Expression> lhs, rhs; \
-      x(const Input::Token&, const std::shared_ptr<Expression>&, const std::shared_ptr<Expression>&); \
+      x(const Input::TokenHandle&, const std::shared_ptr<Expression>&, const std::shared_ptr<Expression>&); \
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const override; \
       std::string toString(size_t, size_t, int) const override; \
     };
@@ -114,7 +114,7 @@ namespace Engine
     { \
    public: \
       std::shared_ptr<Expression> arg; \
-      x(const Input::Token&, const std::shared_ptr<Expression>&); \
+      x(const Input::TokenHandle&, const std::shared_ptr<Expression>&); \
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const override; \
       std::string toString(size_t, size_t, int) const override; \
     };
@@ -129,7 +129,11 @@ namespace Engine
       std::shared_ptr<Backwards::Engine::Expression> location;
       std::vector<std::shared_ptr<Expression> > args;
 
-      FunctionCall(const Input::Token&, const std::shared_ptr<Backwards::Engine::Expression>&, const std::vector<std::shared_ptr<Expression> >&);
+      FunctionCall(const Input::TokenHandle&, const std::shared_ptr<Backwards::Engine::Expression>&, const std::vector<std::shared_ptr<Expression> >&);
+
+       // The Backwards call, with its single argument (the array of CellRefs to args), built once here rather than on every evaluation.
+       // Values are immutable, so every evaluation can share it.
+      std::shared_ptr<Backwards::Engine::FunctionCall> call;
 
       std::shared_ptr<Types::ValueType> evaluate (CallingContext&) const override;
       std::string toString(size_t, size_t, int) const override;
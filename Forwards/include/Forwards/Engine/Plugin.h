@@ -0,0 +1,139 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef FORWARDS_ENGINE_PLUGIN_H
+#define FORWARDS_ENGINE_PLUGIN_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Backwards/Engine/Statement.h"
+
+   /*
+      A plugin is a shared object given to DeciCalc with "-p". When loaded, its FORWARDS_PLUGIN_INIT
+      function is called with the version of this header it is being loaded by and a registry to add
+      its functions to. It returns zero if it cannot work with that version. If it returns zero or throws,
+      none of the functions that it added are kept.
+
+      A native function is called with the expressions that are its arguments, unevaluated, so that it
+      can skip those it doesn't need. Evaluating an argument gives a Forwards FloatValue, StringValue,
+      NilValue, or CellRangeValue; use CellValue to read the cells of a range. Throw a
+      Backwards::Types::TypedOperationException to report an error in the cell.
+
+      A plugin uses the code of the program that loads it, and so must be built with the same compiler
+      and these same headers.
+   */
+#define FORWARDS_PLUGIN_VERSION 1
+#define FORWARDS_PLUGIN_INIT "ForwardsPluginInit"
+
+namespace Backwards
+ {
+namespace Engine
+ {
+   class Scope;
+ }
+namespace Parser
+ {
+   class SymbolTable;
+ }
+ }
+
+namespace Forwards
+ {
+
+namespace Types
+ {
+   class ValueType;
+ }
+
+namespace Engine
+ {
+
+   class CallingContext;
+   class Expression;
+
+   typedef std::shared_ptr<Types::ValueType> (*NativeFunction) (CallingContext&, const std::vector<std::shared_ptr<Expression> >&);
+
+   class PluginRegistry
+    {
+   public:
+      virtual ~PluginRegistry();
+
+         // As with Backwards libraries, only ALL-CAPS names can be called from a cell.
+      virtual void addFunction (const std::string& name, NativeFunction function) = 0;
+    };
+
+    // Adds native functions to the global scope through the symbol table that libraries are parsed with.
+    // The functions are held until commit(), so that a plugin that fails partway through leaves nothing behind:
+    // a global can't be taken back out of the table once it is in.
+   class ScopeRegistry final : public PluginRegistry
+    {
+   public:
+      ScopeRegistry(Backwards::Parser::SymbolTable&, Backwards::Engine::Scope&);
+
+      void addFunction (const std::string& name, NativeFunction function);
+      void commit (void);
+
+   private:
+      Backwards::Parser::SymbolTable& table;
+      Backwards::Engine::Scope& global;
+      std::vector<std::pair<std::string, NativeFunction> > pending;
+    };
+
+    // The body of a native function. A Forwards FunctionCall calls it directly; as a Statement, it takes the array of CellRefs to the arguments.
+   class NativeCall final : public Backwards::Engine::Statement
+    {
+   public:
+      NativeFunction function;
+
+      explicit NativeCall(NativeFunction function);
+
+      std::shared_ptr<Backwards::Engine::FlowControl> execute (Backwards::Engine::CallingContext&) const;
+
+         // Never returns null or a CellRefValue.
+      std::shared_ptr<Types::ValueType> call (CallingContext&, const std::vector<std::shared_ptr<Expression> >&) const;
+    };
+
+    // The value of the cell at (col, row), evaluated if need be. An empty cell is Nil.
+   std::shared_ptr<Types::ValueType> CellValue (CallingContext&, size_t col, size_t row);
+
+ } // namespace Engine
+
+ } // namespace Forwards
+
+extern "C"
+ {
+   typedef int (*ForwardsPluginInitFunction) (int version, Forwards::Engine::PluginRegistry* registry);
+ }
+
+#endif /* FORWARDS_ENGINE_PLUGIN_H */
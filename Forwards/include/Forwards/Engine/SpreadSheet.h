@@ -34,6 +34,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 namespace Forwards
  {
@@ -48,6 +50,23 @@ namespace Engine
 
    class CallingContext;
    class Cell;
+   class Expression;
+
+   /*
+      A rectangle of cells, as yanked from the sheet. The copies share their trees with the cells they came from:
+      trees hold cell references relative to the cell that holds them, so the same tree is correct wherever it is pasted.
+      A cell with no tree, such as a formula that doesn't parse, is copied as it was typed, and parsed again where it lands.
+   */
+   class CellBlock final
+    {
+   public:
+      size_t cols;
+      size_t rows;
+         // Column by column. Empty cells are nullptr.
+      std::vector<std::shared_ptr<Cell> > cells;
+
+      CellBlock() : cols(0U), rows(0U) { }
+    };
 
    class SpreadSheet final
     {
@@ -68,8 +87,26 @@ namespace Engine
       void initCellAt(size_t col, size_t row);
       void removeCellAt(size_t col, size_t row);
 
+         // The corners can be given in any order. Pasting and filling don't recalc: do that once, after.
+      CellBlock yankBlock(size_t col1, size_t row1, size_t col2, size_t row2);
+      void pasteBlock(const CellBlock&, size_t col, size_t row, size_t max_col, size_t max_row);
+      void fillDown(size_t col1, size_t row1, size_t col2, size_t row2);
+      void fillRight(size_t col1, size_t row1, size_t col2, size_t row2);
+
+         // Parses every formula that hasn't been yet, on up to threads threads, so that the first recalc doesn't have to.
+         // Formulas that fail to parse are left for recalc to report. Nothing else may be using the sheet while this runs.
+         // Anything else that a parse throws is thrown from here, once every thread has stopped, with no cell changed.
+      void parseAll(CallingContext&, size_t threads);
+
       std::string computeCell(CallingContext&, std::shared_ptr<Types::ValueType>& OUT, size_t col, size_t row, bool rethrow);
       void recalc(CallingContext&);
+
+   private:
+         // Parsed formulas, by Parser::TemplateKey, so that a formula filled down a column is parsed once and shared.
+      std::unordered_map<std::string, std::weak_ptr<Expression> > templates;
+
+      std::shared_ptr<Expression> cellExpression(CallingContext&, Cell*, size_t col, size_t row, std::string& error);
+      void schedule(CallingContext&, size_t col, size_t row);
     };
 
  } // namespace Engine
@@ -34,7 +34,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Forwards/Input/Lexemes.h"
 #include "Forwards/Input/Token.h"
-#include "Backwards/Input/BufferedGenericInput.h"
+#include "Backwards/Input/GenericInput.h"
+
+#include <string>
 
 namespace Forwards
  {
@@ -42,19 +44,32 @@ namespace Forwards
 namespace Input
  {
 
+    /*
+      A formula is one short line, so the lexer works straight from the characters of it,
+      rather than asking a GenericInput for them one at a time.
+      Given a string, it scans the caller's buffer, which must outlive the lexer.
+      Given a GenericInput, it reads all of it first, into a buffer of its own.
+    */
    class Lexer /* Lex Me Up, Scotty */ final
     {
 
    private:
-      Backwards::Input::BufferedGenericInput input; // Input mechanism.
-      size_t curChar; // Current character.
+      std::string owned; // The buffer, when the input came from a GenericInput.
+      const char* buffer; // Input mechanism.
+      size_t length;
+      size_t pos; // Offset of the current character.
+      size_t base; // Location of the first character.
 
       Token nextToken; // The next token that will be returned.
 
        /*
-         Internal functions for operating on buffered input.
+         Internal functions for operating on the buffer.
        */
-      void consume (void);
+      int peek (size_t lookahead = 0U) const
+       {
+         return ((pos + lookahead) < length) ? static_cast<unsigned char>(buffer[pos + lookahead]) : Backwards::Input::ENDOFFILE;
+       }
+      void consume (void) { if (pos < length) ++pos; }
       void consumeWhiteSpace (void);
 
       void get_NextToken (void); // Updates nextToken.
@@ -63,10 +78,15 @@ namespace Input
 
    public:
 
-      Token peekNextToken (void) { return nextToken; }
+      const Token& peekNextToken (void) const { return nextToken; }
       Token getNextToken (void); // Returns nextToken and then updates nextToken.
 
       Lexer (Backwards::Input::GenericInput& input, size_t location = 1U);
+      Lexer (const std::string& input, size_t location = 1U);
+      Lexer (std::string&&, size_t = 1U) = delete; // The lexer keeps a pointer into the string.
+
+      Lexer(const Lexer&) = delete;
+      Lexer& operator=(const Lexer&) = delete;
 
     };
 
@@ -35,6 +35,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Forwards/Input/Lexemes.h"
 
 #include <string>
+#include <utility>
 
 namespace Forwards
  {
@@ -52,7 +53,7 @@ namespace Input
       size_t location;
 
       Token(Lexeme lexeme, std::string text, size_t loc) :
-         lexeme(lexeme), text(text), location(loc) { }
+         lexeme(lexeme), text(std::move(text)), location(loc) { }
 
       Token() : lexeme(INVALID), text(), location(0U) { }
 
@@ -0,0 +1,81 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef FORWARDS_INPUT_TOKENHANDLE_H
+#define FORWARDS_INPUT_TOKENHANDLE_H
+
+#include "Forwards/Input/Token.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace Forwards
+ {
+
+namespace Input
+ {
+
+    /*
+      The same as Backwards::Input::TokenHandle, for formula tokens.
+      The text is held from the same StringPool, so the same function name in many cells is stored once.
+    */
+   class TokenHandle final
+    {
+   private:
+      std::shared_ptr<const std::string> spelling;
+      uint32_t column;
+      Lexeme kind;
+
+   public:
+      TokenHandle() : spelling(), column(0U), kind(INVALID) { }
+      TokenHandle(const Token&);
+
+      TokenHandle(const TokenHandle &) = default;
+      TokenHandle& operator= (const TokenHandle &) = default;
+
+      Token token() const;
+
+      Lexeme lexeme() const { return kind; }
+      const std::string& text() const;
+      size_t location() const { return column; }
+
+      friend bool operator== (const TokenHandle& lhs, const TokenHandle& rhs)
+       {
+         return (lhs.kind == rhs.kind) && (lhs.column == rhs.column) && (lhs.spelling == rhs.spelling);
+       }
+      friend bool operator!= (const TokenHandle& lhs, const TokenHandle& rhs) { return !(lhs == rhs); }
+    };
+
+ } // namespace Input
+
+ } // namespace Forwards
+
+#endif /* FORWARDS_INPUT_TOKENHANDLE_H */
@@ -66,6 +66,9 @@ namespace Parser
 
       static std::shared_ptr<Engine::Expression> ParseFullExpression (Input::Lexer& src, Engine::GetterMap&, Backwards::Engine::Logger&, size_t, size_t);
 
+       // Two formulas with the same key parse to the same tree: see SpreadSheet::cellExpression.
+      static std::string TemplateKey (Input::Lexer& src, size_t, size_t);
+
    private:
 
       static void expect (Input::Lexer& src, Input::Lexeme expected, const std::string& name);
@@ -77,6 +80,7 @@ namespace Parser
       static std::shared_ptr<Engine::Expression> primary (Input::Lexer& src, Engine::GetterMap&, Backwards::Engine::Logger&, size_t, size_t);
 
       static std::shared_ptr<Engine::Expression> cellref (const Input::Token&, size_t, size_t);
+      static void relativeRef (const std::string&, size_t, size_t, bool&, int64_t&, bool&, int64_t&);
     };
 
  } // namespace Parser
@@ -35,6 +35,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "dm_double.h"
 #include "Forwards/Types/ValueType.h"
 
+#include "Backwards/Types/FloatValue.h"
+
+#include <memory>
+
 namespace Forwards
  {
 
@@ -49,11 +53,18 @@ namespace Types
 
       FloatValue();
       FloatValue(dm_double value);
+      explicit FloatValue(const std::shared_ptr<Backwards::Types::FloatValue>& shared);
 
       const std::string& getTypeName() const override;
       std::string toString(size_t, size_t) const override;
       ValueTypes getType() const override;
 
+       // This value for library code: the Backwards value it was made from, or one made on first use and kept.
+      std::shared_ptr<Backwards::Types::FloatValue> shared() const;
+
+   private:
+      mutable std::shared_ptr<Backwards::Types::FloatValue> twin;
+
     };
 
  } // namespace Types
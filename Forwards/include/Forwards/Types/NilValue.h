@@ -34,6 +34,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Forwards/Types/ValueType.h"
 
+#include "Backwards/Types/NilValue.h"
+
+#include <memory>
+
 namespace Forwards
  {
 
@@ -51,6 +55,10 @@ namespace Types
       std::string toString(size_t, size_t) const override;
       ValueTypes getType() const override;
 
+       // Nil is immutable and all alike, so these can always be shared.
+      static std::shared_ptr<NilValue> make();
+      std::shared_ptr<Backwards::Types::NilValue> shared() const;
+
     };
 
  } // namespace Types
@@ -34,6 +34,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Forwards/Types/ValueType.h"
 
+#include "Backwards/Types/StringValue.h"
+
 #include <string>
 
 namespace Forwards
@@ -46,15 +48,28 @@ namespace Types
     {
 
    public:
-      std::string value;
+      const std::shared_ptr<const Backwards::Types::StringHolder> holder;
+      const std::string& value;
 
       StringValue();
       StringValue(const std::string& value);
+      StringValue(const char* value);
+      StringValue(const std::shared_ptr<const Backwards::Types::StringHolder>& holder);
+      explicit StringValue(const std::shared_ptr<Backwards::Types::StringValue>& shared);
+      StringValue(const StringValue& src);
+
+      StringValue& operator=(const StringValue&) = delete;
 
       const std::string& getTypeName() const override;
       std::string toString(size_t, size_t) const override;
       ValueTypes getType() const override;
 
+       // This value for library code: the Backwards value it was made from, or one made on first use and kept.
+      std::shared_ptr<Backwards::Types::StringValue> shared() const;
+
+   private:
+      mutable std::shared_ptr<Backwards::Types::StringValue> twin;
+
     };
 
  } // namespace Types
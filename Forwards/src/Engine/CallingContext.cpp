@@ -30,6 +30,7 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "Forwards/Engine/CallingContext.h"
+#include "Forwards/Types/ValueType.h"
 
 namespace Forwards
  {
@@ -60,6 +61,11 @@ namespace Engine
       cells.pop_back();
     }
 
+   const std::vector<CellFrame*>& CallingContext::allCells() const
+    {
+      return cells;
+    }
+
    std::shared_ptr<Backwards::Engine::CallingContext> CallingContext::duplicate()
     {
       std::shared_ptr<CallingContext> result = std::make_shared<CallingContext>();
@@ -75,6 +81,36 @@ namespace Engine
       result->pushCell(topCell());
     }
 
+   std::string CellProfiler::site (Backwards::Engine::CallingContext& context) const
+    {
+      CallingContext* cellContext = dynamic_cast<CallingContext*>(&context);
+      if ((nullptr == cellContext) || (nullptr == cellContext->topCell()))
+       {
+         return "";
+       }
+      const CellFrame* frame = cellContext->topCell();
+      return Types::ValueType::columnToString(frame->col) + std::to_string(frame->row + 1U);
+    }
+
+   CellSampler::CellSampler(std::chrono::steady_clock::duration interval) : Backwards::Engine::Sampler(interval)
+    {
+    }
+
+   void CellSampler::outer (Backwards::Engine::CallingContext& context, std::vector<std::string>& frames) const
+    {
+      CallingContext* cellContext = dynamic_cast<CallingContext*>(&context);
+      if (nullptr != cellContext)
+       {
+         for (const CellFrame* frame : cellContext->allCells())
+          {
+            if (nullptr != frame) // The debugger's context may start with a null cell.
+             {
+               frames.emplace_back(Types::ValueType::columnToString(frame->col) + std::to_string(frame->row + 1U));
+             }
+          }
+       }
+    }
+
  } // namespace Engine
 
  } // namespace Forwards
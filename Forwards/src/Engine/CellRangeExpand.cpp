@@ -64,7 +64,7 @@ namespace Engine
          result->value.emplace_back(
             std::make_shared<Backwards::Types::CellRefValue>(
                std::make_shared<CellRefEval>(
-                  std::make_shared<Constant>(Input::Token(),
+                  std::make_shared<Constant>(Input::TokenHandle(),
                      std::make_shared<Types::CellRefValue>(true, value->col1, true, value->row1)))));
        }
       else if (value->col1 == value->col2)
@@ -74,7 +74,7 @@ namespace Engine
             result->value.emplace_back(
                std::make_shared<Backwards::Types::CellRefValue>(
                   std::make_shared<CellRefEval>(
-                     std::make_shared<Constant>(Input::Token(),
+                     std::make_shared<Constant>(Input::TokenHandle(),
                         std::make_shared<Types::CellRefValue>(true, value->col1, true, row)))));
           }
        }
@@ -85,7 +85,7 @@ namespace Engine
             result->value.emplace_back(
                std::make_shared<Backwards::Types::CellRefValue>(
                   std::make_shared<CellRefEval>(
-                     std::make_shared<Constant>(Input::Token(),
+                     std::make_shared<Constant>(Input::TokenHandle(),
                         std::make_shared<Types::CellRefValue>(true, col, true, value->row1)))));
           }
        }
@@ -30,6 +30,7 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "Forwards/Engine/CellRefEval.h"
+#include "Forwards/Engine/CallingContext.h"
 #include "Forwards/Types/CellRefValue.h"
 #include "Forwards/Engine/Expression.h"
 
@@ -90,11 +91,11 @@ namespace Engine
          switch (result->getType())
           {
          case Types::FLOAT:
-            return std::make_shared<Backwards::Types::FloatValue>(static_cast<Types::FloatValue&>(*result.get()).value);
+            return static_cast<Types::FloatValue&>(*result.get()).shared();
          case Types::STRING:
-            return std::make_shared<Backwards::Types::StringValue>(static_cast<Types::StringValue&>(*result.get()).value);
+            return static_cast<Types::StringValue&>(*result.get()).shared();
          case Types::NIL:
-            return std::make_shared<Backwards::Types::NilValue>();
+            return Backwards::Types::NilValue::make();
          case Types::CELL_REF:
             throw Backwards::Engine::ProgrammingException("CellRefEval::evaluate did not resolve to a Backwards Type.");
          case Types::CELL_RANGE:
@@ -156,6 +157,48 @@ namespace Engine
       return std::hash<void*>()(value.get());
     }
 
+    /*
+      A reference is remembered as the cell it resolves to from the cell asking, so that A1, $A$1, and A$1
+      are all the same argument wherever they mean the same cell. Anything else is remembered as what it works out to,
+      which the called function will work out again if it isn't remembered; if that fails, it is left to the function to fail.
+    */
+   std::shared_ptr<Backwards::Types::ValueType> CellRefEval::key (Backwards::Engine::CallingContext& context) const
+    {
+      CallingContext* forwards = dynamic_cast<CallingContext*>(&context);
+      if ((nullptr == forwards) || (nullptr == forwards->topCell()))
+       {
+         return std::shared_ptr<Backwards::Types::ValueType>();
+       }
+
+      const Types::CellRefValue* ref = getReferencedCell(value);
+      if (nullptr != ref)
+       {
+         const int64_t col = (true == ref->colAbsolute) ? ref->colRef : static_cast<int64_t>(forwards->topCell()->col) + ref->colRef;
+         const int64_t row = (true == ref->rowAbsolute) ? ref->rowRef : static_cast<int64_t>(forwards->topCell()->row) + ref->rowRef;
+         if ((col < 0) || (row < 0))
+          {
+            return std::shared_ptr<Backwards::Types::ValueType>();
+          }
+         return std::make_shared<Backwards::Types::CellRefValue>(std::make_shared<CellRefEval>(
+            std::make_shared<Constant>(Input::Token(), std::make_shared<Types::CellRefValue>(true, col, true, row))));
+       }
+
+      std::shared_ptr<Backwards::Types::ValueType> result;
+      try
+       {
+         result = evaluate(context);
+       }
+      catch (const Backwards::Types::TypedOperationException&)
+       {
+         return std::shared_ptr<Backwards::Types::ValueType>();
+       }
+      if (Backwards::Types::CELL_RANGE == result->getType())
+       {
+         return std::shared_ptr<Backwards::Types::ValueType>();
+       }
+      return result;
+    }
+
  } // namespace Engine
 
  } // namespace Forwards
@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Forwards/Engine/Cell.h"
 #include "Forwards/Engine/CellRefEval.h"
 #include "Forwards/Engine/CellRangeExpand.h"
+#include "Forwards/Engine/Plugin.h"
 
 #include "Forwards/Types/FloatValue.h"
 #include "Forwards/Types/StringValue.h"
@@ -47,8 +48,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Types/NilValue.h"
 #include "Backwards/Types/CellRefValue.h"
 #include "Backwards/Types/CellRangeValue.h"
+#include "Backwards/Types/FunctionValue.h"
 
 #include "Backwards/Engine/ProgrammingException.h"
+#include "Backwards/Engine/FunctionContext.h"
 
 #include <sstream>
 #include <cmath>
@@ -78,7 +81,7 @@ namespace Engine
       return me;
     }
 
-   Expression::Expression(const Input::Token& token) : token(token)
+   Expression::Expression(const Input::TokenHandle& token) : token(token)
     {
     }
 
@@ -87,27 +90,27 @@ namespace Engine
       return constructMessage(e, token);
     }
 
-   std::string Expression::constructMessage(const std::string& e, const Input::Token& token)
+   std::string Expression::constructMessage(const std::string& e, const Input::TokenHandle& token)
     {
       std::stringstream str;
-      str << e << " at " << token.location;
+      str << e << " at " << token.location();
       throw Backwards::Types::TypedOperationException(str.str());
     }
 
    std::shared_ptr<Types::FloatValue> Expression::FLOAT_ONE()
     {
-      static std::shared_ptr<Types::FloatValue> one = std::make_shared<Types::FloatValue>(dm_double_fromdouble(1.0));
+      static const std::shared_ptr<Types::FloatValue> one = std::make_shared<Types::FloatValue>(dm_double_fromdouble(1.0));
       return one;
     }
 
    std::shared_ptr<Types::FloatValue> Expression::FLOAT_ZERO()
     {
-      static std::shared_ptr<Types::FloatValue> zero = std::make_shared<Types::FloatValue>(dm_double_fromdouble(0.0));
+      static const std::shared_ptr<Types::FloatValue> zero = std::make_shared<Types::FloatValue>(dm_double_fromdouble(0.0));
       return zero;
     }
 
 
-   Constant::Constant(const Input::Token& token, const std::shared_ptr<Types::ValueType>& value) : Expression(token), value(value)
+   Constant::Constant(const Input::TokenHandle& token, const std::shared_ptr<Types::ValueType>& value) : Expression(token), value(value)
     {
     }
 
@@ -126,7 +129,7 @@ namespace Engine
       return value->toString(col, row);
     }
 
-   std::shared_ptr<Types::ValueType> Constant::finalConst (std::shared_ptr<Types::CellRefValue> value, CallingContext& context, const Input::Token& token)
+   std::shared_ptr<Types::ValueType> Constant::finalConst (std::shared_ptr<Types::CellRefValue> value, CallingContext& context, const Input::TokenHandle& token)
     {
          // Determine column and row.
       int64_t col, row;
@@ -161,7 +164,7 @@ namespace Engine
          // If no cell, Nil.
       if (nullptr == cell)
        {
-         return std::make_shared<Types::NilValue>();
+         return Types::NilValue::make();
        }
 
          // If we are currently evaluating this cell, stop.
@@ -170,7 +173,7 @@ namespace Engine
          std::shared_ptr<Types::ValueType> result = cell->previousValue;
          if (nullptr == result.get())
           {
-            result = std::make_shared<Types::NilValue>();
+            result = Types::NilValue::make();
           }
          return result;
        }
@@ -180,14 +183,14 @@ namespace Engine
       (void) context.theSheet->computeCell(context, result, col, row, true);
       if (nullptr == result.get())
        {
-         result = std::make_shared<Types::NilValue>();
+         result = Types::NilValue::make();
        }
       return result;
     }
 
 
 #define OperationConstructor(x) \
-   x::x(const Input::Token& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) : \
+   x::x(const Input::TokenHandle& token, const std::shared_ptr<Expression>& lhs, const std::shared_ptr<Expression>& rhs) : \
       Expression(token), lhs(lhs), rhs(rhs) \
     { \
     }
@@ -1059,7 +1062,7 @@ namespace Engine
     }
 
 
-   Negate::Negate(const Input::Token& token, const std::shared_ptr<Expression>& arg) : Expression(token), arg(arg)
+   Negate::Negate(const Input::TokenHandle& token, const std::shared_ptr<Expression>& arg) : Expression(token), arg(arg)
     {
     }
 
@@ -1089,12 +1092,8 @@ namespace Engine
     }
 
 
-   FunctionCall::FunctionCall(const Input::Token& token, const std::shared_ptr<Backwards::Engine::Expression>& location, const std::vector<std::shared_ptr<Expression> >& args) :
+   FunctionCall::FunctionCall(const Input::TokenHandle& token, const std::shared_ptr<Backwards::Engine::Expression>& location, const std::vector<std::shared_ptr<Expression> >& args) :
       Expression(token), location(location), args(args)
-    {
-    }
-
-   std::shared_ptr<Types::ValueType> FunctionCall::evaluate (CallingContext& context) const
     {
       std::shared_ptr<Backwards::Types::ArrayValue> newArg = std::make_shared<Backwards::Types::ArrayValue>();
       for (std::shared_ptr<Expression> expr : args)
@@ -1104,11 +1103,40 @@ namespace Engine
                std::make_shared<CellRefEval>(expr)));
        }
       std::vector<std::shared_ptr<Backwards::Engine::Expression> > newArgs;
-      newArgs.push_back(std::make_shared<Backwards::Engine::Constant>(Backwards::Input::Token(), newArg));
+      newArgs.push_back(std::make_shared<Backwards::Engine::Constant>(Backwards::Input::TokenHandle(), newArg));
+
+      call = std::make_shared<Backwards::Engine::FunctionCall>(Backwards::Input::TokenHandle(), location, newArgs);
+    }
 
-      Backwards::Engine::FunctionCall call (Backwards::Input::Token(), location, newArgs);
+   static const NativeCall* getNative(const Backwards::Types::ValueType& LOC)
+    {
+      if (typeid(Backwards::Types::FunctionValue) == typeid(LOC))
+       {
+         const Backwards::Types::FunctionObjectHolder& fun = *static_cast<const Backwards::Types::FunctionValue&>(LOC).value;
+         if ((typeid(Backwards::Engine::FunctionContext) == typeid(fun)) &&
+            (nullptr != static_cast<const Backwards::Engine::FunctionContext&>(fun).function.get()) &&
+            (typeid(NativeCall) == typeid(*static_cast<const Backwards::Engine::FunctionContext&>(fun).function.get())))
+          {
+            return static_cast<const NativeCall*>(static_cast<const Backwards::Engine::FunctionContext&>(fun).function.get());
+          }
+       }
+      return nullptr;
+    }
+
+   std::shared_ptr<Types::ValueType> FunctionCall::evaluate (CallingContext& context) const
+    {
+         // A native function is given the argument expressions directly, and its result needs no conversion.
+      const NativeCall* native = getNative(*location->evaluate(context));
+      if (nullptr != native)
+       {
+         if (nullptr != context.budget)
+          {
+            context.budget->step();
+          }
+         return native->call(context, args);
+       }
 
-      std::shared_ptr<Backwards::Types::ValueType> returned = call.evaluate(context);
+      std::shared_ptr<Backwards::Types::ValueType> returned = call->evaluate(context);
 
       if (typeid(Backwards::Types::CellRefValue) == typeid(*returned.get()))
        {
@@ -1117,21 +1145,21 @@ namespace Engine
           {
             throw Backwards::Engine::ProgrammingException("CellRefHolder was not a Forward CellRefEval.");
           }
-         returned = temp->evaluate(context);
+         return temp->value->evaluate(context);
        }
 
       std::shared_ptr<Types::ValueType> result;
       if (typeid(Backwards::Types::FloatValue) == typeid(*returned.get()))
        {
-         result = std::make_shared<Types::FloatValue>(static_cast<Backwards::Types::FloatValue*>(returned.get())->value);
+         result = std::make_shared<Types::FloatValue>(std::static_pointer_cast<Backwards::Types::FloatValue>(returned));
        }
       else if (typeid(Backwards::Types::StringValue) == typeid(*returned.get()))
        {
-         result = std::make_shared<Types::StringValue>(static_cast<Backwards::Types::StringValue*>(returned.get())->value);
+         result = std::make_shared<Types::StringValue>(std::static_pointer_cast<Backwards::Types::StringValue>(returned));
        }
       else if (typeid(Backwards::Types::NilValue) == typeid(*returned.get()))
        {
-         result = std::make_shared<Types::NilValue>();
+         result = Types::NilValue::make();
        }
       else if (typeid(Backwards::Types::CellRangeValue) == typeid(*returned.get()))
        {
@@ -1144,14 +1172,14 @@ namespace Engine
        }
       else
        {
-         throw Backwards::Engine::ProgrammingException("Call to function " + token.text + " returned invalid type");
+         throw Backwards::Engine::ProgrammingException("Call to function " + token.text() + " returned invalid type");
        }
       return result;
     }
 
    std::string FunctionCall::toString(size_t col, size_t row, int) const
     {
-      std::string result = "@" + token.text;
+      std::string result = "@" + token.text();
       if (false == args.empty())
        {
          result += "(";
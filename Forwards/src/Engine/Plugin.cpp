@@ -0,0 +1,159 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2023, Thomas DiModica
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "Forwards/Engine/Plugin.h"
+#include "Forwards/Engine/CallingContext.h"
+#include "Forwards/Engine/CellRefEval.h"
+#include "Forwards/Engine/Expression.h"
+#include "Forwards/Engine/SpreadSheet.h"
+
+#include "Forwards/Types/NilValue.h"
+#include "Forwards/Types/CellRefValue.h"
+
+#include "Backwards/Engine/StackFrame.h"
+#include "Backwards/Engine/ProgrammingException.h"
+
+#include "Backwards/Parser/ContextBuilder.h"
+#include "Backwards/Parser/SymbolTable.h"
+
+#include "Backwards/Types/ArrayValue.h"
+#include "Backwards/Types/CellRefValue.h"
+#include "Backwards/Types/ValueType.h"
+
+#include <algorithm>
+
+namespace Forwards
+ {
+
+namespace Engine
+ {
+
+   NativeCall::NativeCall(NativeFunction function) : Statement(Backwards::Input::TokenHandle()), function(function)
+    {
+    }
+
+   std::shared_ptr<Backwards::Engine::FlowControl> NativeCall::execute (Backwards::Engine::CallingContext& context) const
+    {
+      const std::shared_ptr<Backwards::Types::ValueType>& arg = context.currentFrame->args[0U];
+      if (typeid(Backwards::Types::ArrayValue) != typeid(*arg.get()))
+       {
+         throw Backwards::Types::TypedOperationException("Native function was not called from a cell.");
+       }
+
+      std::vector<std::shared_ptr<Expression> > args;
+      for (const std::shared_ptr<Backwards::Types::ValueType>& ref : static_cast<const Backwards::Types::ArrayValue&>(*arg.get()).value)
+       {
+         if ((typeid(Backwards::Types::CellRefValue) != typeid(*ref.get())) ||
+            (typeid(CellRefEval) != typeid(*static_cast<const Backwards::Types::CellRefValue&>(*ref.get()).value.get())))
+          {
+            throw Backwards::Types::TypedOperationException("Native function argument was not a reference to a cell.");
+          }
+         args.emplace_back(static_cast<const CellRefEval&>(*static_cast<const Backwards::Types::CellRefValue&>(*ref.get()).value.get()).value);
+       }
+
+      std::shared_ptr<Types::ValueType> result;
+      try
+       {
+         result = call(dynamic_cast<CallingContext&>(context), args);
+       }
+      catch (const std::bad_cast&)
+       {
+         throw Backwards::Engine::ProgrammingException("Backwards context wasn't Forwards context.");
+       }
+
+         // Hand the Forwards value back as a reference to it, which the FunctionCall unwraps without converting it.
+      return std::make_shared<Backwards::Engine::FlowControl>(token, Backwards::Engine::FlowControl::RETURN, Backwards::Engine::FlowControl::NO_TARGET,
+         std::make_shared<Backwards::Types::CellRefValue>(std::make_shared<CellRefEval>(std::make_shared<Constant>(Input::Token(), result))));
+    }
+
+   std::shared_ptr<Types::ValueType> NativeCall::call (CallingContext& context, const std::vector<std::shared_ptr<Expression> >& args) const
+    {
+      std::shared_ptr<Types::ValueType> result = function(context, args);
+      if (nullptr == result.get())
+       {
+         result = Types::NilValue::make();
+       }
+      else if (Types::CELL_REF == result->getType())
+       {
+         result = Constant::finalConst(std::static_pointer_cast<Types::CellRefValue>(result), context, Input::Token());
+       }
+      return result;
+    }
+
+   PluginRegistry::~PluginRegistry()
+    {
+    }
+
+   ScopeRegistry::ScopeRegistry(Backwards::Parser::SymbolTable& table, Backwards::Engine::Scope& global) : table(table), global(global)
+    {
+    }
+
+   void ScopeRegistry::addFunction (const std::string& name, NativeFunction function)
+    {
+      if (nullptr == function)
+       {
+         throw Backwards::Engine::ProgrammingException("Native function " + name + " is null.");
+       }
+      if ((global.var.end() != global.var.find(name)) ||
+         (pending.end() != std::find_if(pending.begin(), pending.end(), [&name](const std::pair<std::string, NativeFunction>& added) { return name == added.first; })))
+       {
+         throw Backwards::Engine::ProgrammingException("Native function " + name + " is already defined.");
+       }
+      pending.emplace_back(name, function);
+    }
+
+   void ScopeRegistry::commit (void)
+    {
+      for (const std::pair<std::string, NativeFunction>& added : pending)
+       {
+            // Build the function the way the standard library's are, then add it as a variable so that the table has a getter for it.
+         Backwards::Engine::Scope built;
+         Backwards::Parser::ContextBuilder::addFunction(added.first, std::make_shared<NativeCall>(added.second), 1U, built);
+         table.addVariable(added.first);
+         global.vars[global.var.find(added.first)->second] = built.vars[0U];
+       }
+      pending.clear();
+    }
+
+   std::shared_ptr<Types::ValueType> CellValue (CallingContext& context, size_t col, size_t row)
+    {
+      std::shared_ptr<Types::ValueType> result;
+      (void) context.theSheet->computeCell(context, result, col, row, true);
+      if (nullptr == result.get())
+       {
+         result = Types::NilValue::make();
+       }
+      return result;
+    }
+
+ } // namespace Engine
+
+ } // namespace Forwards
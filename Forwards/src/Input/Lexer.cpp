@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <cctype>
 #include <string>
+#include <utility>
 
 namespace Forwards
  {
@@ -41,32 +42,28 @@ namespace Input
  {
 
    Lexer::Lexer (Backwards::Input::GenericInput& input, size_t location) :
-      input(input), curChar(location), nextToken()
+      owned(), buffer(nullptr), length(0U), pos(0U), base(location), nextToken()
     {
+      for (int c = input.getNextCharacter(); Backwards::Input::ENDOFFILE != c; c = input.getNextCharacter())
+       {
+         owned += static_cast<char>(c);
+       }
+      buffer = owned.c_str();
+      length = owned.size();
       get_NextToken();
     }
 
-   void Lexer::consume (void)
+   Lexer::Lexer (const std::string& input, size_t location) :
+      owned(), buffer(input.c_str()), length(input.size()), pos(0U), base(location), nextToken()
     {
-      if (Backwards::Input::ENDOFFILE != input.consume())
-       {
-         ++curChar;
-       }
+      get_NextToken();
     }
 
    void Lexer::consumeWhiteSpace (void)
     {
-      for(;;)
+      while ((pos < length) && ((' ' == buffer[pos]) || ('\t' == buffer[pos])))
        {
-         switch (input.peek())
-          {
-         case ' ':
-         case '\t':
-            consume();
-            break;
-         default:
-            return;
-          }
+         ++pos;
        }
     }
 
@@ -74,44 +71,43 @@ namespace Input
     {
       consumeWhiteSpace();
 
-      int charNo = curChar;
+      const size_t first = pos;
 
       Lexeme tokenType = END_OF_FILE;
       std::string text;
 
-      if (std::isalpha(input.peek())|| ('$' == input.peek()))
+      if (std::isalpha(peek())|| ('$' == peek()))
        { // Read in a cell reference
-         text = static_cast<char>(std::toupper(input.peek()));
-         int alphas = 0;
-         if (std::isalpha(input.peek()))
+         size_t alphas = 0U;
+         if ('$' == peek())
           {
-            ++alphas;
+            consume();
           }
-         consume();
-         while (std::isalpha(input.peek()))
+         while (std::isalpha(peek()))
           {
-            text += static_cast<char>(std::toupper(input.peek()));
             ++alphas;
             consume();
           }
 
-         int nums = 0;
-         if ('$' == input.peek())
+         if ('$' == peek())
           {
-            text += "$";
             consume();
           }
 
-         std::string number;
-         while (std::isdigit(input.peek()))
+         const size_t digits = pos;
+         while (std::isdigit(peek()))
           {
-            text += static_cast<char>(input.peek());
-            number += static_cast<char>(input.peek());
-            ++nums;
             consume();
           }
+         const size_t nums = pos - digits;
+
+         text.assign(buffer + first, pos - first);
+         for (std::string::iterator iter = text.begin(); iter != text.end(); ++iter)
+          {
+            *iter = static_cast<char>(std::toupper(static_cast<unsigned char>(*iter)));
+          }
 
-         if ((alphas > 0) && (alphas < 4) && (nums > 0) && (nums < 10) && (0 != std::stoi(number)))
+         if ((alphas > 0U) && (alphas < 4U) && (nums > 0U) && (nums < 10U) && (std::string::npos != text.find_first_of("123456789", text.size() - nums)))
           {
             tokenType = CELL_REFERENCE;
           }
@@ -120,14 +116,18 @@ namespace Input
             tokenType = INVALID;
           }
        }
-      else if ('@' == input.peek())
+      else if ('@' == peek())
        { // Read in an identifier.
          consume();
-         while (std::isalpha(input.peek()))
+         while (std::isalpha(peek()))
           {
-            text += static_cast<char>(std::toupper(input.peek()));
             consume();
           }
+         text.assign(buffer + first + 1U, pos - first - 1U);
+         for (std::string::iterator iter = text.begin(); iter != text.end(); ++iter)
+          {
+            *iter = static_cast<char>(std::toupper(static_cast<unsigned char>(*iter)));
+          }
          if (false == text.empty())
           {
             tokenType = IDENTIFIER;
@@ -137,63 +137,66 @@ namespace Input
             tokenType = INVALID;
           }
        }
-      else if (std::isdigit(input.peek()) || ('.' == input.peek()) || (',' == input.peek()))
+      else if (std::isdigit(peek()) || ('.' == peek()) || (',' == peek()))
        { // Read in a number
-         while (std::isdigit(input.peek()))
+         while (std::isdigit(peek()))
           {
-            text += static_cast<char>(input.peek());
             consume();
           }
-         if (('.' == input.peek()) || (',' == input.peek()))
+         const size_t point = pos;
+         if (('.' == peek()) || (',' == peek()))
           {
-            text += ".";
             consume();
           }
-         while (std::isdigit(input.peek()))
+         while (std::isdigit(peek()))
           {
-            text += static_cast<char>(input.peek());
             consume();
           }
 
-         if (("." == text) || ("," == text))
+         if ((first == point) && ((first + 1U) == pos))
           {
+            text = ".";
             tokenType = INVALID;
           }
          else
           {
-            if (('e' == input.peek()) || ('E' == input.peek()))
+            if (('e' == peek()) || ('E' == peek()))
              {
-               std::string temp = "e";
                size_t advance = 1U;
 
-               if (('-' == input.peek(advance)) || ('+' == input.peek(advance)))
+               if (('-' == peek(advance)) || ('+' == peek(advance)))
                 {
-                  temp += static_cast<char>(input.peek(advance));
                   ++advance;
                 }
-               while (std::isdigit(input.peek(advance)))
+               const size_t sign = advance;
+               while (std::isdigit(peek(advance)))
                 {
-                  temp += static_cast<char>(input.peek(advance));
                   ++advance;
                 }
 
-               if (("e-" != temp) && ("e+" != temp) && ("e" != temp))
+               if (advance != sign)
                 {
-                  text += temp;
-                  while (0U < advance)
-                   {
-                     consume();
-                     --advance;
-                   }
+                  pos += advance;
                 }
              }
 
+            text.assign(buffer + first, pos - first);
+            if ((point < pos) && (',' == buffer[point]))
+             {
+               text[point - first] = '.';
+             }
+            const size_t exponent = text.find_first_of("eE");
+            if (std::string::npos != exponent)
+             {
+               text[exponent] = 'e';
+             }
+
             tokenType = NUMBER;
           }
        }
       else
        { //DFA for all other tokens
-         switch (input.peek())
+         switch (peek())
           {
          case Backwards::Input::ENDOFFILE:
             text = "END-OF-INPUT";
@@ -226,13 +229,13 @@ namespace Input
             break;
          case '<':
             consume();
-            if ('>' == input.peek())
+            if ('>' == peek())
              {
                consume();
                text = "<>";
                tokenType = INEQUALITY;
              }
-            else if ('=' == input.peek())
+            else if ('=' == peek())
              {
                consume();
                text = "<=";
@@ -246,7 +249,7 @@ namespace Input
             break;
          case '>':
             consume();
-            if ('=' == input.peek())
+            if ('=' == peek())
              {
                consume();
                text = ">=";
@@ -284,14 +287,14 @@ namespace Input
             tokenType = CAT;
             break;
          default:
-            text = static_cast<char>(input.peek());
+            text = static_cast<char>(peek());
             consume();
             tokenType = INVALID;
             break;
           }
        }
 
-      nextToken = Token(tokenType, text, charNo);
+      nextToken = Token(tokenType, std::move(text), base + first);
     }
 
    Token Lexer::getNextToken (void)
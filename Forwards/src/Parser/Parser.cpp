@@ -250,14 +250,16 @@ namespace Parser
             expect(src, Input::CLOSE_PARENS, ")");
           }
 
-         if (scope.end() == scope.find(buildToken.text))
+            // Only find: formulas are parsed on several threads at once when a sheet is loaded.
+         Engine::GetterMap::const_iterator function = scope.find(buildToken.text);
+         if (scope.end() == function)
           {
             std::stringstream str;
             str << "Name >" << buildToken.text << "< is not a function at " << buildToken.location;
             throw ParserException(str.str());
           }
 
-         ret = std::make_shared<Engine::FunctionCall>(buildToken, std::make_shared<Backwards::Engine::Variable>(Backwards::Input::Token(), scope[buildToken.text]), args);
+         ret = std::make_shared<Engine::FunctionCall>(buildToken, std::make_shared<Backwards::Engine::Variable>(Backwards::Input::Token(), function->second), args);
        }
          break;
       case Input::NUMBER:
@@ -283,11 +285,57 @@ namespace Parser
       return ret;
     }
 
+    /*
+      The tree a formula parses to depends on the position of the cell only through its cell references,
+      which are made relative to the cell, and on the location of each token, which error messages give.
+      So the key is every token, with its location, and with each cell reference as it is relative to the cell.
+    */
+   std::string Parser::TemplateKey (Input::Lexer& src, size_t col, size_t row)
+    {
+      std::string result;
+      for (;;)
+       {
+         Input::Token token = src.getNextToken();
+         result += static_cast<char>(token.lexeme);
+         result += std::to_string(token.location);
+         result += ':';
+         if (Input::CELL_REFERENCE == token.lexeme)
+          {
+            bool colAbsolute, rowAbsolute;
+            int64_t colRef, rowRef;
+            relativeRef(token.text, col, row, colAbsolute, colRef, rowAbsolute, rowRef);
+            result += colAbsolute ? '$' : '~';
+            result += std::to_string(colRef);
+            result += rowAbsolute ? '$' : '~';
+            result += std::to_string(rowRef);
+          }
+         else
+          {
+            result += std::to_string(token.text.size());
+            result += ':';
+            result += token.text;
+          }
+         if (Input::END_OF_FILE == token.lexeme)
+          {
+            return result;
+          }
+       }
+    }
+
    std::shared_ptr<Engine::Expression> Parser::cellref (const Input::Token& ref, size_t col, size_t row)
     {
-      bool colAbsolute = false, rowAbsolute = false;
+      bool colAbsolute, rowAbsolute;
       int64_t r_col, r_row;
-      const char * iter = ref.text.c_str();
+      relativeRef(ref.text, col, row, colAbsolute, r_col, rowAbsolute, r_row);
+      return std::make_shared<Engine::Constant>(ref, std::make_shared<Types::CellRefValue>(colAbsolute, r_col, rowAbsolute, r_row));
+    }
+
+    // Relative references are relative to the cell at col, row.
+   void Parser::relativeRef (const std::string& text, size_t col, size_t row, bool& colAbsolute, int64_t& r_col, bool& rowAbsolute, int64_t& r_row)
+    {
+      colAbsolute = false;
+      rowAbsolute = false;
+      const char * iter = text.c_str();
       if ('$' == *iter)
        {
          colAbsolute = true;
@@ -322,21 +370,13 @@ namespace Parser
          ++iter;
        }
       r_row = std::atoll(iter) - 1;
-      if (colAbsolute && rowAbsolute)
+      if (false == colAbsolute)
        {
-         return std::make_shared<Engine::Constant>(ref, std::make_shared<Types::CellRefValue>(colAbsolute, r_col, rowAbsolute, r_row));
+         r_col -= col;
        }
-      else if (colAbsolute)
-       {
-         return std::make_shared<Engine::Constant>(ref, std::make_shared<Types::CellRefValue>(colAbsolute, r_col, rowAbsolute, r_row - row));
-       }
-      else if (rowAbsolute)
-       {
-         return std::make_shared<Engine::Constant>(ref, std::make_shared<Types::CellRefValue>(colAbsolute, r_col - col, rowAbsolute, r_row));
-       }
-      else
+      if (false == rowAbsolute)
        {
-         return std::make_shared<Engine::Constant>(ref, std::make_shared<Types::CellRefValue>(colAbsolute, r_col - col, rowAbsolute, r_row - row));
+         r_row -= row;
        }
     }
 
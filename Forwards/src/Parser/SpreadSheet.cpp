@@ -31,8 +31,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "Forwards/Engine/SpreadSheet.h"
 
+#include "Backwards/Engine/Budget.h"
 #include "Backwards/Engine/Logger.h"
-#include "Backwards/Input/StringInput.h"
+#include "Backwards/Engine/RoundingMode.h"
+#include "Backwards/Input/StringPool.h"
 
 #include "Forwards/Engine/CallingContext.h"
 #include "Forwards/Engine/Cell.h"
@@ -43,6 +45,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Forwards/Types/ValueType.h"
 #include "Forwards/Types/StringValue.h"
+#include "Forwards/Types/FloatValue.h"
+#include "Forwards/Types/CellRefValue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 /*
    This is purposely in Parser because it depends on Parser.
@@ -99,46 +109,288 @@ namespace Engine
        }
     }
 
-   std::string SpreadSheet::computeCell(CallingContext& context, std::shared_ptr<Types::ValueType>& OUT, size_t col, size_t row, bool rethrow)
+   CellBlock SpreadSheet::yankBlock(size_t col1, size_t row1, size_t col2, size_t row2)
     {
-      std::string result;
-      OUT.reset(); // Ensure to clear OUT variable.
+      const size_t left = std::min(col1, col2);
+      const size_t top = std::min(row1, row2);
+      CellBlock result;
+      result.cols = std::max(col1, col2) - left + 1U;
+      result.rows = std::max(row1, row2) - top + 1U;
+      result.cells.reserve(result.cols * result.rows);
+      for (size_t col = left; col < (left + result.cols); ++col)
+       {
+         for (size_t row = top; row < (top + result.rows); ++row)
+          {
+            Cell* cell = getCellAt(col, row);
+            if (nullptr != cell)
+             {
+               std::shared_ptr<Cell> copy = std::make_shared<Cell>();
+               copy->type = cell->type;
+               copy->value = cell->value;
+               if (nullptr == cell->value.get())
+                {
+                  copy->currentInput = cell->currentInput;
+                }
+               result.cells.push_back(copy);
+             }
+            else
+             {
+               result.cells.push_back(std::shared_ptr<Cell>());
+             }
+          }
+       }
+      return result;
+    }
 
-      Cell* cell = getCellAt(col, row);
-      if (nullptr == cell)
+   void SpreadSheet::pasteBlock(const CellBlock& block, size_t col, size_t row, size_t max_col, size_t max_row)
+    {
+      for (size_t i = 0U; (i < block.cols) && ((col + i) <= max_col); ++i)
        {
-         return result;
+         for (size_t j = 0U; (j < block.rows) && ((row + j) <= max_row); ++j)
+          {
+            const std::shared_ptr<Cell>& source = block.cells[i * block.rows + j];
+            if (nullptr == source.get())
+             {
+               removeCellAt(col + i, row + j);
+             }
+            else
+             {
+               Cell* cell = getCellAt(col + i, row + j);
+               if (nullptr == cell)
+                {
+                  initCellAt(col + i, row + j);
+                  cell = getCellAt(col + i, row + j);
+                }
+               cell->type = source->type;
+               cell->currentInput = source->currentInput; // Only kept when there is no tree: recalc parses it here.
+               cell->value = source->value;
+             }
+          }
        }
-      CellFrame newFrame (cell, col, row);
+    }
 
-         // If we have already evaluated this cell this generation, stop.
-      if ((context.generation == cell->previousGeneration) && (context.inUserInput == rethrow))
+   void SpreadSheet::fillDown(size_t col1, size_t row1, size_t col2, size_t row2)
+    {
+      const size_t top = std::min(row1, row2);
+      const size_t bottom = std::max(row1, row2);
+      const CellBlock source = yankBlock(col1, top, col2, top);
+      for (size_t row = top + 1U; row <= bottom; ++row)
        {
-         OUT = cell->previousValue;
-         return result;
+         pasteBlock(source, std::min(col1, col2), row, std::max(col1, col2), bottom);
        }
+    }
 
+   void SpreadSheet::fillRight(size_t col1, size_t row1, size_t col2, size_t row2)
+    {
+      const size_t left = std::min(col1, col2);
+      const size_t right = std::max(col1, col2);
+      const CellBlock source = yankBlock(left, row1, left, row2);
+      for (size_t col = left + 1U; col <= right; ++col)
+       {
+         pasteBlock(source, col, std::min(row1, row2), right, std::max(row1, row2));
+       }
+    }
+
+   static void finishBudget(CallingContext& context, bool ownBudget, Backwards::Engine::Budget* outerBudget)
+    {
+      if (true == ownBudget)
+       {
+         context.cellBudget.finish();
+         context.budget = outerBudget;
+       }
+    }
+
+   std::shared_ptr<Expression> SpreadSheet::cellExpression(CallingContext& context, Cell* cell, size_t col, size_t row, std::string& error)
+    {
          // If this is a LABEL, then set the value.
       std::shared_ptr<Expression> value = cell->value;
       if ((LABEL == cell->type) && (nullptr == cell->value.get()))
        {
          value = std::make_shared<Constant>(Input::Token(), std::make_shared<Types::StringValue>(cell->currentInput));
        }
-         // Else, this is a VALUE, and we need to parse it.
+         // Else, this is a VALUE, and we need to parse it, unless a formula that parses to the same tree already has been.
+         // Trees are never changed once built, so cells can share one.
       if (nullptr == value.get())
        {
-         Backwards::Input::StringInput interlinked (cell->currentInput);
-         Input::Lexer lexer (interlinked);
-         Backwards::Engine::Logger* temp = context.logger;
-         Parser::StringLogger newLogger;
-         context.logger = &newLogger;
-         value = Parser::Parser::ParseFullExpression(lexer, *context.map, *context.logger, col, row);
-         context.logger = temp;
-         if (newLogger.logs.size() > 0U)
+         Input::Lexer keyLexer (cell->currentInput);
+         const std::string key = Parser::Parser::TemplateKey(keyLexer, col, row);
+         std::unordered_map<std::string, std::weak_ptr<Expression> >::iterator found = templates.find(key);
+         if (templates.end() != found)
+          {
+            value = found->second.lock();
+          }
+
+         if (nullptr == value.get())
+          {
+            Input::Lexer lexer (cell->currentInput);
+            Backwards::Engine::Logger* temp = context.logger;
+            Parser::StringLogger newLogger;
+            context.logger = &newLogger;
+            value = Parser::Parser::ParseFullExpression(lexer, *context.map, *context.logger, col, row);
+            context.logger = temp;
+            if (newLogger.logs.size() > 0U)
+             {
+               error = newLogger.logs[0U];
+             }
+            if (nullptr != value.get())
+             {
+               templates[key] = value;
+             }
+          }
+       }
+
+         // If this is a regular update, update the cell. Eww....
+      if ((nullptr != value.get()) && (false == context.inUserInput))
+       {
+         cell->currentInput = "";
+         cell->value = value;
+       }
+      return value;
+    }
+
+    // Runs work(0) to work(count - 1), with the calling thread as one of the workers.
+    // The first exception thrown by any work stops the rest from being handed out, and is rethrown once every thread is done.
+   template <class Work>
+   static void inParallel(size_t count, size_t threads, const Work& work)
+    {
+      std::atomic<size_t> next (0U);
+      std::mutex lock;
+      std::exception_ptr failure;
+      auto worker = [&next, &lock, &failure, count, &work]()
+       {
+          // Each thread goes to the shared string pool once for each name, and not for every token.
+         Backwards::Input::StringPool::Local interning;
+         try
+          {
+            for (size_t i = next++; i < count; i = next++)
+             {
+               work(i);
+             }
+          }
+         catch (...)
+          {
+            std::lock_guard<std::mutex> guard (lock);
+            if (nullptr == failure)
+             {
+               failure = std::current_exception();
+             }
+            next = count;
+          }
+       };
+
+      std::vector<std::thread> pool;
+      for (size_t i = 1U; i < std::min(threads, count); ++i)
+       {
+         pool.emplace_back(worker);
+       }
+      worker();
+      for (std::thread& thread : pool)
+       {
+         thread.join();
+       }
+      if (nullptr != failure)
+       {
+         std::rethrow_exception(failure);
+       }
+    }
+
+   void SpreadSheet::parseAll(CallingContext& context, size_t threads)
+    {
+      class Pending final
+       {
+      public:
+         Cell* cell;
+         size_t col;
+         size_t row;
+         std::string key;
+         std::shared_ptr<Expression> value;
+       };
+
+      std::vector<Pending> pending;
+      for (size_t col = 0U; col < sheet.size(); ++col)
+       {
+         for (size_t row = 0U; row < sheet[col].size(); ++row)
+          {
+            Cell* cell = sheet[col][row].get();
+            if ((nullptr != cell) && (VALUE == cell->type) && (nullptr == cell->value.get()))
+             {
+               pending.push_back(Pending { cell, col, row, std::string(), std::shared_ptr<Expression>() });
+             }
+          }
+       }
+
+         // Each thread only writes to its own entries. The template table is only used between the parallel steps.
+      inParallel(pending.size(), threads, [&pending](size_t i)
+       {
+         Input::Lexer lexer (pending[i].cell->currentInput);
+         pending[i].key = Parser::Parser::TemplateKey(lexer, pending[i].col, pending[i].row);
+       });
+
+      std::unordered_map<std::string, size_t> first;
+      std::vector<size_t> toParse;
+      for (size_t i = 0U; i < pending.size(); ++i)
+       {
+         std::unordered_map<std::string, std::weak_ptr<Expression> >::iterator found = templates.find(pending[i].key);
+         if (templates.end() != found)
+          {
+            pending[i].value = found->second.lock();
+          }
+         if ((nullptr == pending[i].value.get()) && (false == pending[i].key.empty()) && (true == first.insert(std::make_pair(pending[i].key, i)).second))
+          {
+            toParse.push_back(i);
+          }
+       }
+
+      inParallel(toParse.size(), threads, [&pending, &toParse, &context](size_t j)
+       {
+         Pending& entry = pending[toParse[j]];
+          // A formula that doesn't parse is left as it is, and recalc reports its error as it would have.
+         Input::Lexer lexer (entry.cell->currentInput);
+         Parser::StringLogger logger;
+         entry.value = Parser::Parser::ParseFullExpression(lexer, *context.map, logger, entry.col, entry.row);
+       });
+
+      for (Pending& entry : pending)
+       {
+         if (nullptr == entry.value.get())
+          {
+            std::unordered_map<std::string, size_t>::iterator found = first.find(entry.key);
+            if (first.end() != found)
+             {
+               entry.value = pending[found->second].value;
+             }
+          }
+         if (nullptr != entry.value.get())
           {
-            result = newLogger.logs[0U];
+            templates[entry.key] = entry.value;
+            entry.cell->currentInput = "";
+            entry.cell->value = entry.value;
           }
        }
+    }
+
+   std::string SpreadSheet::computeCell(CallingContext& context, std::shared_ptr<Types::ValueType>& OUT, size_t col, size_t row, bool rethrow)
+    {
+      std::string result;
+      OUT.reset(); // Ensure to clear OUT variable.
+
+      Cell* cell = getCellAt(col, row);
+      if (nullptr == cell)
+       {
+         return result;
+       }
+      CellFrame newFrame (cell, col, row);
+      Backwards::Engine::RoundingMode::Hold rounding (context.roundMode);
+
+         // If we have already evaluated this cell this generation, stop.
+         // Only the cell being previewed from user input is evaluated again: the cells it refers to keep their values.
+      if ((context.generation == cell->previousGeneration) && ((false == context.inUserInput) || (true == rethrow)))
+       {
+         OUT = cell->previousValue;
+         return result;
+       }
+
+      std::shared_ptr<Expression> value = cellExpression(context, cell, col, row, result);
 
          // If the parse failed, leave. Result will have the first parser message.
       if (nullptr == value.get())
@@ -146,11 +398,13 @@ namespace Engine
          return result;
        }
 
-         // If this is a regular update, update the cell. Eww....
-      if (false == context.inUserInput)
+         // A cell evaluated for itself, rather than for another cell, gets its own budget inside the recalc's.
+      Backwards::Engine::Budget* outerBudget = context.budget;
+      const bool ownBudget = (nullptr == context.topCell());
+      if (true == ownBudget)
        {
-         cell->currentInput = "";
-         cell->value = value;
+         context.cellBudget.start(outerBudget);
+         context.budget = &context.cellBudget;
        }
 
       try
@@ -175,6 +429,7 @@ namespace Engine
          context.popCell();
          if (true == rethrow)
           {
+            finishBudget(context, ownBudget, outerBudget);
             throw;
           }
        }
@@ -184,9 +439,11 @@ namespace Engine
          context.popCell();
          if (true == rethrow)
           {
+            finishBudget(context, ownBudget, outerBudget);
             throw;
           }
        }
+      finishBudget(context, ownBudget, outerBudget);
 
       size_t c = result.find('\n');
       if (std::string::npos != c)
@@ -196,8 +453,179 @@ namespace Engine
       return result;
     }
 
+    // Where a reference made from the cell at (col, row) points. Returns false if it is off the sheet.
+   static bool resolve(const Types::CellRefValue& ref, size_t col, size_t row, size_t& refCol, size_t& refRow)
+    {
+      const int64_t c = (true == ref.colAbsolute) ? ref.colRef : static_cast<int64_t>(col) + ref.colRef;
+      const int64_t r = (true == ref.rowAbsolute) ? ref.rowRef : static_cast<int64_t>(row) + ref.rowRef;
+      if ((c < 0) || (r < 0))
+       {
+         return false;
+       }
+      refCol = static_cast<size_t>(c);
+      refRow = static_cast<size_t>(r);
+      return true;
+    }
+
+   static const Types::CellRefValue* cellRef(const std::shared_ptr<Expression>& expr)
+    {
+      if (typeid(Constant) == typeid(*expr))
+       {
+         const std::shared_ptr<Types::ValueType>& value = static_cast<const Constant&>(*expr).value;
+         if (Types::CELL_REF == value->getType())
+          {
+            return static_cast<const Types::CellRefValue*>(value.get());
+          }
+       }
+      return nullptr;
+    }
+
+#define PRECEDENTS_OF_BINARY(x) \
+      else if (typeid(x) == typeid(expr)) \
+       { \
+         precedents(sheet, *static_cast<const x&>(expr).lhs, col, row, out); \
+         precedents(sheet, *static_cast<const x&>(expr).rhs, col, row, out); \
+       }
+
+    // The cells that the formula in (col, row) refers to by name. These are what it will read, unless a function
+    // it calls builds a reference of its own. Cells that don't exist are left out.
+   static void precedents(SpreadSheet& sheet, const Expression& expr, size_t col, size_t row, std::vector<std::pair<size_t, size_t> >& out)
+    {
+      size_t c1, r1, c2, r2;
+      if (typeid(Constant) == typeid(expr))
+       {
+         const std::shared_ptr<Types::ValueType>& value = static_cast<const Constant&>(expr).value;
+         if ((Types::CELL_REF == value->getType()) && (true == resolve(static_cast<const Types::CellRefValue&>(*value), col, row, c1, r1)) &&
+            (nullptr != sheet.getCellAt(c1, r1)))
+          {
+            out.emplace_back(c1, r1);
+          }
+       }
+      else if (typeid(MakeRange) == typeid(expr))
+       {
+         const Types::CellRefValue* lhs = cellRef(static_cast<const MakeRange&>(expr).lhs);
+         const Types::CellRefValue* rhs = cellRef(static_cast<const MakeRange&>(expr).rhs);
+         if ((nullptr != lhs) && (nullptr != rhs) && (true == resolve(*lhs, col, row, c1, r1)) && (true == resolve(*rhs, col, row, c2, r2)))
+          {
+            for (size_t c = std::min(c1, c2); (c <= std::max(c1, c2)) && (c < sheet.sheet.size()); ++c)
+             {
+               for (size_t r = std::min(r1, r2); (r <= std::max(r1, r2)) && (r < sheet.sheet[c].size()); ++r)
+                {
+                  if (nullptr != sheet.sheet[c][r].get())
+                   {
+                     out.emplace_back(c, r);
+                   }
+                }
+             }
+          }
+       }
+      PRECEDENTS_OF_BINARY(Plus)
+      PRECEDENTS_OF_BINARY(Minus)
+      PRECEDENTS_OF_BINARY(Multiply)
+      PRECEDENTS_OF_BINARY(Divide)
+      PRECEDENTS_OF_BINARY(Equals)
+      PRECEDENTS_OF_BINARY(NotEqual)
+      PRECEDENTS_OF_BINARY(Greater)
+      PRECEDENTS_OF_BINARY(Less)
+      PRECEDENTS_OF_BINARY(GEQ)
+      PRECEDENTS_OF_BINARY(LEQ)
+      PRECEDENTS_OF_BINARY(Cat)
+      else if (typeid(Negate) == typeid(expr))
+       {
+         precedents(sheet, *static_cast<const Negate&>(expr).arg, col, row, out);
+       }
+      else if (typeid(FunctionCall) == typeid(expr))
+       {
+         for (const std::shared_ptr<Expression>& arg : static_cast<const FunctionCall&>(expr).args)
+          {
+            precedents(sheet, *arg, col, row, out);
+          }
+       }
+    }
+
+#undef PRECEDENTS_OF_BINARY
+
+    /*
+      Evaluating a cell evaluates the cells it refers to, inside the evaluation of the cell, so a long chain of cells
+      (a running balance down a column) would take the native stack as deep as the chain is long.
+      Instead, walk the chain from here with a stack on the heap, and evaluate each cell only after the cells it names,
+      so that the formula finds all of them already done this generation.
+      The cells waiting on the walk are marked as in evaluation, just as they would be in the recursion,
+      so that a cycle is broken in the same place.
+    */
+   void SpreadSheet::schedule(CallingContext& context, size_t col, size_t row)
+    {
+      class Pending final
+       {
+      public:
+         Cell* cell;
+         size_t col;
+         size_t row;
+         std::vector<std::pair<size_t, size_t> > precedents;
+         size_t next;
+       };
+      std::vector<Pending> pending;
+
+      Cell* cell = getCellAt(col, row);
+      while (true)
+       {
+         if ((nullptr != cell) && (context.generation != cell->previousGeneration) && (false == cell->inEvaluation))
+          {
+            pending.emplace_back();
+            pending.back().cell = cell;
+            pending.back().col = col;
+            pending.back().row = row;
+            pending.back().next = 0U;
+
+            std::string ignored;
+            std::shared_ptr<Expression> value = cellExpression(context, cell, col, row, ignored);
+            if (nullptr != value.get())
+             {
+               precedents(*this, *value, col, row, pending.back().precedents);
+             }
+            cell->inEvaluation = true;
+          }
+
+         cell = nullptr;
+         while ((nullptr == cell) && (false == pending.empty()))
+          {
+            Pending& top = pending.back();
+            if (top.next < top.precedents.size())
+             {
+               col = top.precedents[top.next].first;
+               row = top.precedents[top.next].second;
+               ++top.next;
+               cell = getCellAt(col, row);
+             }
+            else
+             {
+               std::shared_ptr<Types::ValueType> trash;
+               top.cell->inEvaluation = false;
+               (void) computeCell(context, trash, top.col, top.row, false);
+               pending.pop_back();
+             }
+          }
+         if (nullptr == cell)
+          {
+            break;
+          }
+       }
+    }
+
    void SpreadSheet::recalc(CallingContext& context)
     {
+      Backwards::Engine::Budget* outerBudget = context.budget;
+      context.recalcBudget.start(outerBudget);
+      context.budget = &context.recalcBudget;
+
+       // No cell changes during a recalc, so neither does what a pure function makes of a cell.
+       // The cell previewed from user input gets no memo: the recalc after it has been entered will do.
+      context.memoCache.clear();
+      context.memo = &context.memoCache;
+
+       // The library keeps one rounding mode, so wait for this context's turn with it.
+      Backwards::Engine::RoundingMode::Hold rounding (context.roundMode);
+
       context.inUserInput = false;
       ++context.generation;
       if (c_major) // Going in column-major order
@@ -210,8 +638,7 @@ namespace Engine
                 {
                   for (size_t row = 0U; row < sheet[col].size(); ++row)
                    {
-                     std::shared_ptr<Types::ValueType> trash;
-                     (void) computeCell(context, trash, col, row, false);
+                     schedule(context, col, row);
                    }
                 }
              }
@@ -221,8 +648,7 @@ namespace Engine
                 {
                   for (size_t row = sheet[col].size() - 1U; row != (static_cast<size_t>(0U) - 1U); --row)
                    {
-                     std::shared_ptr<Types::ValueType> trash;
-                     (void) computeCell(context, trash, col, row, false);
+                     schedule(context, col, row);
                    }
                 }
              }
@@ -235,8 +661,7 @@ namespace Engine
                 {
                   for (size_t row = 0U; row < sheet[col].size(); ++row)
                    {
-                     std::shared_ptr<Types::ValueType> trash;
-                     (void) computeCell(context, trash, col, row, false);
+                     schedule(context, col, row);
                    }
                 }
              }
@@ -246,8 +671,7 @@ namespace Engine
                 {
                   for (size_t row = sheet[col].size() - 1U; row != (static_cast<size_t>(0U) - 1U); --row)
                    {
-                     std::shared_ptr<Types::ValueType> trash;
-                     (void) computeCell(context, trash, col, row, false);
+                     schedule(context, col, row);
                    }
                 }
              }
@@ -263,8 +687,7 @@ namespace Engine
                 {
                   for (size_t col = 0U; col < sheet.size(); ++col)
                    {
-                     std::shared_ptr<Types::ValueType> trash;
-                     (void) computeCell(context, trash, col, row, false);
+                     schedule(context, col, row);
                    }
                 }
              }
@@ -274,8 +697,7 @@ namespace Engine
                 {
                   for (size_t col = 0U; col < sheet.size(); ++col)
                    {
-                     std::shared_ptr<Types::ValueType> trash;
-                     (void) computeCell(context, trash, col, row, false);
+                     schedule(context, col, row);
                    }
                 }
              }
@@ -288,8 +710,7 @@ namespace Engine
                 {
                   for (size_t col = sheet.size() - 1U; col != (static_cast<size_t>(0U) - 1U); --col)
                    {
-                     std::shared_ptr<Types::ValueType> trash;
-                     (void) computeCell(context, trash, col, row, false);
+                     schedule(context, col, row);
                    }
                 }
              }
@@ -299,14 +720,31 @@ namespace Engine
                 {
                   for (size_t col = sheet.size() - 1U; col != (static_cast<size_t>(0U) - 1U); --col)
                    {
-                     std::shared_ptr<Types::ValueType> trash;
-                     (void) computeCell(context, trash, col, row, false);
+                     schedule(context, col, row);
                    }
                 }
              }
           }
        }
       ++context.generation;
+
+      context.recalcBudget.finish();
+      context.budget = outerBudget;
+      context.memo = nullptr;
+      context.memoCache.clear();
+
+       // Forget formulas that no cell uses any more.
+      for (std::unordered_map<std::string, std::weak_ptr<Expression> >::iterator iter = templates.begin(); templates.end() != iter; )
+       {
+         if (true == iter->second.expired())
+          {
+            iter = templates.erase(iter);
+          }
+         else
+          {
+            ++iter;
+          }
+       }
     }
 
  } // namespace Engine
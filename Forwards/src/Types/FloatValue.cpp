@@ -48,6 +48,10 @@ namespace Types
     {
     }
 
+   FloatValue::FloatValue(const std::shared_ptr<Backwards::Types::FloatValue>& shared) : value(shared->value), twin(shared)
+    {
+    }
+
    const std::string& FloatValue::getTypeName() const
     {
       static const std::string name ("Float");
@@ -66,6 +70,17 @@ namespace Types
       return FLOAT;
     }
 
+   std::shared_ptr<Backwards::Types::FloatValue> FloatValue::shared() const
+    {
+      std::shared_ptr<Backwards::Types::FloatValue> result = std::atomic_load(&twin);
+      if (nullptr == result.get())
+       {
+         result = Backwards::Types::FloatValue::make(value);
+         std::atomic_store(&twin, result);
+       }
+      return result;
+    }
+
  } // namespace Types
 
  } // namespace Forwards
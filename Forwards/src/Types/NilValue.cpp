@@ -58,6 +58,17 @@ namespace Types
       return NIL;
     }
 
+   std::shared_ptr<NilValue> NilValue::make()
+    {
+      static const std::shared_ptr<NilValue> instance = std::make_shared<NilValue>();
+      return instance;
+    }
+
+   std::shared_ptr<Backwards::Types::NilValue> NilValue::shared() const
+    {
+      return Backwards::Types::NilValue::make();
+    }
+
  } // namespace Types
 
  } // namespace Forwards
@@ -38,11 +38,27 @@ namespace Forwards
 namespace Types
  {
 
-   StringValue::StringValue() : value()
+   StringValue::StringValue() : holder(Backwards::Types::StringValue::intern("")->holder), value(holder->text)
     {
     }
 
-   StringValue::StringValue(const std::string& value) : value(value)
+   StringValue::StringValue(const std::string& value) : holder(std::make_shared<Backwards::Types::StringHolder>(value)), value(holder->text)
+    {
+    }
+
+   StringValue::StringValue(const char* value) : holder(std::make_shared<Backwards::Types::StringHolder>(std::string(value))), value(holder->text)
+    {
+    }
+
+   StringValue::StringValue(const std::shared_ptr<const Backwards::Types::StringHolder>& holder) : holder(holder), value(this->holder->text)
+    {
+    }
+
+   StringValue::StringValue(const std::shared_ptr<Backwards::Types::StringValue>& shared) : holder(shared->holder), value(holder->text), twin(shared)
+    {
+    }
+
+   StringValue::StringValue(const StringValue& src) : ValueType(), holder(src.holder), value(holder->text), twin(std::atomic_load(&src.twin))
     {
     }
 
@@ -62,6 +78,17 @@ namespace Types
       return STRING;
     }
 
+   std::shared_ptr<Backwards::Types::StringValue> StringValue::shared() const
+    {
+      std::shared_ptr<Backwards::Types::StringValue> result = std::atomic_load(&twin);
+      if (nullptr == result.get())
+       {
+         result = std::make_shared<Backwards::Types::StringValue>(holder);
+         std::atomic_store(&twin, result);
+       }
+      return result;
+    }
+
  } // namespace Types
 
  } // namespace Forwards
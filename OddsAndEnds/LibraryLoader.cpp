@@ -30,9 +30,15 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <functional>
 #include <algorithm>
 
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
 #include "Backwards/Input/Lexer.h"
 #include "Backwards/Input/LineBufferedStreamInput.h"
 #include "Backwards/Input/StringInput.h"
@@ -40,12 +46,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Backwards/Parser/SymbolTable.h"
 #include "Backwards/Parser/Parser.h"
 #include "Backwards/Parser/ContextBuilder.h"
+#include "Backwards/Parser/LibraryCache.h"
 
 #include "Backwards/Engine/FatalException.h"
 #include "Backwards/Engine/Logger.h"
 #include "Backwards/Engine/Statement.h"
 
 #include "Forwards/Engine/CallingContext.h"
+#include "Forwards/Engine/Plugin.h"
 #include "Forwards/Parser/Parser.h"
 #include "Forwards/Parser/StringLogger.h"
 
@@ -72,13 +80,110 @@ static void dumpLog(Backwards::Engine::Logger& logger)
     }
  }
 
+static void loadPlugin(const char* fileName, Backwards::Parser::SymbolTable& table, Backwards::Engine::Scope& global)
+ {
+#ifndef _WIN32
+      // The plugin is never unloaded: the functions it added live as long as the global scope.
+   void* handle = dlopen(fileName, RTLD_NOW | RTLD_LOCAL);
+   if (nullptr == handle)
+    {
+      std::cerr << "Error loading plugin: " << dlerror() << std::endl;
+      return;
+    }
+   ForwardsPluginInitFunction init = reinterpret_cast<ForwardsPluginInitFunction>(dlsym(handle, FORWARDS_PLUGIN_INIT));
+   if (nullptr == init)
+    {
+      std::cerr << "Error processing plugin: " << fileName << " has no " << FORWARDS_PLUGIN_INIT << std::endl;
+      return;
+    }
+   Forwards::Engine::ScopeRegistry registry (table, global);
+   try
+    {
+      if (0 == init(FORWARDS_PLUGIN_VERSION, &registry))
+       {
+         std::cerr << "Error processing plugin: " << fileName << " does not support version " << FORWARDS_PLUGIN_VERSION << std::endl;
+       }
+      else
+       {
+         registry.commit(); // Only a plugin that loaded cleanly adds its functions.
+       }
+    }
+   catch (const std::exception& e)
+    {
+      std::cerr << "Caught exception: " << e.what() << std::endl;
+      std::cerr << "Error processing plugin: " << fileName << std::endl;
+    }
+#else
+   (void) table;
+   (void) global;
+   std::cerr << "Plugins are not supported on this platform: " << fileName << std::endl;
+#endif
+ }
+
+int FindSheetArgument (int argc, char ** argv)
+ {
+   int i = 1;
+   while (i < argc)
+    {
+      if ((std::string("-l") == argv[i]) || (std::string("-c") == argv[i]) || (std::string("-p") == argv[i]))
+       {
+         i += 2;
+       }
+      else if (std::string("-d") == argv[i])
+       {
+         ++i;
+       }
+      else
+       {
+         break;
+       }
+    }
+   return i;
+ }
+
 int LoadLibraries (int argc, char ** argv, Forwards::Engine::CallingContext& context)
  {
    Backwards::Parser::ContextBuilder::createGlobalScope(*context.globalScope); // Create the global scope before the table.
    Backwards::Parser::GetterSetter gs;
    Backwards::Parser::SymbolTable table (gs, *context.globalScope);
 
+      // How to parse libraries has to be known before the standard library is parsed.
+   std::string cacheDirectory;
+   bool lazy = false;
+   for (int j = 1; j < argc; ++j)
+    {
+      if (std::string("-d") == argv[j])
+       {
+         lazy = true;
+       }
+      else if ((std::string("-c") == argv[j]) || (std::string("-l") == argv[j]) || (std::string("-p") == argv[j]))
+       {
+         if ((std::string("-c") == argv[j]) && ((j + 1) < argc))
+          {
+            cacheDirectory = argv[j + 1];
+          }
+         ++j;
+       }
+      else
+       {
+         break;
+       }
+    }
+
          // We assume that this cannot fail.
+   if (false == cacheDirectory.empty())
+    {
+      std::shared_ptr<Backwards::Engine::Statement> res = Backwards::Parser::LibraryCache::ParseFunctions(cacheDirectory, STDLIB, "Standard Library",
+         table, *context.globalScope, *context.logger);
+      res->execute(context);
+    }
+   else if (true == lazy)
+    {
+      std::shared_ptr<Backwards::Engine::Statement> res = Backwards::Parser::Parser::ParseFunctionsLazily(STDLIB, "Standard Library",
+         table, *context.globalScope, *context.logger);
+      res->execute(context);
+    }
+   else
     {
       Backwards::Input::StringInput stdlib (STDLIB);
       Backwards::Input::Lexer lexer (stdlib, "Standard Library");
@@ -96,10 +201,28 @@ int LoadLibraries (int argc, char ** argv, Forwards::Engine::CallingContext& con
             ++i;
             if (i < argc)
              {
-               Backwards::Input::FileInput console (argv[i]);
-               Backwards::Input::Lexer lexer (console, argv[i]);
+               std::shared_ptr<Backwards::Engine::Statement> res;
+               if ((true == cacheDirectory.empty()) && (false == lazy))
+                {
+                  Backwards::Input::FileInput console (argv[i]);
+                  Backwards::Input::Lexer lexer (console, argv[i]);
 
-               std::shared_ptr<Backwards::Engine::Statement> res = Backwards::Parser::Parser::ParseFunctions(lexer, table, *context.logger);
+                  res = Backwards::Parser::Parser::ParseFunctions(lexer, table, *context.logger);
+                }
+               else
+                {
+                  std::ifstream file (argv[i], std::ios::binary);
+                  std::stringstream text;
+                  text << file.rdbuf();
+                  if (false == cacheDirectory.empty())
+                   {
+                     res = Backwards::Parser::LibraryCache::ParseFunctions(cacheDirectory, text.str(), argv[i], table, *context.globalScope, *context.logger);
+                   }
+                  else
+                   {
+                     res = Backwards::Parser::Parser::ParseFunctionsLazily(text.str(), argv[i], table, *context.globalScope, *context.logger);
+                   }
+                }
                if (nullptr == res.get())
                 {
                   std::cerr << "Error processing file: " << argv[i] << std::endl;
@@ -127,6 +250,23 @@ int LoadLibraries (int argc, char ** argv, Forwards::Engine::CallingContext& con
              }
             ++i;
           }
+         else if (std::string("-c") == argv[i])
+          {
+            i += 2; // Already handled.
+          }
+         else if (std::string("-d") == argv[i])
+          {
+            ++i; // Already handled.
+          }
+         else if (std::string("-p") == argv[i])
+          {
+            ++i;
+            if (i < argc)
+             {
+               loadPlugin(argv[i], table, *context.globalScope);
+             }
+            ++i;
+          }
          else
           {
             break;
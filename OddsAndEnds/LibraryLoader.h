@@ -40,7 +40,10 @@ namespace Engine
  }
  }
 
-   // Returns the argument that is at the end of the "-l" chain.
+   // Returns the argument that is at the end of the chain of "-l", "-p", "-c", and "-d" options.
 int LoadLibraries (int argc, char ** argv, Forwards::Engine::CallingContext& context);
 
+   // The same argument, without loading anything, so that the sheet can be read while the libraries load.
+int FindSheetArgument (int argc, char ** argv);
+
 #endif /* LIBRARYLOADER_H */